@@ -38,6 +38,8 @@
  *   - GE_TICK: Is sent from the GLOW idle callback, i.e. when the window
  *     refresh cycle is about to start again. GLOW will block until all
  *     listeners have processed the event.
+ *
+ * @sa SimulationDriver, which sends the same events without a display.
  */
 #ifndef LS_P_GLOW_GLOWDEVICE_HPP
 #define LS_P_GLOW_GLOWDEVICE_HPP
@@ -27,7 +27,9 @@
  */
 #include "../types.hpp"
 #include "Actor.hpp"
+#include "../Structures/Object.hpp"
 #include <map>
+#include <vector>
 #include <algorithm>
 #include <functional>
 #include <cassert>
@@ -147,7 +149,17 @@ unsigned int Actor::getSensorCount() const
 
 
 void Actor::useControl( unsigned int id, real force )
-{ controls.at(id).use( force ); }
+{
+  controls.at(id).use( force );
+  wakeActor();
+}
+
+
+void Actor::wakeActor()
+{
+  Object * object = dynamic_cast<Object *>( this );
+  if( object ) object->wake();
+}
 
 
 real Actor::readControl( unsigned int id ) const
@@ -173,6 +185,30 @@ real Actor::readSensor( unsigned int id ) const
 
 
 
+void Actor::saveControls( std::vector<real> & buffer ) const
+{
+  for( controls_t::const_iterator i = controls.begin() ;
+       i != controls.end() ; i++ ) {
+    buffer.push_back( i->value );
+  }
+}
+
+
+unsigned int Actor::restoreControls( const std::vector<real> & buffer,
+                                     unsigned int position )
+{
+  assert_user( position + controls.size() <= buffer.size(),
+               "The controls have changed since the checkpoint!" );
+  for( controls_t::iterator i = controls.begin() ;
+       i != controls.end() ; i++ ) {
+    i->value = buffer[position++];
+  }
+  return position;
+}
+
+
+
+
 void Actor::prepare( real dt_ )
 { dt = dt_; }
 
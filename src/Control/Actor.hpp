@@ -138,6 +138,10 @@ namespace lifespace {
       Control * proxyTarget;
       int activeProxiesFromThis;
       
+      /** Actor::saveControls() and Actor::restoreControls() access the
+          values directly. */
+      friend class Actor;
+      
       /** Creates a proxy control for the given target control. */
       Control( Control * proxyTarget );
       
@@ -213,6 +217,12 @@ namespace lifespace {
      */
     sensors_t sensors;
     
+    /**
+     * Called by useControl(). By default wakes the Object that this Actor is
+     * a part of, if any (see Object::wake()).
+     */
+    virtual void wakeActor();
+    
     
   public:
     
@@ -291,6 +301,21 @@ namespace lifespace {
     real readSensor( unsigned int id ) const;
     
     
+    /**
+     * Appends the values of all controls to the buffer (for checkpointing,
+     * see ODEWorld::checkpoint()). Proxy controls have no value of their
+     * own, but are included to keep the layout fixed.
+     */
+    void saveControls( std::vector<real> & buffer ) const;
+    
+    /**
+     * Restores the control values saved with saveControls(), starting at the
+     * given position of the buffer. Returns the position after the values.
+     */
+    unsigned int restoreControls( const std::vector<real> & buffer,
+                                  unsigned int position );
+    
+    
     /** */
     virtual void prepare( real dt );
     
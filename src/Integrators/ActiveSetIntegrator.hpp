@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file ActiveSetIntegrator.hpp
+ *
+ * An integrator that processes only the awake objects of the Subspace.
+ */
+
+/**
+ * @class lifespace::ActiveSetIntegrator
+ * @ingroup Integrators
+ *
+ * @brief
+ * An integrator that processes only the awake objects of the Subspace.
+ *
+ * The integrator keeps a list of awake objects, which is updated only when
+ * objects wake up or fall asleep, so the cost of a timestep depends on the
+ * number of awake objects instead of the total number of objects. An object
+ * with auto-sleep enabled (see Object::setAutoSleep()) is put to sleep after
+ * a step in which it has come to rest (see Object::isResting()). Objects
+ * wake up when they are added to the Subspace, and on the triggers listed
+ * in Object::wake().
+ *
+ * Awake objects are processed in the order in which they were woken up,
+ * which is the insertion order for objects that never sleep. Objects woken
+ * up during a prepare pass are prepared within the same pass.
+ *
+ * @note
+ * An integrator instance keeps per-Subspace state, so it must not be shared
+ * by several Subspaces.
+ *
+ * @sa Integrator, BasicIntegrator
+ */
+#ifndef LS_T_ACTIVESETINTEGRATOR_HPP
+#define LS_T_ACTIVESETINTEGRATOR_HPP
+
+
+#include "../types.hpp"
+#include "../Structures/Object.hpp"
+#include "../Structures/Subspace.hpp"
+#include "Integrator.hpp"
+#include <vector>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class ActiveSetIntegrator :
+    public Integrator
+  {
+    typedef Subspace::objects_t::Handle Handle;
+    
+    /** Handles of the awake objects. Handles of removed objects and objects
+        put to sleep with Object::sleep() are dropped lazily. */
+    std::vector<Handle> active;
+    
+    /** Handles of the objects woken since the last merge to active. */
+    std::vector<Handle> woken;
+    
+    /** The generation (plus one) of the handle listed in active or woken for
+        each slot, or zero if none. Prevents listing an object twice. */
+    std::vector<unsigned int> listed;
+    
+    
+    void unlist( const Handle & handle )
+    {
+      if( listed[handle.slot] == handle.generation + 1 ) {
+        listed[handle.slot] = 0;
+      }
+    }
+    
+    /** Appends the woken objects to the active list. */
+    void mergeWoken()
+    {
+      active.insert( active.end(), woken.begin(), woken.end() );
+      woken.clear();
+    }
+    
+    
+  public:
+    
+    virtual ~ActiveSetIntegrator() {}
+    
+    /** Returns the number of objects that are currently processed. */
+    unsigned int getActiveCount() const
+    { return active.size() + woken.size(); }
+    
+    virtual void wakeObject( Handle handle )
+    {
+      if( handle.slot >= listed.size() ) listed.resize( handle.slot + 1, 0 );
+      if( listed[handle.slot] == handle.generation + 1 ) return;
+      
+      listed[handle.slot] = handle.generation + 1;
+      woken.push_back( handle );
+    }
+    
+    virtual bool hasAwakeObjects( const Subspace::objects_t & objects ) const
+    { return !active.empty() || !woken.empty(); }
+    
+    /* Indices are used instead of iterators, so that objects may be woken
+       up and added to the subspace from within prepare() and step(). */
+    
+    virtual void prepare( Subspace::objects_t & objects, real dt )
+    {
+      mergeWoken();
+      
+      for( std::vector<Handle>::size_type i = 0 ; i < active.size() ; i++ ) {
+        Handle handle = active[i];
+        if( !objects.contains( handle ) ) continue;
+        
+        Object * object = objects.get( handle ).get();
+        if( !object->isAwake() ) continue;
+        
+        object->prepare( dt );
+        
+        // objects woken by the prepare are prepared within this pass
+        if( !woken.empty() ) mergeWoken();
+      }
+    }
+    
+    /**
+     * Steps the awake objects, puts the ones that have come to rest to sleep
+     * and drops the sleeping and removed objects from the active list.
+     */
+    virtual void step( Subspace::objects_t & objects )
+    {
+      std::vector<Handle>::size_type kept = 0;
+      
+      for( std::vector<Handle>::size_type i = 0 ; i < active.size() ; i++ ) {
+        Handle handle = active[i];
+        
+        if( !objects.contains( handle ) ) {
+          unlist( handle );
+          continue;
+        }
+        
+        Object * object = objects.get( handle ).get();
+        if( !object->isAwake() ) {
+          unlist( handle );
+          continue;
+        }
+        
+        object->step();
+        
+        if( object->hasAutoSleep() && object->isResting() ) {
+          object->sleep();
+          unlist( handle );
+          continue;
+        }
+        
+        active[kept++] = handle;
+      }
+      
+      active.resize( kept );
+    }
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_T_ACTIVESETINTEGRATOR_HPP */
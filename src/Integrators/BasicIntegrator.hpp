@@ -60,19 +60,27 @@ namespace lifespace {
   public:
     virtual ~BasicIntegrator() {}
     
+    /* Indices are used instead of iterators, so that objects may be added
+       to and removed from the subspace from within prepare() and step() (see
+       NextIndex()). */
+    
     virtual void prepare( Subspace::objects_t & objects, real dt )
     {
-      for( Subspace::objects_t::iterator i = objects.begin() ;
-           i != objects.end(); i++ ) {
-        (*i)->prepare( dt );
+      Subspace::objects_t::size_type i = 0;
+      while( i < objects.size() ) {
+        Subspace::objects_t::Handle handle = objects.handleAt( i );
+        objects[i]->prepare( dt );
+        i = NextIndex( objects, handle, i );
       }
     }
     
     virtual void step( Subspace::objects_t & objects )
     {
-      for( Subspace::objects_t::iterator i = objects.begin() ;
-           i != objects.end(); i++ ) {
-        (*i)->step();
+      Subspace::objects_t::size_type i = 0;
+      while( i < objects.size() ) {
+        Subspace::objects_t::Handle handle = objects.handleAt( i );
+        objects[i]->step();
+        i = NextIndex( objects, handle, i );
       }
     }
   };
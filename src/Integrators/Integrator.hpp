@@ -59,6 +59,33 @@ namespace lifespace {
     virtual ~Integrator() {}
     virtual void prepare( Subspace::objects_t & objects, real dt ) = 0;
     virtual void step( Subspace::objects_t & objects ) = 0;
+    
+    /** Called when the Object with the given handle is added to the
+        Subspace or woken up (see Object::wake()). */
+    virtual void wakeObject( Subspace::objects_t::Handle handle ) {}
+    
+    /** Returns true if any of the objects are still processed by the
+        integrator. */
+    virtual bool hasAwakeObjects( const Subspace::objects_t & objects ) const
+    { return !objects.empty(); }
+    
+    
+  protected:
+    
+    /**
+     * Returns the index of the object following the one with the given
+     * handle, which was at the given index before it was processed. Lets an
+     * index loop over the objects continue correctly even if the processed
+     * object has removed itself (or other objects) from the Subspace: the
+     * object that took its place is not skipped.
+     */
+    static Subspace::objects_t::size_type
+    NextIndex( const Subspace::objects_t & objects,
+               const Subspace::objects_t::Handle & handle,
+               Subspace::objects_t::size_type index )
+    {
+      return objects.contains( handle ) ? objects.indexOf( handle ) + 1 : index;
+    }
   };
   
   
@@ -43,6 +43,8 @@
 
 #include "Integrator.hpp"
 #include "BasicIntegrator.hpp"
+#include "ParallelIntegrator.hpp"
+#include "ActiveSetIntegrator.hpp"
 
 
 
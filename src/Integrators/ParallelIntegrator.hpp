@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file ParallelIntegrator.hpp
+ *
+ * An integrator that runs the prepare pass of the target objects in parallel
+ * on a ThreadPool.
+ */
+
+/**
+ * @class lifespace::ParallelIntegrator
+ * @ingroup Integrators
+ *
+ * @brief
+ * An integrator that runs the prepare pass of the target objects in parallel
+ * on a ThreadPool.
+ *
+ * Only objects that have declared their prepare() thread-safe (see
+ * Object::setThreadSafePrepare()) are prepared in parallel. The others are
+ * prepared first, serially and in order, on the calling thread. The step pass
+ * is always serial and in order, as with BasicIntegrator, so the results do
+ * not depend on the thread count.
+ *
+ * A nested Subspace with a thread-safe prepare is prepared as a task of its
+ * own. If the nested Subspace also has a ParallelIntegrator sharing the same
+ * ThreadPool, then its contents are split into tasks on the same pool too.
+ *
+ * @note
+ * An integrator instance keeps per-call state, so it must not be shared by
+ * Subspaces that may be prepared concurrently. Share the ThreadPool instead.
+ *
+ * @sa Integrator, BasicIntegrator, ThreadPool
+ */
+#ifndef LS_T_PARALLELINTEGRATOR_HPP
+#define LS_T_PARALLELINTEGRATOR_HPP
+
+
+#include "../types.hpp"
+#include "../Structures/Object.hpp"
+#include "../Structures/Subspace.hpp"
+#include "../Utility/ThreadPool.hpp"
+#include "Integrator.hpp"
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class ParallelIntegrator :
+    public Integrator
+  {
+    boost::shared_ptr<ThreadPool> pool;
+    unsigned int grain;
+    
+    /** Per-call state for the range function. */
+    struct PrepareContext {
+      Subspace::objects_t * objects;
+      const std::vector<Subspace::objects_t::Handle> * handles;
+      real dt;
+    };
+    
+    /** Handles of the thread-safe objects, rebuilt on each prepare(). */
+    std::vector<Subspace::objects_t::Handle> parallelObjects;
+    
+    static void PrepareRange( void * context,
+                              unsigned int begin, unsigned int end )
+    {
+      PrepareContext & c = *static_cast<PrepareContext *>( context );
+      for( unsigned int i = begin ; i < end ; i++ ) {
+        const Subspace::objects_t::Handle & handle = (*c.handles)[i];
+        if( c.objects->contains( handle ) ) {
+          c.objects->get( handle )->prepare( c.dt );
+        }
+      }
+    }
+    
+    
+  public:
+    
+    /**
+     * Creates an integrator that uses the given pool. The pool can be shared
+     * with other integrators.
+     *
+     * @param grain   The number of objects prepared per task.
+     */
+    ParallelIntegrator( boost::shared_ptr<ThreadPool> pool_,
+                        unsigned int grain_ = 64 ) :
+      pool( pool_ ),
+      grain( grain_ )
+    {
+      assert( pool && grain > 0 );
+    }
+    
+    /**
+     * Creates an integrator with a pool of its own.
+     *
+     * @param threadCount   The total number of threads, see ThreadPool.
+     * @param grain         The number of objects prepared per task.
+     */
+    explicit ParallelIntegrator( unsigned int threadCount = 0,
+                                 unsigned int grain_ = 64 ) :
+      pool( new ThreadPool( threadCount ) ),
+      grain( grain_ )
+    {
+      assert( grain > 0 );
+    }
+    
+    virtual ~ParallelIntegrator() {}
+    
+    
+    boost::shared_ptr<ThreadPool> getThreadPool() const
+    { return pool; }
+    
+    
+    virtual void prepare( Subspace::objects_t & objects, real dt )
+    {
+      // serial part, in order (indices: objects may be added and removed
+      // meanwhile, see NextIndex())
+      parallelObjects.clear();
+      Subspace::objects_t::size_type i = 0;
+      while( i < objects.size() ) {
+        Subspace::objects_t::Handle handle = objects.handleAt( i );
+        if( objects[i]->hasThreadSafePrepare() ) {
+          parallelObjects.push_back( handle );
+          i++;
+        } else {
+          objects[i]->prepare( dt );
+          i = NextIndex( objects, handle, i );
+        }
+      }
+      if( parallelObjects.empty() || objects.empty() ) return;
+      
+      // update the shared world transform caches of the host subspaces
+      // before they are read concurrently
+      Subspace * hostSpace = objects[0]->getHostSpace();
+      if( hostSpace ) hostSpace->getWorldLocator();
+      
+      PrepareContext context = { &objects, &parallelObjects, dt };
+      pool->parallelFor( PrepareRange, &context,
+                         0, parallelObjects.size(), grain );
+    }
+    
+    virtual void step( Subspace::objects_t & objects )
+    {
+      Subspace::objects_t::size_type i = 0;
+      while( i < objects.size() ) {
+        Subspace::objects_t::Handle handle = objects.handleAt( i );
+        objects[i]->step();
+        i = NextIndex( objects, handle, i );
+      }
+    }
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_T_PARALLELINTEGRATOR_HPP */
@@ -28,22 +28,23 @@
 #include "../../types.hpp"
 #include "Collider.hpp"
 #include "ObjectNode.hpp"
+#include "SubspaceNode.hpp"
 #include "ODECollisionRenderer.hpp"
 #include "../../Structures/ODEWorld.hpp"
 #include "../../Structures/ODELocator.hpp"
+#include "../../Structures/ODEInstance.hpp"
 #include "../../Structures/Connector.hpp"
 #include "../../Utility/Geometry.hpp"
 #include "../../Utility/CollisionMaterial.hpp"
 #include "../../Utility/Contact.hpp"
+#include "../../Utility/ThreadPool.hpp"
 using namespace lifespace;
 
 #include <ode/ode.h>
 #include <ode/odecpp.h>
 #include <ode/odecpp_collision.h>
 
-#include <boost/scoped_array.hpp>
 #include <boost/shared_ptr.hpp>
-using boost::scoped_array;
 using boost::shared_ptr;
 using boost::dynamic_pointer_cast;
 
@@ -53,16 +54,123 @@ using std::endl;
 
 #include <algorithm>
 using std::for_each;
+using std::min;
+using std::max;
+
+#include <utility>
+
+#include <cstring>
+using std::memcpy;
+using std::memset;
+
+
+
+
+Collider::BroadphaseParams::BroadphaseParams() :
+  broadphase( Hash ),
+  staticBroadphase( Quadtree ),
+  hashMinLevel( -3 ),
+  hashMaxLevel( 10 ),
+  sapAxisOrder( dSAP_AXES_XZY ),
+  quadtreeCenter( makeVector3d( 0.0, 0.0, 0.0 ) ),
+  quadtreeExtents( makeVector3d( 1000.0, 1000.0, 1000.0 ) ),
+  quadtreeDepth( 6 )
+{}
+
+
+Collider::BroadphaseSpace::BroadphaseSpace( const BroadphaseParams & params,
+                                            Broadphase broadphase )
+{
+  switch( broadphase ) {
+    
+  case Simple:
+    _id = (dGeomID)dSimpleSpaceCreate( 0 );
+    break;
+    
+  case Hash:
+    _id = (dGeomID)dHashSpaceCreate( 0 );
+    dHashSpaceSetLevels( id(), params.hashMinLevel, params.hashMaxLevel );
+    break;
+    
+  case SweepAndPrune:
+    _id = (dGeomID)dSweepAndPruneSpaceCreate( 0, params.sapAxisOrder );
+    break;
+    
+  case Quadtree: {
+    assert( params.quadtreeCenter.size() == 3 &&
+            params.quadtreeExtents.size() == 3 );
+    dVector3 center, extents;
+    for( int i = 0 ; i < 3 ; i++ ) {
+      center[i] = params.quadtreeCenter(i);
+      extents[i] = params.quadtreeExtents(i);
+    }
+    _id = (dGeomID)dQuadTreeSpaceCreate( 0, center, extents,
+                                         params.quadtreeDepth );
+    break;
+  }
+    
+  default:
+    assert_user( false, "Collider: unknown broadphase " << broadphase );
+    // fall back to the simple space if assertions are disabled
+    _id = (dGeomID)dSimpleSpaceCreate( 0 );
+  }
+}
+
+
+
+
+Collider::Collider( ODEWorld & world_,
+                    const BroadphaseParams & broadphaseParams ) :
+  world( world_ ),
+  collisionSpace( broadphaseParams, broadphaseParams.broadphase ),
+  staticSpace( broadphaseParams, broadphaseParams.staticBroadphase ),
+  jointGroup(),
+  objectNodes(),
+  subspaceNodes(),
+  selfCollidingSpaces(),
+  allContacts(),
+  contactTable(),
+  currentGeneration( 0 ),
+  candidates(),
+  chunks(),
+  pool(),
+  narrowphaseGrain( 64 ),
+  materials(),
+  materialIds(),
+  materialKeys(),
+  surfaces(),
+  surfaceStride( 0 )
+{
+  collisionSpace.setCleanup( 0 );   // objects have their own collision spaces
+                                    // managed through the ODE C++ wrapper
+                                    // interface!
+  staticSpace.setCleanup( 0 );
+  
+  // the world itself uses the top-level space
+  initSubspaceGeoms( collisionSpace, world );
+}
+
+
+Collider::~Collider()
+{
+  // wipe all Contact objects
+  while( !allContacts.empty() ) deleteContact( allContacts.back() );
+  
+  // wipe all ObjectNode and SubspaceNode objects (they remove themselves)
+  while( !objectNodes.empty() ) delete objectNodes.begin()->second;
+  while( !subspaceNodes.empty() ) delete subspaceNodes.begin()->second;
+  selfCollidingSpaces.clear();
+  inhibitedPairs.clear();
+}
 
 
 
 
 /**
- * Checks if collisions between these Objects are inhibited. Currently the only
- * thing that inhibits collisions is a connected connector with the
- * inhibitCollisions flag set.
+ * Currently the only thing that inhibits collisions is a connected connector
+ * with the inhibitCollisions flag set.
  */
-static bool AreCollisionsInhibited( const Object & lhs, const Object & rhs )
+bool Collider::ScanCollisionsInhibited( const Object & lhs, const Object & rhs )
 {
   const Object::connectors_t & lhsConnectors = lhs.getConnectors();
   
@@ -84,32 +192,30 @@ static bool AreCollisionsInhibited( const Object & lhs, const Object & rhs )
 }
 
 
-
-
-Collider::Collider( ODEWorld & world_ ) :
-  world( world_ ),
-  collisionSpace( 0 ),
-  jointGroup(),
-  contactBuf( new dContact[CONTACTBUF_SIZE] ),
-  objectNodes(),
-  allContacts()
+void Collider::updateInhibitedPair( const Object & lhs, const Object & rhs )
 {
-  collisionSpace.setCleanup( 0 );   // objects have their own collision spaces
-                                    // managed through the ODE C++ wrapper
-                                    // interface!
-  initGeoms( collisionSpace, world );
+  if( ScanCollisionsInhibited( lhs, rhs ) ) {
+    inhibitedPairs.insert( MakePair( lhs, rhs ) );
+  } else {
+    inhibitedPairs.erase( MakePair( lhs, rhs ) );
+  }
 }
 
 
-Collider::~Collider()
+void Collider::updateInhibitedPairs( const Object & object, bool forget )
 {
-  // wipe all Contact objects
-  for_each( allContacts.begin(), allContacts.end(), deleter<Contact>() );
-  allContacts.clear();
-  
-  // wipe all ObjectNode objects
-  for_each( objectNodes.begin(), objectNodes.end(), deleter<ObjectNode>() );
-  objectNodes.clear();
+  const Object::connectors_t & connectors = object.getConnectors();
+  for( Object::connectors_t::const_iterator i = connectors.begin() ;
+       i != connectors.end() ; ++i ) {
+    if( !i->second->isConnected() ) continue;
+    
+    const Object & target = i->second->getTargetConnector()->getHostObject();
+    if( forget ) {
+      inhibitedPairs.erase( MakePair( object, target ) );
+    } else {
+      updateInhibitedPair( object, target );
+    }
+  }
 }
 
 
@@ -120,115 +226,117 @@ Collider::~Collider()
  * Optimize away all Geometry data re-fetching while traversing primitive geoms
  * within the same Geometry objects.
  *
- * @todo
- * Optimize the AreCollisionsInhibited() function (cache the inhibited pairs in
- * Objects).
  */
 void Collider::ODECollisionCallback( void * data, dGeomID lhs, dGeomID rhs )
 {
-  Object & lhsObject = *(Object *)dGeomGetData( lhs );
-  Object & rhsObject = *(Object *)dGeomGetData( rhs );
-  
   if( dGeomIsSpace(lhs) || dGeomIsSpace(rhs) ) {
-    // spaces involved, recurse
+    // spaces involved, recurse into the cross pairs only (the contents of
+    // the subspace spaces are collided with each other in collide(), and the
+    // geoms of a single object never collide with each other)
     dSpaceCollide2( lhs, rhs, data, &ODECollisionCallback );
-    if( dGeomIsSpace(lhs) ) dSpaceCollide( (dSpaceID)lhs, data,
-                                           &ODECollisionCallback );
-    if( dGeomIsSpace(rhs) ) dSpaceCollide( (dSpaceID)rhs, data,
-                                           &ODECollisionCallback );
   } else {
     
     // geom-geom collision, create contacts if not connected
+    const GeomData & lhsData = *(const GeomData *)dGeomGetData( lhs );
+    const GeomData & rhsData = *(const GeomData *)dGeomGetData( rhs );
     
     // do not collide static objects
     if( !dGeomGetBody(lhs) && !dGeomGetBody(rhs) ) return;
     
     // do not collide connected objects
-    if( AreCollisionsInhibited( lhsObject, rhsObject ) ) return;
-    
-    
-    // collide
     Collider & collider = *(Collider *)data;
-    int count = dCollide( lhs, rhs,
-                          CONTACTBUF_SIZE,
-                          &collider.contactBuf[0].geom,
-                          sizeof(dContact) );
-    
-    // check result
-    if( count == 0 ) return;
-    if( count == CONTACTBUF_SIZE ) {
-      cout << "*** WARNING: ODECollisionRenderer: contact buffer overflow!"
-           << endl;
+    if( collider.areCollisionsInhibited( *lhsData.object, *rhsData.object ) ) {
+      return;
     }
     
+    // defer the narrowphase
+    Candidate candidate = { lhs, rhs };
+    collider.candidates.push_back( candidate );
     
-    /* The current geoms are in contact. Create contact joints and update
-       involved Contact objects. */
-    
-    // resolve colliding Geometry and BasicGeometry objects
-    assert_user( lhsObject.getGeometry() && rhsObject.getGeometry(),
-                 "Both colliding Objects must have a Geometry!" );
-    Geometry & lhsGeometry = *lhsObject.getGeometry();
-    Geometry & rhsGeometry = *rhsObject.getGeometry();
-    const BasicGeometry * lhsBasicGeometry =
-      dynamic_cast<const BasicGeometry *>( &lhsGeometry );
-    const BasicGeometry * rhsBasicGeometry =
-      dynamic_cast<const BasicGeometry *>( &rhsGeometry );
-    assert_user( lhsBasicGeometry && rhsBasicGeometry,
-                 "Both colliding Objects must have a Geometry and currently "
-                 "it must be of type BasicGeometry!" );
-    assert_user( lhsBasicGeometry->collisionMaterial &&
-                 rhsBasicGeometry->collisionMaterial,
-                 "CollisionMaterial field of BasicGeometry must be defined "
-                 "for both colliding Objects!" );
-    
-    // resolve contact materials
-    const CollisionMaterial & lhsMat = *lhsBasicGeometry->collisionMaterial;
-    const CollisionMaterial & rhsMat = *rhsBasicGeometry->collisionMaterial;
-    
-    // compute contact params
-    real friction = lhsMat.friction * rhsMat.friction;
-    real bounciness = lhsMat.bounciness * rhsMat.bounciness;
-    real bounceMinVel = lhsMat.bounceMinVel + rhsMat.bounceMinVel;
+  }
+}
+
+
+void Collider::NarrowphaseRange( void * context,
+                                 unsigned int begin, unsigned int end )
+{
+  Collider & collider = *static_cast<Collider *>( context );
+  for( unsigned int i = begin ; i < end ; i++ ) {
+    collider.narrowphase( i );
+  }
+}
+
+
+void Collider::narrowphase( unsigned int chunkIndex )
+{
+  NarrowphaseChunk & chunk = chunks[chunkIndex];
+  chunk.contacts.clear();
+  chunk.counts.clear();
+  
+  std::size_t begin = chunkIndex * narrowphaseGrain;
+  std::size_t end = min( begin + narrowphaseGrain, candidates.size() );
+  if( chunk.scratch.empty() ) chunk.scratch.resize( CONTACTBUF_SIZE );
+  for( std::size_t i = begin ; i < end ; i++ ) {
+    // collide into the scratch buffer and append only the actual contacts
+    int count = dCollide( candidates[i].lhs, candidates[i].rhs,
+                          CONTACTBUF_SIZE, &chunk.scratch[0],
+                          sizeof(dContactGeom) );
+    chunk.contacts.insert( chunk.contacts.end(),
+                           chunk.scratch.begin(),
+                           chunk.scratch.begin() + count );
+    chunk.counts.push_back( count );
+  }
+}
+
+
+void Collider::createContacts( unsigned int chunkCount )
+{
+  dContact contact;
+  memset( &contact, 0, sizeof(contact) );
+  
+  for( unsigned int k = 0 ; k < chunkCount ; k++ ) {
+    const NarrowphaseChunk & chunk = chunks[k];
+    std::size_t offset = 0;
     
-    // insert contacts
-    for( int i = 0 ; i < count ; i++ ) {
+    for( std::size_t j = 0 ; j < chunk.counts.size() ; j++ ) {
       
-      // write contact params
-      collider.contactBuf[i].surface.mode =
-        (bounciness > 0.0 ? dContactBounce : 0 ) |
-        dContactApprox1;
-      collider.contactBuf[i].surface.mu = friction;
-      collider.contactBuf[i].surface.bounce = bounciness;
-      collider.contactBuf[i].surface.bounce_vel = bounceMinVel;
+      // check result
+      int count = chunk.counts[j];
+      if( count == 0 ) continue;
+      if( count == CONTACTBUF_SIZE ) {
+        cout << "*** WARNING: ODECollisionRenderer: contact buffer overflow!"
+             << endl;
+      }
       
-      // attach the joint
-      dJointAttach
-        ( dJointCreateContact( collider.world.id(),
-                               collider.jointGroup.id(),
-                               &collider.contactBuf[i] ),
-          dGeomGetBody(lhs), dGeomGetBody(rhs) );
       
+      /* The current geoms are in contact. Create contact joints and update
+         involved Contact objects. */
+      
+      const Candidate & candidate = candidates[k * narrowphaseGrain + j];
+      const GeomData & lhsData =
+        *(const GeomData *)dGeomGetData( candidate.lhs );
+      const GeomData & rhsData =
+        *(const GeomData *)dGeomGetData( candidate.rhs );
+      
+      // write the precomputed contact params
+      memcpy( &contact.surface,
+              &getSurface( lhsData.material, rhsData.material ),
+              sizeof(contact.surface) );
+      
+      // insert contacts
+      for( int i = 0 ; i < count ; i++ ) {
+        contact.geom = chunk.contacts[offset + i];
+        dJointAttach
+          ( dJointCreateContact( world.id(), jointGroup.id(), &contact ),
+            dGeomGetBody( candidate.lhs ), dGeomGetBody( candidate.rhs ) );
+      }
+      offset += count;
+      
+      /* update involved Contact objects, a touching awake object wakes the
+         other one also through an existing contact */
+      
+      touchContact( lhsData.geometry, rhsData.geometry )->wakeHosts();
     }
-    
-    /* update involved Contact objects */
-    
-    const Geometry::contacts_t & lhsContacts = lhsGeometry.getContacts();
-    Geometry::contacts_t::const_iterator i = lhsContacts.find( &rhsGeometry );
-    
-    Contact * contact;
-    if( i == lhsContacts.end() ) {
-      // create a new contact and insert it into all three containers
-      contact = new Contact( &lhsGeometry, &rhsGeometry );
-      collider.allContacts.push_back( contact );
-    } else {
-      // contact exists already
-      contact = i->second;
-    }
-    
-    // update contact data
-    contact->getFlipflop() = collider.currentFlipflop;
-    
   }
 }
 
@@ -241,7 +349,8 @@ void Collider::initGeom( dSpace & geomSpace, Object & object )
   
   if( !geometry ) return;
   
-  objectNodes.push_back( new ObjectNode( *this, geomSpace, object ) );
+  new ObjectNode( *this, geomSpace, object );
+  updateInhibitedPairs( object );
 }
 
 
@@ -262,18 +371,155 @@ void Collider::initGeoms( dSpace & geomSpace, Object & object )
 
 void Collider::initGeoms( dSpace & geomSpace, Subspace & subspace )
 {
-  // create an own geomspace here
-  //...
+  // create an own geomspace for the subspace
+  SubspaceNode * node = new SubspaceNode( *this, geomSpace, subspace );
+  
+  initSubspaceGeoms( node->getSpace(), subspace );
+}
+
+
+void Collider::initSubspaceGeoms( dSpace & subspaceSpace, Subspace & subspace )
+{
+  // a detached Subspace is listed when it is attached (see attachSpaces())
+  if( subspace.doesSelfCollide() && isAttached( subspaceSpace ) ) {
+    selfCollidingSpaces.push_back( &subspaceSpace );
+  }
   
   // recurse
   Subspace::objects_t & objects = subspace.getObjects();
   for( Subspace::objects_t::iterator i = objects.begin() ;
        i != objects.end() ; i++ ) {
-    initGeoms( geomSpace, **i );
+    initGeoms( subspaceSpace, **i );
   }
   
   // add own geom
-  initGeom( geomSpace, subspace );
+  initGeom( subspaceSpace, subspace );
+}
+
+
+
+
+void Collider::setThreadPool( shared_ptr<ThreadPool> pool_,
+                              unsigned int grain )
+{
+  assert( grain > 0 );
+  
+#ifdef LS_ODE_THREADING
+  // allocate the ODE data of the pool threads once, here
+  if( pool_ && pool_->getThreadCount() > 1 ) {
+    pool_->runOnEachThread( ODEInstance::AttachThread );
+  }
+  pool = pool_;
+#else
+  // dCollide() is not thread-safe without the threading interface of ODE
+  pool.reset();
+#endif
+  narrowphaseGrain = grain;
+}
+
+
+
+
+dSpace * Collider::findSpace( const Subspace * subspace )
+{
+  if( subspace == &world ) return &collisionSpace;
+  
+  subspacenodes_t::iterator i = subspaceNodes.find( subspace );
+  return i != subspaceNodes.end() ? &i->second->getSpace() : 0;
+}
+
+
+bool Collider::isAttached( const dSpace & space ) const
+{
+  dSpaceID id = space.id();
+  while( id != collisionSpace.id() ) {
+    id = dGeomGetSpace( (dGeomID)id );
+    if( !id ) return false;
+  }
+  return true;
+}
+
+
+bool Collider::isFullyCollidable( const Subspace * subspace ) const
+{
+  for( ; subspace ; subspace = subspace->getHostSpace() ) {
+    if( !subspace->doesSelfCollide() ) return false;
+    if( subspace == &world ) return true;
+  }
+  return false;
+}
+
+
+void Collider::replaceStaticObjects( Subspace & subspace,
+                                     bool fullyCollidable )
+{
+  dSpace * space = findSpace( &subspace );
+  
+  Subspace::objects_t & objects = subspace.getObjects();
+  for( Subspace::objects_t::iterator i = objects.begin() ;
+       i != objects.end() ; i++ ) {
+    if( Subspace * nested = dynamic_cast<Subspace *>( i->get() ) ) {
+      // the contents of a non-self-colliding Subspace stay in its space
+      if( nested->doesSelfCollide() ) {
+        replaceStaticObjects( *nested, fullyCollidable );
+      }
+      continue;
+    }
+    
+    objectnodes_t::iterator node = objectNodes.find( i->get() );
+    if( node != objectNodes.end() ) {
+      node->second->place( space, fullyCollidable );
+    }
+  }
+}
+
+
+void Collider::MoveSpace( dSpace & space, dSpace * newHost )
+{
+  dGeomID geom = (dGeomID)space.id();
+  
+  dSpaceID oldHost = dGeomGetSpace( geom );
+  if( oldHost ) dSpaceRemove( oldHost, geom );
+  if( newHost ) newHost->add( geom );
+}
+
+
+void Collider::attachSpaces( Subspace & subspace, bool attached )
+{
+  std::vector<dSpace *> spaces;
+  collectSelfCollidingSpaces( subspace, spaces );
+  
+  if( attached ) {
+    selfCollidingSpaces.insert( selfCollidingSpaces.end(),
+                                spaces.begin(), spaces.end() );
+  } else {
+    std::sort( spaces.begin(), spaces.end() );
+    std::vector<dSpace *>::iterator kept = selfCollidingSpaces.begin();
+    for( std::vector<dSpace *>::iterator i = selfCollidingSpaces.begin() ;
+         i != selfCollidingSpaces.end() ; ++i ) {
+      if( !std::binary_search( spaces.begin(), spaces.end(), *i ) ) {
+        *kept++ = *i;
+      }
+    }
+    selfCollidingSpaces.erase( kept, selfCollidingSpaces.end() );
+  }
+}
+
+
+void Collider::collectSelfCollidingSpaces( Subspace & subspace,
+                                           std::vector<dSpace *> & spaces )
+{
+  if( subspace.doesSelfCollide() ) {
+    if( dSpace * space = findSpace( &subspace ) ) spaces.push_back( space );
+  }
+  
+  Subspace::objects_t & objects = subspace.getObjects();
+  for( Subspace::objects_t::iterator i = objects.begin() ;
+       i != objects.end() ; i++ ) {
+    if( Subspace * nested = dynamic_cast<Subspace *>( i->get() ) ) {
+      collectSelfCollidingSpaces( *nested, spaces );
+    }
+  }
 }
 
 
@@ -281,20 +527,181 @@ void Collider::initGeoms( dSpace & geomSpace, Subspace & subspace )
 
 void Collider::collide()
 {
-  currentFlipflop = !currentFlipflop;
+  currentGeneration++;
   
   jointGroup.empty();
-  collisionSpace.collide( (void *)this, &ODECollisionCallback );
+  candidates.clear();
+  for( std::vector<dSpace *>::iterator i = selfCollidingSpaces.begin() ;
+       i != selfCollidingSpaces.end() ; ++i ) {
+    (*i)->collide( (void *)this, &ODECollisionCallback );
+  }
+  
+  // the static geoms are collided only against the others (ODE iterates the
+  // smaller space and queries the larger one)
+  dSpaceCollide2( (dGeomID)collisionSpace.id(), (dGeomID)staticSpace.id(),
+                  (void *)this, &ODECollisionCallback );
+  
+  // run the narrowphase in fixed chunks of candidates, so that each chunk is
+  // written by a single thread, and then create the joints in order
+  unsigned int chunkCount =
+    ( candidates.size() + narrowphaseGrain - 1 ) / narrowphaseGrain;
+  if( chunks.size() < chunkCount ) chunks.resize( chunkCount );
+  if( pool && chunkCount > 1 ) {
+    pool->parallelFor( NarrowphaseRange, this, 0, chunkCount );
+  } else {
+    NarrowphaseRange( this, 0, chunkCount );
+  }
+  createContacts( chunkCount );
   
-  // wipe old Contact objects
-  for( contacts_t::iterator i = allContacts.begin() ;
-       i != allContacts.end() ; ) {
-    if( (*i)->getFlipflop() != currentFlipflop ) {
-      delete *i;
-      contacts_t::iterator tmp = i++;
-      allContacts.erase( tmp );
+  wipeOldContacts();
+}
+
+
+unsigned int Collider::registerMaterial
+( shared_ptr<const CollisionMaterial> material )
+{
+  assert( material );
+  
+  std::size_t id;
+  materialids_t::iterator found = materialIds.find( material.get() );
+  if( found != materialIds.end() ) {
+    // registered, unless a new material took the address of an expired one
+    id = found->second;
+    if( !materials[id].expired() ) return id;
+  } else {
+    // reuse the id of an expired material before growing the table
+    std::size_t count = materials.size();
+    for( id = 0 ; id < count && !materials[id].expired() ; id++ ) {}
+    
+    if( id < count ) {
+      materialIds.erase( materialKeys[id] );
+    } else {
+      if( count == surfaceStride ) {
+        // double the stride and move the rows
+        std::size_t newStride = max( 2 * surfaceStride, (std::size_t)8 );
+        std::vector<dSurfaceParameters> newSurfaces( newStride * newStride );
+        for( std::size_t i = 0 ; i < count ; i++ ) {
+          std::copy( surfaces.begin() + i * surfaceStride,
+                     surfaces.begin() + i * surfaceStride + count,
+                     newSurfaces.begin() + i * newStride );
+        }
+        surfaces.swap( newSurfaces );
+        surfaceStride = newStride;
+      }
+      materials.push_back( material );
+      materialKeys.push_back( 0 );
+    }
+    materialIds[material.get()] = id;
+  }
+  materials[id] = material;
+  materialKeys[id] = material.get();
+  
+  // the row and column of the id against the live materials
+  for( std::size_t i = 0 ; i < materials.size() ; i++ ) {
+    shared_ptr<const CollisionMaterial> other = materials[i].lock();
+    if( !other ) continue;
+    surfaces[id * surfaceStride + i] = MakeSurface( *material, *other );
+    surfaces[i * surfaceStride + id] = MakeSurface( *other, *material );
+  }
+  
+  return id;
+}
+
+
+dSurfaceParameters Collider::MakeSurface( const CollisionMaterial & lhs,
+                                          const CollisionMaterial & rhs )
+{
+  // compute contact params
+  real friction = lhs.friction * rhs.friction;
+  real bounciness = lhs.bounciness * rhs.bounciness;
+  real bounceMinVel = lhs.bounceMinVel + rhs.bounceMinVel;
+  
+  dSurfaceParameters surface;
+  memset( &surface, 0, sizeof(surface) );
+  surface.mode = (bounciness > 0.0 ? dContactBounce : 0 ) | dContactApprox1;
+  surface.mu = friction;
+  surface.bounce = bounciness;
+  surface.bounce_vel = bounceMinVel;
+  return surface;
+}
+
+
+
+
+Contact * Collider::newContact( Geometry * lhs, Geometry * rhs )
+{
+  Contact * contact = new( contactpool_t::Allocate() ) Contact( lhs, rhs );
+  contact->getIndex() = allContacts.size();
+  allContacts.push_back( contact );
+  contactTable.insert( contact );
+  return contact;
+}
+
+
+void Collider::deleteContact( Contact * contact )
+{
+  contactTable.erase( contact );
+  
+  // move the last contact into the hole
+  std::size_t index = contact->getIndex();
+  assert( allContacts[index] == contact );
+  allContacts[index] = allContacts.back();
+  allContacts[index]->getIndex() = index;
+  allContacts.pop_back();
+  
+  contact->~Contact();
+  contactpool_t::Deallocate( contact );
+}
+
+
+Contact * Collider::touchContact( Geometry * lhs, Geometry * rhs )
+{
+  Contact * contact = contactTable.find( lhs, rhs );
+  if( !contact ) contact = newContact( lhs, rhs );
+  contact->getGeneration() = currentGeneration;
+  return contact;
+}
+
+
+void Collider::wipeOldContacts()
+{
+  for( std::size_t i = 0 ; i < allContacts.size() ; ) {
+    if( allContacts[i]->getGeneration() != currentGeneration ) {
+      // the last contact is moved to i, check it next
+      deleteContact( allContacts[i] );
     } else {
-      ++i;
+      i++;
     }
   }
 }
+
+
+
+
+void Collider::saveContacts( ODEWorld::Checkpoint & target ) const
+{
+  target.contacts.clear();
+  for( contacts_t::const_iterator i = allContacts.begin() ;
+       i != allContacts.end() ; ++i ) {
+    target.contacts.push_back
+      ( std::make_pair( (*i)->getLhs(), (*i)->getRhs() ) );
+  }
+  target.hasContacts = true;
+}
+
+
+void Collider::restoreContacts( const ODEWorld::Checkpoint & source )
+{
+  assert_user( source.hasContacts,
+               "The checkpoint does not contain the contacts!" );
+  
+  currentGeneration++;
+  jointGroup.empty();
+  
+  // touch the stored contacts, creating the missing ones
+  for( unsigned int i = 0 ; i < source.contacts.size() ; i++ ) {
+    touchContact( source.contacts[i].first, source.contacts[i].second );
+  }
+  
+  wipeOldContacts();
+}
@@ -42,14 +42,45 @@
  * done: Rename to just Collider?
  * @endif
  *
- * @todo
- * Create intermediate collision spaces in initGeoms( Subspace & ).
+ * The top-level collision space is selected with BroadphaseParams. The
+ * objects are collided within it through their own simple spaces, which
+ * hold the few geoms of each object. Each nested Subspace gets a simple space
+ * of its own, which contains the spaces of its contents (and the Subspace's
+ * own geom). The contents of a Subspace are collided with each other only if
+ * the Subspace self-collides (see Subspace::Params::selfCollide).
  *
- * @todo
- * Simplify the AreCollisionsInhibited() static function by creating a inhibit
- * targets cache (a set container) to Object and maintain it from
- * Connector::connect() and Connector::disconnect() (remember to update the
- * relevant caches if a connected Connector's inhibit mode is changed).
+ * The static Objects (those without an active ODELocator) are kept in a
+ * separate space, which is collided only against the top-level space with
+ * dSpaceCollide2(). Thus the static geoms are never paired with each other,
+ * and the collision cost depends on the number of dynamic geoms. Static
+ * Objects within a Subspace that does not self-collide (directly or through
+ * its hosts) stay in the space of the Subspace, to keep it from colliding with
+ * its contents.
+ *
+ * The tracked Objects and Subspaces are followed incrementally through their
+ * events: when one is moved to another tracked Subspace, only its own space is
+ * moved, and when its ODELocator is (de)activated or its geometry is replaced
+ * or modified, only its own geoms are rebound or rebuilt. Objects that are
+ * removed from the world stay tracked but out of the collision hierarchy
+ * until they are inserted back or deleted.
+ *
+ * The Object pairs whose collisions are inhibited by a connection are kept in
+ * a hash set, so that the check in the collision callback is a single
+ * probe. The set is built when the Collider is created and updated from the
+ * OE_CONNECTION_MODIFIED events of the tracked Objects.
+ *
+ * A collide() runs in three stages: the broadphase collects the candidate
+ * geom pairs, the narrowphase runs dCollide() for them (in parallel if a
+ * ThreadPool has been set), and finally the contact joints are created and
+ * the Contact objects updated serially, in the order of the candidates.
+ *
+ * The contact surface parameters are precomputed for each pair of the
+ * CollisionMaterials in use, so that the collision callback only copies
+ * them. The materials are registered when the geoms are created.
+ *
+ * The Contact objects are allocated from a pool and kept both in a dense
+ * list, which is swept for the old ones after each collision, and in a
+ * ContactTable, which finds the contact of a touching geometry pair.
  *
  * @bug
  * If a Geometry is deleted while it has active contacts, the Contact objects
@@ -63,14 +94,25 @@
 
 #include "../../types.hpp"
 #include "../../Utility/shapes.hpp"
+#include "../../Structures/Vector.hpp"
+#include "../../Structures/ODEWorld.hpp"
+#include "../../Utility/Contact.hpp"
+#include "../../Utility/Pool.hpp"
+#include "ContactTable.hpp"
 
 #include <ode/ode.h>
 #include <ode/odecpp.h>
 #include <ode/odecpp_collision.h>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
-#include <boost/scoped_array.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <list>
+#include <vector>
+#include <utility>
 
 
 
@@ -80,63 +122,349 @@ namespace lifespace {
   
   /* forwards */
   class ODECollisionRenderer;
-  class ODEWorld;
   class ObjectNode;
+  class SubspaceNode;
   class Object;
   class Subspace;
-  class Contact;
+  class Geometry;
+  class ThreadPool;
+  struct CollisionMaterial;
   
   
   
   
   class Collider
   {
+  public:
+    
+    /** The available broadphase collision spaces. */
+    enum Broadphase {
+      /** dSimpleSpace: tests all pairs, O(n^2). */
+      Simple,
+      /** dHashSpace: multi-resolution hash grid, about O(n). */
+      Hash,
+      /** Sweep-and-prune space, O(n log n) with good temporal coherence.
+          Not suitable for large static geoms spanning the whole axis. */
+      SweepAndPrune,
+      /** dQuadTreeSpace: fixed region quadtree, suitable for large worlds
+          with a known extent. */
+      Quadtree
+    };
+    
+    /**
+     * Broadphase selection and its parameters. Only the fields of the
+     * selected broadphases are used. The default is a hash space with the
+     * default levels of ODE, and a quadtree for the static geoms.
+     *
+     * @sa ODECollisionRenderer::setBroadphaseParams()
+     */
+    struct BroadphaseParams {
+      
+      /** The type of the top-level collision space. */
+      Broadphase broadphase;
+      
+      /** The type of the space of the static geoms. The static geoms do not
+          move, so a space that is slow to update but fast to query is a
+          good choice. */
+      Broadphase staticBroadphase;
+      
+      /** Cell size range of the hash space, as powers of two. */
+      int hashMinLevel;
+      int hashMaxLevel;
+      
+      /** Sorting axis order of the sweep-and-prune space (one of the
+          dSAP_AXES_* constants). The first axis should be the one along
+          which the geoms are spread the most. */
+      int sapAxisOrder;
+      
+      /** Center, half-extents and depth of the quadtrees. */
+      Vector quadtreeCenter;
+      Vector quadtreeExtents;
+      int quadtreeDepth;
+      
+      BroadphaseParams();
+    };
+    
     
-    typedef std::list<ObjectNode *> objectnodes_t;
-    typedef std::list<Contact *> contacts_t;
+  private:
+    
+    typedef boost::unordered_map<const Object *, ObjectNode *> objectnodes_t;
+    typedef std::vector<Contact *> contacts_t;
+    typedef FixedPool<sizeof(Contact)> contactpool_t;
+    typedef boost::unordered_map<const Subspace *, SubspaceNode *>
+    subspacenodes_t;
+    typedef std::pair<const Object *, const Object *> objectpair_t;
+    typedef boost::unordered_set<objectpair_t> objectpairs_t;
+    typedef boost::unordered_map<const CollisionMaterial *, unsigned int>
+    materialids_t;
     
     /** Maximum number of contact joints between two geoms. */
     static const int CONTACTBUF_SIZE;
     
     static void ODECollisionCallback( void * data, dGeomID lhs, dGeomID rhs );
     
+    /** A geom pair found by the broadphase. */
+    struct Candidate {
+      dGeomID lhs, rhs;
+    };
+    
+    /** The narrowphase results of a run of consecutive candidates. Each
+        chunk is written by a single thread. */
+    struct NarrowphaseChunk {
+      /** The contact points of the candidates, in order. */
+      std::vector<dContactGeom> contacts;
+      /** The number of contact points of each candidate. */
+      std::vector<int> counts;
+      /** dCollide() output of one candidate, CONTACTBUF_SIZE entries. */
+      std::vector<dContactGeom> scratch;
+    };
+    
+    static void NarrowphaseRange( void * context,
+                                  unsigned int begin, unsigned int end );
+    
+    /** The user data of the geoms, shared by all geoms of an ObjectNode. */
+    struct GeomData {
+      Object * object;
+      Geometry * geometry;
+      
+      /** Index of the geometry's material in the surface table. */
+      unsigned int material;
+    };
+    
+    
+    /** A top-level collision space, of the type selected with
+        BroadphaseParams. (The ODE C++ wrapper has no sweep-and-prune space
+        class, so all types are created through the C interface here.) */
+    class BroadphaseSpace :
+      public dSpace
+    {
+    public:
+      BroadphaseSpace( const BroadphaseParams & params,
+                       Broadphase broadphase );
+    };
+    
     
     ODEWorld & world;
-    dSimpleSpace collisionSpace;
+    BroadphaseSpace collisionSpace;
+    
+    /** The spaces of the static Objects that may collide with all dynamic
+        geoms (see isFullyCollidable()). Collided only against
+        collisionSpace, never with itself. */
+    BroadphaseSpace staticSpace;
     dJointGroup jointGroup;
-    boost::scoped_array<dContact> contactBuf;
     
-    /** All existing ObjectNode objects of the target world. The nodes are
-        owned by this container. */
+    /** All existing ObjectNode objects of the target world, by their
+        Objects. The nodes are owned by this container, and remove
+        themselves from it when deleted. */
     objectnodes_t objectNodes;
     
+    /** The nodes of the nested Subspaces, which own their collision
+        spaces. Each space holds the geoms of one Subspace, and its bounds
+        enclose them, so that a Subspace is culled as a unit. The nodes are
+        owned by this container, and remove themselves from it when
+        deleted. */
+    subspacenodes_t subspaceNodes;
+    
+    /** The spaces whose contents are collided with each other on each
+        collide(): the top-level space and the spaces of the nested
+        Subspaces, excluding the ones whose Subspace does not self-collide.
+        Only the attached spaces (see isAttached()) are listed: the
+        SubspaceNodes update the list when their Subspace is attached or
+        detached (see attachSpaces()). */
+    std::vector<dSpace *> selfCollidingSpaces;
+    
+    /** The Object pairs whose collisions are inhibited by a connection,
+        with the lower address first. */
+    objectpairs_t inhibitedPairs;
+    
     /** This contains (and owns) \em all contacts that exist in the target
-        world. */
+        world, in no particular order. Each Contact knows its own index. The
+        Contacts are allocated from contactpool_t. */
     contacts_t allContacts;
     
-    /** For quick wiping of old Contact objects. */
-    bool currentFlipflop;
+    /** The contacts of allContacts keyed by their geometry pairs. */
+    ContactTable contactTable;
+    
+    /** Incremented on each collide(), and stamped into the touched Contact
+        objects for quick wiping of the old ones. */
+    unsigned long currentGeneration;
+    
+    /** The geom pairs found by the broadphase on the current collide(), in
+        the order of the broadphase. */
+    std::vector<Candidate> candidates;
+    
+    /** The narrowphase results of the candidates, narrowphaseGrain
+        candidates per chunk. The buffers are kept between collisions. */
+    std::vector<NarrowphaseChunk> chunks;
+    
+    /** Runs the narrowphase if set. */
+    boost::shared_ptr<ThreadPool> pool;
+    unsigned int narrowphaseGrain;
+    
+    /** The registered materials, indexed by material id. The ObjectNodes
+        keep their materials alive, and the ids of the expired ones are
+        reused. */
+    std::vector< boost::weak_ptr<const CollisionMaterial> > materials;
+    
+    /** The id of each registered material by its address, and the address
+        of each id (for removing the key of an expired material). */
+    materialids_t materialIds;
+    std::vector<const CollisionMaterial *> materialKeys;
+    
+    /** The contact surface of each material pair, row-major by material
+        id. The rows are surfaceStride long, and the stride is doubled when
+        the ids run out. */
+    std::vector<dSurfaceParameters> surfaces;
+    std::size_t surfaceStride;
     
     
+    /** Returns the id of the material, registering it and computing its
+        contact surfaces with the other materials if it is new. The id of an
+        expired material is reused before the table is grown. */
+    unsigned int registerMaterial
+    ( boost::shared_ptr<const CollisionMaterial> material );
+    
+    /** Returns the contact surface between two registered materials. */
+    const dSurfaceParameters & getSurface( unsigned int lhs,
+                                           unsigned int rhs ) const
+    { return surfaces[lhs * surfaceStride + rhs]; }
+    
+    /** Computes the contact surface between two materials. */
+    static dSurfaceParameters MakeSurface( const CollisionMaterial & lhs,
+                                           const CollisionMaterial & rhs );
+    
+    
+    /** Runs dCollide() for the candidates of a chunk. */
+    void narrowphase( unsigned int chunkIndex );
+    
+    /** Creates the contact joints and touches the Contact objects of the
+        candidates that are in contact, in candidate order. */
+    void createContacts( unsigned int chunkCount );
+    
+    
+    /** Creates a contact between the geometries, which must not be in
+        contact yet. */
+    Contact * newContact( Geometry * lhs, Geometry * rhs );
+    
+    /** Deletes the contact and returns it to the pool. */
+    void deleteContact( Contact * contact );
+    
+    /** Returns the contact between the geometries, creating it if
+        necessary, and stamps it with the current generation. */
+    Contact * touchContact( Geometry * lhs, Geometry * rhs );
+    
+    /** Deletes the Contact objects that were not touched on the current
+        generation. */
+    void wipeOldContacts();
+    
+    /** Returns the key of the pair in inhibitedPairs. */
+    static objectpair_t MakePair( const Object & lhs, const Object & rhs )
+    {
+      return &lhs < &rhs ?
+        objectpair_t( &lhs, &rhs ) : objectpair_t( &rhs, &lhs );
+    }
+    
+    /** Rescans the connections between the two Objects and updates their
+        entry in inhibitedPairs. */
+    void updateInhibitedPair( const Object & lhs, const Object & rhs );
+    
+    /** Updates the pairs of all connections of the Object, or removes them
+        if forget is set. */
+    void updateInhibitedPairs( const Object & object, bool forget = false );
+    
     void initGeom( dSpace & geomSpace, Object & object );
     void initGeoms( dSpace & geomSpace, Object & object );
     void initGeoms( dSpace & geomSpace, Subspace & subspace );
     
+    /** Adds the geoms of the Subspace and its contents into the given
+        space, which belongs to the Subspace. */
+    void initSubspaceGeoms( dSpace & subspaceSpace, Subspace & subspace );
+    
+    /** Returns the collision space of a tracked Subspace, or null if the
+        Subspace is not tracked by this Collider. */
+    dSpace * findSpace( const Subspace * subspace );
+    
+    /** Is the space within the top-level collision space? The spaces of
+        Subspaces that have been removed from the world are not. */
+    bool isAttached( const dSpace & space ) const;
+    
+    /** Do the contents of the tracked Subspace collide with everything, that
+        is, do it and all of its hosts self-collide? The static Objects in
+        such Subspaces are kept in staticSpace. */
+    bool isFullyCollidable( const Subspace * subspace ) const;
+    
+    /** Places the static Objects of the Subspace and of its self-colliding
+        nested Subspaces again, after the Subspace has become fully
+        collidable or has ceased to be (see isFullyCollidable()). */
+    void replaceStaticObjects( Subspace & subspace, bool fullyCollidable );
+    
+    /** Moves the space (or geom) from its current host space, if any, into
+        the new host space, if not null. */
+    static void MoveSpace( dSpace & space, dSpace * newHost );
+    
+    /** Adds the spaces of the Subspace and of its nested Subspaces into
+        selfCollidingSpaces, or removes them, after the Subspace has been
+        attached or detached. Takes time linear in the contents of the
+        Subspace. */
+    void attachSpaces( Subspace & subspace, bool attached );
+    
+    /** Collects the spaces of the Subspace and of its nested Subspaces that
+        belong into selfCollidingSpaces. */
+    void collectSelfCollidingSpaces( Subspace & subspace,
+                                     std::vector<dSpace *> & spaces );
+    
     
     friend class ObjectNode;
+    friend class SubspaceNode;
     
     
   public:
     
     /* constructors/destructors/etc */
     
-    Collider( ODEWorld & world_ );
+    Collider( ODEWorld & world_,
+              const BroadphaseParams & broadphaseParams = BroadphaseParams() );
     
     ~Collider();
     
     
     /* accessors */
     
+    /** Returns the number of active contacts. */
+    std::size_t getContactCount() const
+    { return allContacts.size(); }
+    
+    /** Are the collisions between these Objects inhibited by a connection?
+        Takes constant time. */
+    bool areCollisionsInhibited( const Object & lhs, const Object & rhs ) const
+    { return inhibitedPairs.count( MakePair( lhs, rhs ) ) != 0; }
+    
+    /**
+     * Checks if collisions between these Objects are inhibited by scanning
+     * the connectors of lhs. The result should always equal
+     * areCollisionsInhibited() for the tracked Objects.
+     */
+    static bool ScanCollisionsInhibited( const Object & lhs,
+                                         const Object & rhs );
+    
+    
+    /* mutators */
+    
+    /**
+     * Runs the narrowphase (dCollide()) of collide() in parallel on the
+     * pool, in tasks of grain candidate pairs. A null pool runs it on the
+     * calling thread. The contact joints are created serially and in the
+     * same order in any case, so the results do not depend on the thread
+     * count.
+     *
+     * The per-thread data of ODE is allocated here on each thread of the
+     * pool and on the calling thread, which should be the thread that calls
+     * collide(). Without LS_ODE_THREADING, dCollide() is not thread-safe
+     * and the pool is ignored: the narrowphase runs on the calling thread.
+     */
+    void setThreadPool( boost::shared_ptr<ThreadPool> pool_,
+                        unsigned int grain = 64 );
+    
     
     /* operations */
     
@@ -148,6 +476,16 @@ namespace lifespace {
     
     void collide();
     
+    /** Stores the geometry pairs that are in contact into the checkpoint. */
+    void saveContacts( ODEWorld::Checkpoint & target ) const;
+    
+    /**
+     * Recreates the contacts stored in the checkpoint and deletes the others.
+     * Also empties the contact joints: the next collide() creates them
+     * again for the restored state.
+     */
+    void restoreContacts( const ODEWorld::Checkpoint & source );
+    
   };
   
   
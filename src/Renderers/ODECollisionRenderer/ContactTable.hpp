@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file ContactTable.hpp
+ *
+ * An open-addressed hash table of the active Contact objects, keyed by the
+ * ordered pair of their geometries.
+ */
+
+/**
+ * @class lifespace::ContactTable
+ * @ingroup ODECollisionRenderer
+ *
+ * @brief
+ * An open-addressed hash table of the active Contact objects, keyed by the
+ * ordered pair of their geometries.
+ *
+ * The slots are stored in one flat array with linear probing, and removal
+ * shifts the following entries back instead of leaving tombstones, so lookups
+ * stay short also when contacts come and go every tick. The table grows when
+ * it becomes half full and never shrinks. The Contact objects are not owned
+ * by the table.
+ */
+#ifndef LS_R_CONTACTTABLE_HPP
+#define LS_R_CONTACTTABLE_HPP
+
+
+#include "../../types.hpp"
+#include "../../Utility/Contact.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cassert>
+
+
+
+
+namespace lifespace {
+  
+  
+  /* forwards */
+  class Geometry;
+  
+  
+  
+  
+  class ContactTable
+  {
+    struct Slot {
+      const Geometry * lhs;
+      const Geometry * rhs;
+      
+      /** The contact, or null for an empty slot. */
+      Contact * contact;
+    };
+    
+    /** Initial number of slots, must be a power of two. */
+    static const std::size_t InitialSize = 64;
+    
+    std::vector<Slot> slots;
+    std::size_t mask;
+    std::size_t count;
+    
+    
+    /** Returns the home slot of the pair, which must be ordered. */
+    std::size_t home( const Geometry * lhs, const Geometry * rhs ) const
+    {
+      std::size_t hash =
+        reinterpret_cast<std::size_t>( lhs ) * 0x9e3779b1u ^
+        reinterpret_cast<std::size_t>( rhs );
+      hash ^= hash >> 15;
+      hash *= 0x85ebca6bu;
+      hash ^= hash >> 13;
+      return hash & mask;
+    }
+    
+    /** Doubles the number of slots and reinserts the contacts. */
+    void grow()
+    {
+      std::vector<Slot> old;
+      old.swap( slots );
+      slots.assign( old.size() * 2, Slot() );
+      mask = slots.size() - 1;
+      count = 0;
+      for( std::size_t i = 0 ; i < old.size() ; i++ ) {
+        if( old[i].contact ) insert( old[i].contact );
+      }
+    }
+    
+    
+  public:
+    
+    ContactTable() :
+      slots( InitialSize, Slot() ),
+      mask( InitialSize - 1 ),
+      count( 0 )
+    {}
+    
+    
+    /** Returns the contact between the geometries, or null if they are not
+        in contact. */
+    Contact * find( const Geometry * lhs, const Geometry * rhs ) const
+    {
+      if( rhs < lhs ) std::swap( lhs, rhs );
+      for( std::size_t i = home( lhs, rhs ) ; slots[i].contact ;
+           i = (i + 1) & mask ) {
+        if( slots[i].lhs == lhs && slots[i].rhs == rhs ) {
+          return slots[i].contact;
+        }
+      }
+      return 0;
+    }
+    
+    /** Inserts a contact. A contact between the same geometries must not
+        exist in the table. */
+    void insert( Contact * contact )
+    {
+      assert( !find( contact->getLhs(), contact->getRhs() ) );
+      if( 2 * (count + 1) > slots.size() ) grow();
+      
+      // Contact keeps its geometries ordered
+      std::size_t i = home( contact->getLhs(), contact->getRhs() );
+      while( slots[i].contact ) i = (i + 1) & mask;
+      slots[i].lhs = contact->getLhs();
+      slots[i].rhs = contact->getRhs();
+      slots[i].contact = contact;
+      count++;
+    }
+    
+    /** Removes a contact, which must exist in the table. */
+    void erase( Contact * contact )
+    {
+      std::size_t i = home( contact->getLhs(), contact->getRhs() );
+      while( slots[i].contact != contact ) {
+        assert( slots[i].contact );
+        i = (i + 1) & mask;
+      }
+      
+      // shift back the following entries that are not at their home slots
+      for( std::size_t j = (i + 1) & mask ; slots[j].contact ;
+           j = (j + 1) & mask ) {
+        std::size_t h = home( slots[j].lhs, slots[j].rhs );
+        // move j into the hole at i unless its home is cyclically in (i, j]
+        if( ( (j - h) & mask ) >= ( (j - i) & mask ) ) {
+          slots[i] = slots[j];
+          i = j;
+        }
+      }
+      slots[i].contact = 0;
+      count--;
+    }
+    
+    std::size_t size() const
+    { return count; }
+    
+    void clear()
+    {
+      slots.assign( slots.size(), Slot() );
+      count = 0;
+    }
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+
+
+#endif   /* LS_R_CONTACTTABLE_HPP */
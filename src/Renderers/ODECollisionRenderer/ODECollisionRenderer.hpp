@@ -42,11 +42,12 @@
  *
  * All objects that had a Geometry on the moment the collision renderer was
  * connected will be monitored for changes. Object deletion, geometry replacing
- * and geometry removal are supported. Direct geometry changes are not
- * supported (you can make such changes by creating a new geom and replacing
- * the old with it). Objects that did not initially have a geometry and objects
- * whose geometry is once removed will not be monitored and thus later adding a
- * geometry will have no effect.
+ * and geometry removal are supported. Direct geometry changes are picked up
+ * when they are announced with Object::geometryModified(). Objects and
+ * Subspaces can be moved between the tracked Subspaces (and (de)activated
+ * meanwhile), which updates only the moved branch. Objects that did not
+ * initially have a geometry and objects whose geometry is once removed will
+ * not be monitored and thus later adding a geometry will have no effect.
  *
  * \par Limitations
  * Scaling rotated shapes is allowed only if the rotation is axis-aligned
@@ -59,6 +60,17 @@
  * limits). This is checked in debug mode (with assert()), but in release mode
  * the scaling components are just averaged.
  *
+ * \par Broadphase
+ * The top-level collision space is a hash space by default. A simple space,
+ * a sweep-and-prune space or a quadtree can be selected instead with
+ * setBroadphaseParams() (see Collider::BroadphaseParams). The static objects
+ * are kept in a quadtree of their own by default, which is collided only
+ * against the top-level space.
+ *
+ * \par Threading
+ * The narrowphase of the collisions can be run on a ThreadPool, see
+ * setThreadPool().
+ *
  * @todo
  * This renderer is a total mess, rewrite it!
  *
@@ -76,6 +88,7 @@
 #include "../../Graphics/types.hpp"
 #include "../../Structures/ODEWorld.hpp"
 #include "../../Utility/Event.hpp"
+#include "../../Utility/ThreadPool.hpp"
 
 #include <ode/ode.h>
 #include <ode/odecpp.h>
@@ -99,6 +112,9 @@ namespace lifespace {
   {
     ODEWorld * renderTarget;
     GraphicsEvents syncEventId;
+    Collider::BroadphaseParams broadphaseParams;
+    boost::shared_ptr<ThreadPool> narrowphasePool;
+    unsigned int narrowphaseGrain;
     
     Collider * collider;
     
@@ -107,10 +123,15 @@ namespace lifespace {
     
     /* constructors/destructors/etc */
     
-    ODECollisionRenderer( ODEWorld * renderTarget_ ) :
+    ODECollisionRenderer( ODEWorld * renderTarget_,
+                          const Collider::BroadphaseParams &
+                          broadphaseParams_ = Collider::BroadphaseParams() ) :
       Renderer(),
       renderTarget( renderTarget_ ),
       syncEventId( GE_TICK ),
+      broadphaseParams( broadphaseParams_ ),
+      narrowphasePool(),
+      narrowphaseGrain( 64 ),
       collider( 0 )
     {}
     
@@ -129,13 +150,47 @@ namespace lifespace {
                                   newRenderSource )
     { assert(false); /* not (yet?) supported. */ }
     
+    /**
+     * Selects the broadphase collision space. Takes effect on the next
+     * connect(), so the renderer must not be connected.
+     */
+    void setBroadphaseParams( const Collider::BroadphaseParams & params )
+    {
+      assert_user( !collider, "Cannot change the broadphase of a connected "
+                   "ODECollisionRenderer!" );
+      broadphaseParams = params;
+    }
+    
+    const Collider::BroadphaseParams & getBroadphaseParams() const
+    { return broadphaseParams; }
+    
+    /**
+     * Runs the narrowphase of the collisions on the pool, see
+     * Collider::setThreadPool(). Takes effect immediately if connected.
+     */
+    void setThreadPool( boost::shared_ptr<ThreadPool> pool,
+                        unsigned int grain = 64 )
+    {
+      narrowphasePool = pool;
+      narrowphaseGrain = grain;
+      if( collider ) collider->setThreadPool( pool, grain );
+    }
+    
+    boost::shared_ptr<ThreadPool> getThreadPool() const
+    { return narrowphasePool; }
+    
+    /** Returns the current Collider, or null if not connected. */
+    const Collider * getCollider() const
+    { return collider; }
+    
     
     /* operations */
     
     void connect()
     {
       assert( !collider );
-      collider = new Collider( *renderTarget );
+      collider = new Collider( *renderTarget, broadphaseParams );
+      collider->setThreadPool( narrowphasePool, narrowphaseGrain );
     }
     
     void disconnect()
@@ -157,6 +212,31 @@ namespace lifespace {
       collider->collide();
     }
     
+    /**
+     * Captures the state of the target world (see ODEWorld::checkpoint())
+     * together with the collision contacts. The renderer must be connected.
+     */
+    void checkpoint( ODEWorld::Checkpoint & target ) const
+    {
+      assert( collider );
+      renderTarget->checkpoint( target );
+      collider->saveContacts( target );
+    }
+    
+    /**
+     * Restores the state of the target world and the collision contacts from
+     * a checkpoint made with checkpoint(). The contact joints are recreated
+     * by the next render(), which should precede the next step of the world
+     * (as it does with the usual event listener order).
+     */
+    void restore( const ODEWorld::Checkpoint & source )
+    {
+      assert( collider );
+      renderTarget->restore( source );
+      collider->restoreContacts( source );
+    }
+    
+    
     /** */
     virtual void processEvent( const GraphicsEvent * event )
     {
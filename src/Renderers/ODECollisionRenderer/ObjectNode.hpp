@@ -50,6 +50,7 @@
 #include "../../Structures/Object.hpp"
 #include "../../Structures/Subspace.hpp"
 #include "../../Structures/ODELocator.hpp"
+#include "../../Structures/ODEStateView.hpp"
 #include "../../Utility/shapes.hpp"
 #include "../../Utility/Geometry.hpp"
 #include "../../Utility/BasicGeometry.hpp"
@@ -87,45 +88,123 @@ namespace lifespace {
     public EventListener<Object::ObjectEvent>
   {
     Collider & collider;
-    dSpace & hostGeomSpace;
     dSimpleSpace * geomSpace;
     Object & object;
     dBodyID objectBodyID;
+    
+    /** The geoms of a Subspace stay within its own space, which is moved by
+        its SubspaceNode. */
+    const bool isSubspace;
     //boost::scoped_ptr<dGeom> geom;
     
+    /** The Collider places the static nodes again when their hosts move
+        (see Collider::replaceStaticObjects()). */
+    friend class Collider;
+    
+    /** User data of all our geoms, read by the collision callback. */
+    Collider::GeomData geomData;
+    
+    /** The material of our geoms, kept alive so that its id in the
+        Collider's surface table is not reused while the geoms exist. */
+    boost::shared_ptr<const CollisionMaterial> material;
+    
     /** Deletes all Contact objects connected with the current geometry of the
         target object. */
     void deleteContacts()
     {
-      Geometry::contacts_t & contacts =
+      const Geometry::contacts_t contacts =
         object.getGeometry()->getContacts();
       
-      for( Geometry::contacts_t::iterator i = contacts.begin() ;
+      for( Geometry::contacts_t::const_iterator i = contacts.begin() ;
            i != contacts.end() ; ) {
-        Geometry::contacts_t::iterator j = i++;
-        collider.allContacts.remove( j->second );
-        delete j->second;
+        // step past the contact before unlinking it
+        Contact * contact = i->second;
+        ++i;
+        collider.deleteContact( contact );
       }
       
-      assert_internal( contacts.empty() );
+      assert_internal( object.getGeometry()->getContacts().empty() );
+    }
+    
+    /** Returns the ODE body of the locator, or null if it is not an active
+        ODELocator. */
+    static dBodyID GetBody( const Locator * locator )
+    {
+      const ODELocator * odeLocator =
+        dynamic_cast<const ODELocator *>( locator );
+      return odeLocator && odeLocator->isActive() ?
+        odeLocator->getODEBodyId() : 0;
+    }
+    
+    /** Binds the geoms to the body of the locator, or places them statically
+        according to it if it has no body. */
+    void bindGeoms( const Locator * locator )
+    {
+      objectBodyID = GetBody( locator );
+      
+      for( int i = 0 ; i < geomSpace->getNumGeoms() ; i++ ) {
+        dGeomID geom = geomSpace->getGeom( i );
+        dGeomSetBody( geom, objectBodyID );
+        if( !objectBodyID ) {
+          applyLocatorToGeom( geom,
+                              ( locator ?
+                                *locator : (const Locator &)BasicLocator() ) );
+        }
+      }
+    }
+    
+    /** Puts our space into the space of the host, or into the static space
+        of the Collider if we are static and the host is fully collidable.
+        A null hostGeomSpace takes the space out of the collision
+        hierarchy. */
+    void place( dSpace * hostGeomSpace, const Subspace * hostSpace )
+    { place( hostGeomSpace, collider.isFullyCollidable( hostSpace ) ); }
+    
+    void place( dSpace * hostGeomSpace, bool fullyCollidable )
+    {
+      Collider::MoveSpace
+        ( *geomSpace,
+          hostGeomSpace && !objectBodyID && !isSubspace && fullyCollidable ?
+          &collider.staticSpace : hostGeomSpace );
+    }
+    
+    /** Places our space again after the object has become static or
+        dynamic. */
+    void replace()
+    {
+      if( isSubspace ) return;
+      place( collider.findSpace( object.getHostSpace() ),
+             object.getHostSpace() );
+    }
+    
+    /** Replaces the geoms with new ones made from the geometry, keeping them
+        in the current host space. */
+    void rebuildGeoms( const Geometry & geometry )
+    {
+      dSpaceID hostGeomSpace = dGeomGetSpace( (dGeomID)geomSpace->id() );
+      delete geomSpace;
+      geomSpace = new dSimpleSpace( hostGeomSpace );
+      geomSpace->setCleanup( 1 );
+      makeGeom( *geomSpace, geometry );
     }
     
     void applyLocatorToGeom( dGeomID geom, const Locator & locator )
     {
-      dGeomSetPosition( geom,
-                        locator.getLoc()(0),
-                        locator.getLoc()(1),
-                        locator.getLoc()(2) );
+      // active ODELocators in world coordinates: copy directly from the body
+      if( const ODELocator * odeLocator =
+          dynamic_cast<const ODELocator *>( &locator ) ) {
+        if( odeLocator->isInWorldCoordinates() ) {
+          ODEBodyStateView state( odeLocator->getStateView() );
+          dGeomSetPosition( geom, state.loc(0), state.loc(1), state.loc(2) );
+          dGeomSetRotation( geom, state.basis.get() );
+          return;
+        }
+      }
+      
+      const Vector & loc = locator.getLoc();
+      dGeomSetPosition( geom, loc(0), loc(1), loc(2) );
       dMatrix3 odeBasis;
-      dACCESS33(odeBasis,0,0) = locator.getBasis().getBasisVec(DIM_X)[0];
-      dACCESS33(odeBasis,1,0) = locator.getBasis().getBasisVec(DIM_X)[1];
-      dACCESS33(odeBasis,2,0) = locator.getBasis().getBasisVec(DIM_X)[2];
-      dACCESS33(odeBasis,0,1) = locator.getBasis().getBasisVec(DIM_Y)[0];
-      dACCESS33(odeBasis,1,1) = locator.getBasis().getBasisVec(DIM_Y)[1];
-      dACCESS33(odeBasis,2,1) = locator.getBasis().getBasisVec(DIM_Y)[2];
-      dACCESS33(odeBasis,0,2) = locator.getBasis().getBasisVec(DIM_Z)[0];
-      dACCESS33(odeBasis,1,2) = locator.getBasis().getBasisVec(DIM_Z)[1];
-      dACCESS33(odeBasis,2,2) = locator.getBasis().getBasisVec(DIM_Z)[2];
+      packODEBasis( locator.getBasis(), odeBasis );
       dGeomSetRotation( geom, odeBasis );
     }
       
@@ -213,7 +292,7 @@ namespace lifespace {
                             ( object.getLocator() ?
                               (const Locator &)*object.getLocator() : (const Locator &)BasicLocator() ) );
       }
-      dGeomSetData( result, (void *)&object );
+      dGeomSetData( result, (void *)&geomData );
       return result;
     }
       
@@ -246,7 +325,7 @@ namespace lifespace {
                             ( object.getLocator() ?
                               (const Locator &)*object.getLocator() : (const Locator &)BasicLocator() ) );
       }
-      dGeomSetData( result, (void *)&object );
+      dGeomSetData( result, (void *)&geomData );
       return result;
     }
     
@@ -285,7 +364,7 @@ namespace lifespace {
                             ( object.getLocator() ?
                               (const Locator &)*object.getLocator() : (const Locator &)BasicLocator() ) );
       }
-      dGeomSetData( result, (void *)&object );
+      dGeomSetData( result, (void *)&geomData );
       return result;
     }
     
@@ -366,8 +445,28 @@ namespace lifespace {
     dGeomID makeGeom( dSpace & geomSpace,
                       const BasicGeometry & basicGeometry )
     {
-      return makeGeom( geomSpace, *basicGeometry.collisionMaterial, 0, 0,
-                       *basicGeometry.shape );
+      assert_user( basicGeometry.collisionMaterial,
+                   "CollisionMaterial field of BasicGeometry must be defined "
+                   "for colliding Objects!" );
+      material = basicGeometry.collisionMaterial;
+      geomData.material = collider.registerMaterial( material );
+      
+      dGeomID result = makeGeom( geomSpace, *basicGeometry.collisionMaterial,
+                                 0, 0, *basicGeometry.shape );
+      
+      // push the collision layers into the geoms and into the object's own
+      // space, so that the broadphase rejects the filtered pairs
+      for( int i = 0 ; i < geomSpace.getNumGeoms() ; i++ ) {
+        dGeomSetCategoryBits( geomSpace.getGeom( i ),
+                              basicGeometry.categoryBits );
+        dGeomSetCollideBits( geomSpace.getGeom( i ),
+                             basicGeometry.collideBits );
+      }
+      dGeomSetCategoryBits( (dGeomID)geomSpace.id(),
+                            basicGeometry.categoryBits );
+      dGeomSetCollideBits( (dGeomID)geomSpace.id(), basicGeometry.collideBits );
+      
+      return result;
     }
       
     /* object */
@@ -393,21 +492,29 @@ namespace lifespace {
                 dSpace & hostGeomSpace_,
                 Object & object_ ) :
       collider( collider_ ),
-      hostGeomSpace( hostGeomSpace_ ),
-      geomSpace( new dSimpleSpace( hostGeomSpace_ ) ),
+      geomSpace( new dSimpleSpace( (dSpaceID)0 ) ),
       object( object_ ),
-      objectBodyID( 0 )
+      objectBodyID( 0 ),
+      isSubspace( dynamic_cast<Subspace *>( &object_ ) != 0 )
     {
+      geomData.object = &object;
+      geomData.geometry = object.getGeometry().get();
+      geomData.material = 0;
+      
+      collider.objectNodes[&object] = this;
       geomSpace->setCleanup( 1 );
       makeGeom( *geomSpace, object );
+      place( &hostGeomSpace_, object.getHostSpace() );
       object.events.addListener( this );
     }
       
     virtual ~ObjectNode()
     {
       deleteContacts();
+      collider.updateInhibitedPairs( object, true );
       object.events.removeListener( this );
       delete geomSpace; geomSpace = 0;
+      collider.objectNodes.erase( &object );
     }
     
     
@@ -429,25 +536,37 @@ namespace lifespace {
             return;
           }
           deleteContacts();
-          delete geomSpace;
-          geomSpace = new dSimpleSpace( hostGeomSpace );
-          geomSpace->setCleanup( 1 );
-          makeGeom( *geomSpace, *event->data.changingTarget.geometry );
+          geomData.geometry = event->data.changingTarget.geometry;
+          rebuildGeoms( *event->data.changingTarget.geometry );
           break;
         case Object::OE_LOCATOR_CHANGING:
+          // the new locator cannot be active yet
+          bindGeoms( event->data.changingTarget.locator );
+          replace();
+          break;
         case Object::OE_HOSTSPACE_CHANGING:
-          if( event->data.changingTarget.hostSpace == 0 ) {
-            // target object is being disconnected from its host subspace, stop
-            // tracking it
-            delete this; return;
-          }
-          assert(false);   // dynamic tracking not yet implemented
+          if( isSubspace ) break;
+          
+          // move our space into the space of the new host, or out of the
+          // collision hierarchy if the new host is not tracked
+          if( !event->data.changingTarget.hostSpace ) deleteContacts();
+          place( collider.findSpace( event->data.changingTarget.hostSpace ),
+                 event->data.changingTarget.hostSpace );
           break;
         case Object::OE_VISUAL_MODIFIED:
           break;
         case Object::OE_LOCATOR_MODIFIED:
+          // the ODE body has been created or destroyed
+          bindGeoms( object.getLocator().get() );
+          replace();
+          break;
         case Object::OE_GEOMETRY_MODIFIED:
-          assert(false);   // dynamic tracking not yet implemented
+          // the geometry stays the same, so the contacts remain valid
+          rebuildGeoms( *object.getGeometry() );
+          break;
+        case Object::OE_CONNECTION_MODIFIED:
+          collider.updateInhibitedPair
+            ( object, *event->data.changingTarget.connectedObject );
           break;
         }
     }
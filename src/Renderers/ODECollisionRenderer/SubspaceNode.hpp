@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file SubspaceNode.hpp
+ *
+ * Tracks the collision space of a Subspace.
+ */
+
+/**
+ * @class lifespace::SubspaceNode
+ * @ingroup ODECollisionRenderer
+ *
+ * @brief
+ * Owns the collision space of a nested Subspace and keeps it in the space of
+ * the Subspace's current host.
+ *
+ * The node is created and registered by the Collider. When the Subspace is
+ * removed from its host, the space is taken out of the collision hierarchy
+ * with all of its contents, and when the Subspace is inserted into a
+ * Subspace that is tracked by the same Collider, the space is put into the
+ * space of the new host. Thus moving a Subspace within the world costs
+ * constant time regardless of its contents, unless the move makes it fully
+ * collidable or ends that (see Collider::isFullyCollidable()): then its
+ * static contents are moved into or out of the static space of the
+ * Collider, which takes time linear in its contents. Taking a Subspace out
+ * of the world or putting it back also takes time linear in its contents,
+ * as the self-colliding spaces within it are removed from the list that the
+ * Collider collides on each step, or added back to it.
+ */
+#ifndef LS_R_SUBSPACENODE_HPP
+#define LS_R_SUBSPACENODE_HPP
+
+
+#include "../../types.hpp"
+#include "../../Structures/Object.hpp"
+#include "../../Structures/Subspace.hpp"
+#include "Collider.hpp"
+
+#include <ode/ode.h>
+#include <ode/odecpp.h>
+#include <ode/odecpp_collision.h>
+
+#include <algorithm>
+#include <cassert>
+
+
+
+
+namespace lifespace {
+  
+  
+  class SubspaceNode :
+    public EventListener<Object::ObjectEvent>
+  {
+    Collider & collider;
+    Subspace & subspace;
+    dSimpleSpace space;
+    
+    
+  public:
+    
+    SubspaceNode( Collider & collider_,
+                  dSpace & hostSpace,
+                  Subspace & subspace_ ) :
+      collider( collider_ ),
+      subspace( subspace_ ),
+      space( hostSpace )
+    {
+      space.setCleanup( 0 );
+      collider.subspaceNodes[&subspace] = this;
+      subspace.events.addListener( this );
+    }
+    
+    virtual ~SubspaceNode()
+    {
+      subspace.events.removeListener( this );
+      collider.subspaceNodes.erase( &subspace );
+      collider.selfCollidingSpaces.erase
+        ( std::remove( collider.selfCollidingSpaces.begin(),
+                       collider.selfCollidingSpaces.end(), &space ),
+          collider.selfCollidingSpaces.end() );
+    }
+    
+    
+    dSpace & getSpace()
+    { return space; }
+    
+    
+    virtual void processEvent( const Object::ObjectEvent * event )
+    {
+      assert_internal( event->data.source == &subspace );
+      
+      switch( event->id )
+        {
+        case Object::OE_OBJECT_DYING:
+          delete this; return;
+          break;
+        case Object::OE_HOSTSPACE_CHANGING:
+          {
+            const Subspace * hostSpace = event->data.changingTarget.hostSpace;
+            bool wasFullyCollidable = collider.isFullyCollidable( &subspace );
+            bool fullyCollidable = subspace.doesSelfCollide() &&
+              collider.isFullyCollidable( hostSpace );
+            
+            bool wasAttached = collider.isAttached( space );
+            Collider::MoveSpace( space, collider.findSpace( hostSpace ) );
+            if( collider.isAttached( space ) != wasAttached ) {
+              collider.attachSpaces( subspace, !wasAttached );
+            }
+            
+            // the static contents are kept in the static space of the
+            // Collider only while we are fully collidable
+            if( fullyCollidable != wasFullyCollidable ) {
+              collider.replaceStaticObjects( subspace, fullyCollidable );
+            }
+          }
+          break;
+        default:
+          break;
+        }
+    }
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+
+
+#endif   /* LS_R_SUBSPACENODE_HPP */
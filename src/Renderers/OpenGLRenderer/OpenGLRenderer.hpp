@@ -41,6 +41,11 @@
  * @brief
  * An OpenGL renderer for graphics Viewports.
  *
+ * If the rendered World has render interpolation enabled (see
+ * World::setRenderInterpolation()), the objects and the camera are drawn
+ * between their previous and current poses, blended with the interpolation
+ * alpha of the world.
+ *
  * @warning
  * Contextual render objects are not monitored for deletion, and no stored
  * context objects will be deleted until the renderer itself is deleted.
@@ -74,6 +79,10 @@
 #include "../../Structures/Camera.hpp"
 #include "../../Structures/Object.hpp"
 #include "../../Structures/Subspace.hpp"
+#include "../../Structures/World.hpp"
+#include "../../Structures/Quaternion.hpp"
+#include "../../Structures/ODELocator.hpp"
+#include "../../Structures/ODEStateView.hpp"
 #include "../../Utility/shapes.hpp"
 
 #include <boost/shared_ptr.hpp>
@@ -144,6 +153,18 @@ namespace lifespace {
     
     FrameState * frame;
     
+    /** The world being rendered with interpolation during a frame, or
+        null, and its interpolation alpha. */
+    const World * interpolationWorld;
+    real interpolationAlpha;
+    
+    /** A column-major OpenGL matrix indexable with (row,col). */
+    struct GLMatrix {
+      GLfloat m[4][4];
+      GLfloat & operator()( int row, int col )
+      { return m[col][row]; }
+    };
+    
     
     template<class TargetT>
     void compileDisplaylist( const TargetT & target )
@@ -197,10 +218,13 @@ namespace lifespace {
       currentRecursionDepth = 0;
       glPushMatrix();
       
+      // interpolate if enabled in the world
+      const World * world = renderSource->getTargetObject()->getHostWorld();
+      interpolationWorld = world->hasRenderInterpolation() ? world : 0;
+      interpolationAlpha = world->getInterpolationAlpha();
+      
       // move to the Camera's location
-      boost::shared_ptr<const Locator> worldLocator =
-        renderSource->getTargetObject()->getWorldLocator();
-      render( *worldLocator, Reverse );
+      renderWorldTransform( *renderSource->getTargetObject(), Reverse );
       
       // apply the Camera's scaling
       const Vector & scaling = renderSource->getScaling();
@@ -224,6 +248,7 @@ namespace lifespace {
       
       assert_internal( currentRecursionDepth == 0 );
       delete frame; frame = 0;
+      interpolationWorld = 0;
     }
     
     void render( const Object & object )
@@ -246,7 +271,7 @@ namespace lifespace {
       boost::shared_ptr<const Visual> visual = object.getVisual();
       if( visual ) {
         glPushMatrix();
-        if( locator ) render( *locator );
+        if( locator ) render( object, *locator );
         render( *visual );
         glPopMatrix();
       }
@@ -262,7 +287,7 @@ namespace lifespace {
       glPushMatrix();
       
       // move OGL if located
-      if( locator ) render( *locator );
+      if( locator ) render( subspace, *locator );
       // apply environment
       if( environment ) render( *environment, subspace );
       
@@ -310,12 +335,10 @@ namespace lifespace {
       
       // move to the Camera's location in the current world
       boost::shared_ptr<const Locator> locator = camera.getLocator();
-      if( locator ) render( *locator );
+      if( locator ) render( camera, *locator );
       
       // move to the target Object's location in the target world
-      boost::shared_ptr<const Locator> worldLocator =
-        camera.getTargetObject()->getWorldLocator();
-      render( *worldLocator, Reverse );
+      renderWorldTransform( *camera.getTargetObject(), Reverse );
       
       // apply the Camera's scaling
       const Vector & scaling = camera.getScaling();
@@ -344,9 +367,86 @@ namespace lifespace {
       --currentRecursionDepth;
     }
     
+    /**
+     * Applies the locator of the object, interpolated from the previous pose
+     * of the object if render interpolation is active.
+     */
+    void render( const Object & object, const Locator & locator,
+                 Direction direction = Normal )
+    {
+      const World::Pose * previous = interpolationWorld ?
+        interpolationWorld->getPreviousPose( object ) : 0;
+      if( !previous ) { render( locator, direction ); return; }
+      
+      real t = interpolationAlpha;
+      const Vector & loc = locator.getLoc();
+      World::Pose pose;
+      for( int i = 0 ; i < 3 ; i++ ) {
+        pose.loc[i] = previous->loc[i] + t * (loc(i) - previous->loc[i]);
+      }
+      pose.orientation = Quaternion::Nlerp
+        ( previous->orientation, locator.getBasis().getQuaternion(), t );
+      render( pose, direction );
+    }
+    
+    /**
+     * Applies the transformation from the world to the object's coordinates
+     * (Normal) or back (Reverse).
+     */
+    void renderWorldTransform( const Object & object, Direction direction )
+    {
+      if( !interpolationWorld ) {
+        render( *object.getWorldLocator(), direction );
+        return;
+      }
+      
+      // compose the (interpolated) locators along the host chain, up to the
+      // nearest world as with getWorldLocator()
+      assert( direction == Reverse );
+      for( const Object * o = &object ;
+           o && !dynamic_cast<const World *>( o ) ; o = o->getHostSpace() ) {
+        boost::shared_ptr<const Locator> locator = o->getLocator();
+        if( locator ) render( *o, *locator, Reverse );
+      }
+    }
+    
+    void render( const World::Pose & pose, Direction direction )
+    {
+      GLMatrix m;
+      if( direction == Normal ) pose.orientation.toMatrix( m );
+      else pose.orientation.conjugated().toMatrix( m );
+      for( int i = 0 ; i < 3 ; i++ ) m(3,i) = m(i,3) = 0.0;
+      m(3,3) = 1.0;
+      
+      switch( direction )
+        {
+        case Normal:
+          for( int i = 0 ; i < 3 ; i++ ) m(i,3) = pose.loc[i];
+          glMultMatrixf( (const GLfloat *)m.m );
+          break;
+        case Reverse:
+          glMultMatrixf( (const GLfloat *)m.m );
+          glTranslatef( -pose.loc[0], -pose.loc[1], -pose.loc[2] );
+          break;
+        default:
+          assert(false);   // unkown enum value
+        }
+    }
+    
     void render( const Locator & locator,
                  Direction direction = Normal )
     {
+      // active ODELocators in world coordinates: read the body state in place
+      if( direction == Normal ) {
+        if( const ODELocator * odeLocator =
+            dynamic_cast<const ODELocator *>( &locator ) ) {
+          if( odeLocator->isInWorldCoordinates() ) {
+            render( odeLocator->getStateView() );
+            return;
+          }
+        }
+      }
+      
       const Vector & loc = locator.getLoc();
       
       switch( direction )
@@ -380,6 +480,25 @@ namespace lifespace {
       glMultMatrixf( (const GLfloat *)m );
     }
     
+    /** Applies the location and orientation of an ODE body directly from
+        ODE's memory. */
+    void render( const ODEBodyStateView & state )
+    {
+      GLfloat m[4][4];   // col major!
+      int col, row;
+      
+      for( col=0 ; col<3 ; col++ ) {
+        for( row=0; row<3 ; row++ )
+          m[col][row] = state.basis(row,col);
+        m[col][3] = 0.0;
+      }
+      for( row=0; row<3 ; row++ )
+        m[3][row] = state.loc(row);
+      m[3][3] = 1.0;
+      
+      glMultMatrixf( (const GLfloat *)m );
+    }
+    
     void render( const Visual & visual )
     {
       if( autoDisplaylisting && !displaylistCompileRunning )
@@ -652,7 +771,9 @@ namespace lifespace {
       autoDisplaylisting( false ),
       displaylistCompileRunning( false ),
       maxRecursionDepth( DEFAULT_MAX_RECURSION_DEPTH ),
-      frame( 0 )
+      frame( 0 ),
+      interpolationWorld( 0 ),
+      interpolationAlpha( 1.0 )
     {}
     
     virtual ~OpenGLRenderer()
@@ -279,10 +279,11 @@ void WorldDeserializer::deserializeEntry( const string & entry )
                                  (objectFullName.length() + 1) );
   propertyData   = entry.substr( objectFullName.length() + 1 +
                                  propertyName.length() + 2 );
-  assert_user( WorldSerialization::PropertyName2Mask.find( propertyName )
-               != WorldSerialization::PropertyName2Mask.end(),
+  map<string, WorldSerialization::PropertyMask>::const_iterator property_i =
+    WorldSerialization::PropertyName2Mask.find( propertyName );
+  assert_user( property_i != WorldSerialization::PropertyName2Mask.end(),
                "Unrecognized property name '" << propertyName << "'!" );
-  property = WorldSerialization::PropertyName2Mask[propertyName];
+  property = property_i->second;
   
   // find target object
   objects_t::iterator object_i = objects.find( objectFullName );
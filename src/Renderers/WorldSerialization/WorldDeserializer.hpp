@@ -92,7 +92,7 @@ namespace lifespace {
     };
     
     
-    typedef std::map<std::string, ObjectData> objects_t;
+    typedef boost::unordered_map<std::string, ObjectData> objects_t;
     typedef std::list<std::istream *> streams_t;
     
     /** Target objects. */
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file Simulation.hpp
+ *
+ * A core module of the Lifespace Simulator.
+ */
+
+/**
+ * @defgroup Simulation Simulation
+ * 
+ * Simulation module, one of the core modules in the Lifespace Simulator,
+ * contains tools for running worlds: a headless simulation driver, stepping
+ * sets of independent worlds in parallel, etc.
+ */
+#ifndef LS_SIMULATION_HPP
+#define LS_SIMULATION_HPP
+
+
+#include "../types.hpp"
+#include "WorldSet.hpp"
+#include "SimulationDriver.hpp"
+
+
+
+
+/** */
+namespace lifespace {
+  
+  
+  
+  
+}
+
+
+
+
+#endif   /* LS_SIMULATION_HPP */
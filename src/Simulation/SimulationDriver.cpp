@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file SimulationDriver.cpp
+ */
+#include "../types.hpp"
+#include "SimulationDriver.hpp"
+#include "../Graphics/types.hpp"
+#include <sys/time.h>
+#include <time.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+using namespace lifespace;
+using std::cout;
+using std::endl;
+
+
+
+
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+static void sleepFor( double seconds )
+{
+  struct timespec ts;
+  ts.tv_sec = (time_t)seconds;
+  ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1e9);
+  nanosleep( &ts, 0 );
+}
+
+
+
+
+unsigned long SimulationDriver::run( unsigned long ticks )
+{
+  stopping = false;
+  double t0 = wallTime();
+  double schedule = t0;
+  unsigned long sent = 0;
+  
+  GraphicsEvent event = { GE_TICK, 0 };
+  while( !stopping && (ticks == 0 || sent < ticks) ) {
+    if( realTimeFactor > 0.0 ) {
+      // do not accumulate lag: a late tick moves the schedule
+      double now = wallTime();
+      if( schedule > now ) sleepFor( schedule - now );
+      else schedule = now;
+      schedule += tickLength / realTimeFactor;
+    }
+    
+    events.sendEvent( &event );
+    sent++;
+  }
+  
+  tickCount += sent;
+  runTime += wallTime() - t0;
+  return sent;
+}
+
+
+
+
+bool SimulationDriver::IsHeadless( int argc, char * argv[] )
+{
+  return argc == 3 && 0 == strcmp( argv[1], "--headless" );
+}
+
+
+void SimulationDriver::runHeadlessIfRequested( int argc, char * argv[] )
+{
+  if( !IsHeadless( argc, argv ) ) return;
+  
+  run( strtoul( argv[2], 0, 10 ) );
+  cout << getTickCount() << " ticks, " << getTickRate() << " ticks/s" << endl;
+  exit( 0 );
+}
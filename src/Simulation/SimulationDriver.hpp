@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file SimulationDriver.hpp
+ *
+ * A headless Device that drives the simulation without a display.
+ */
+
+/**
+ * @class lifespace::SimulationDriver
+ * @ingroup Simulation
+ *
+ * @brief
+ * A headless Device that drives the simulation without a display.
+ *
+ * The driver owns the tick loop that is otherwise run by the idle callback of
+ * a windowing plugin (such as GLOWDevice): run() sends GE_TICK events to the
+ * listeners of the device, so Worlds, ODECollisionRenderers,
+ * WorldSerializers etc. are connected to it exactly as they are connected to
+ * a window. The listeners receive the events in the order they were added,
+ * which should be:
+ *   -# the ODECollisionRenderer (contacts for the coming step),
+ *   -# the World (takes the step),
+ *   -# observers of the stepped world, such as a WorldSerializer.
+ *
+ * attach() adds a collision renderer and a world in this order.
+ *
+ * By default the ticks are sent as fast as possible. With
+ * setRealTimeFactor(), the ticks are paced so that the simulated time
+ * advances at a fixed rate relative to the wall time. If the listeners cannot
+ * keep up, a late tick is sent immediately and the schedule continues from it,
+ * so the lag is not made up with a burst of ticks.
+ *
+ * run() returns after the given number of ticks or when stop() has been
+ * called, for example by a listener. The driver counts the ticks sent and
+ * the wall time spent in run(), see getTickRate().
+ *
+ * Programs that normally open a window can offer a headless mode with
+ * IsHeadless() and runHeadlessIfRequested(): the command line
+ * "--headless <ticks>" then runs the given number of ticks on the driver
+ * instead of entering the main loop of the window.
+ *
+ * \par Graphics Events
+ * The following events are emitted by the SimulationDriver:
+ *   - GE_TICK: Is sent once per tick from run(). run() blocks until all
+ *     listeners have processed the event.
+ *
+ * @sa Device, World::processEvent()
+ */
+#ifndef LS_M_SIMULATIONDRIVER_HPP
+#define LS_M_SIMULATIONDRIVER_HPP
+
+
+#include "../types.hpp"
+#include "../Graphics/Device.hpp"
+#include "../Structures/World.hpp"
+#include "../Renderers/ODECollisionRenderer/ODECollisionRenderer.hpp"
+#include <boost/utility.hpp>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class SimulationDriver :
+    public Device,
+    private boost::noncopyable
+  {
+    real realTimeFactor;
+    real tickLength;
+    
+    volatile bool stopping;
+    
+    unsigned long long tickCount;
+    double runTime;
+    
+    
+  public:
+    
+    /** Creates a driver that runs as fast as possible. */
+    SimulationDriver() :
+      realTimeFactor( 0.0 ),
+      tickLength( 0.0 ),
+      stopping( false ),
+      tickCount( 0 ),
+      runTime( 0.0 )
+    {}
+    
+    virtual ~SimulationDriver() {}
+    
+    
+    /**
+     * Adds the collision renderer (if non-null) and the world as listeners,
+     * in this order.
+     */
+    void attach( World & world, ODECollisionRenderer * collisionRenderer = 0 )
+    {
+      if( collisionRenderer ) events.addListener( collisionRenderer );
+      events.addListener( &world );
+    }
+    
+    
+    /**
+     * Paces the ticks so that the simulated time advances factor times as
+     * fast as the wall time, when each tick advances the simulation by
+     * tickLength seconds (usually the default dt of the world). A zero factor
+     * runs as fast as possible.
+     */
+    void setRealTimeFactor( real factor, real tickLength_ )
+    {
+      assert( factor >= 0.0 && (factor == 0.0 || tickLength_ > 0.0) );
+      realTimeFactor = factor;
+      tickLength = tickLength_;
+    }
+    
+    /** Returns the real-time factor, or zero if running as fast as
+        possible. */
+    real getRealTimeFactor() const
+    { return realTimeFactor; }
+    
+    
+    /**
+     * Sends GE_TICK events until the given number of ticks has been sent or
+     * stop() is called. Zero sends ticks until stop() is called.
+     *
+     * @return   The number of ticks sent.
+     */
+    unsigned long run( unsigned long ticks = 0 );
+    
+    /** Makes run() return after the current tick. */
+    void stop()
+    { stopping = true; }
+    
+    
+    /** Returns the total number of ticks sent by run(). */
+    unsigned long long getTickCount() const
+    { return tickCount; }
+    
+    /** Returns the total wall time spent in run(), in seconds. */
+    double getRunTime() const
+    { return runTime; }
+    
+    /** Returns the average number of ticks sent per second of wall time. */
+    double getTickRate() const
+    { return runTime > 0.0 ? tickCount / runTime : 0.0; }
+    
+    /** Resets the tick count and the run time. */
+    void resetCounters()
+    { tickCount = 0; runTime = 0.0; }
+    
+    
+    /**
+     * Returns true if the command line is "--headless <ticks>". The caller
+     * should then attach its listeners to a SimulationDriver instead of
+     * opening a window.
+     */
+    static bool IsHeadless( int argc, char * argv[] );
+    
+    /**
+     * If the command line is "--headless <ticks>", sends the given number of
+     * ticks, prints the tick count and rate to stdout and exits the program.
+     * Otherwise returns immediately.
+     */
+    void runHeadlessIfRequested( int argc, char * argv[] );
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_M_SIMULATIONDRIVER_HPP */
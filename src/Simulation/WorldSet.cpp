@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file WorldSet.cpp
+ */
+#include "../types.hpp"
+#include "WorldSet.hpp"
+#include "../Structures/ODEWorld.hpp"
+#include "../Renderers/ODECollisionRenderer/ODECollisionRenderer.hpp"
+#include "../Utility/ThreadPool.hpp"
+#include <ode/ode.h>
+#include <boost/shared_ptr.hpp>
+#include <sys/time.h>
+using namespace lifespace;
+using boost::shared_ptr;
+
+
+
+
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+
+
+WorldSet::WorldSet( shared_ptr<Factory> factory_,
+                    unsigned int worldCount, unsigned long baseSeed,
+                    shared_ptr<ThreadPool> pool_ ) :
+  factory( factory_ ),
+  pool( pool_ ),
+  mode( Synchronized ),
+  started( false ),
+  stepCount( 0 ),
+  runTime( 0.0 )
+{
+  assert( factory && pool );
+  create( worldCount, baseSeed );
+}
+
+
+WorldSet::WorldSet( shared_ptr<Factory> factory_,
+                    unsigned int worldCount, unsigned long baseSeed,
+                    unsigned int threadCount ) :
+  factory( factory_ ),
+  pool( new ThreadPool( threadCount ) ),
+  mode( Synchronized ),
+  started( false ),
+  stepCount( 0 ),
+  runTime( 0.0 )
+{
+  assert( factory );
+  create( worldCount, baseSeed );
+}
+
+
+WorldSet::~WorldSet()
+{
+  for( unsigned int i = 0 ; i < members.size() ; i++ ) {
+    members[i].collisionRenderer->disconnect();
+    members[i].collisionRenderer.reset();
+    members[i].world->activate( false );
+    factory->destroyWorld( *members[i].world, i );
+  }
+  members.clear();
+}
+
+
+void WorldSet::create( unsigned int worldCount, unsigned long baseSeed )
+{
+  // allocate the ODE data of the pool threads once, see ODEInstance
+  pool->runOnEachThread( ODEInstance::AttachThread );
+  
+  members.resize( worldCount );
+  for( unsigned int i = 0 ; i < worldCount ; i++ ) {
+    Member & member = members[i];
+    member.seed = Seed( baseSeed, i );
+    member.world = factory->createWorld( i, member.seed );
+    assert( member.world );
+    
+    member.world->activate( true );
+    member.collisionRenderer.reset
+      ( new ODECollisionRenderer( member.world.get() ) );
+    member.collisionRenderer->connect();
+  }
+}
+
+
+void WorldSet::stepWorld( unsigned int index, unsigned int steps, real dt )
+{
+  Member & member = members[index];
+  for( unsigned int s = 0 ; s < steps ; s++ ) {
+    member.world->timestep( dt );
+    member.collisionRenderer->render();
+  }
+}
+
+
+void WorldSet::RunRange( void * context, unsigned int begin, unsigned int end )
+{
+  RunContext & c = *static_cast<RunContext *>( context );
+  for( unsigned int i = begin ; i < end ; i++ ) {
+    c.set->stepWorld( i, c.steps, c.dt );
+  }
+}
+
+
+void WorldSet::run( unsigned int steps, real dt )
+{
+  if( steps == 0 || members.empty() ) return;
+  double t0 = wallTime();
+  unsigned int remaining = steps;
+  
+  // the first step is serial, see the class documentation
+  if( !started ) {
+    for( unsigned int i = 0 ; i < members.size() ; i++ ) {
+      stepWorld( i, 1, dt );
+    }
+    started = true;
+    remaining--;
+  }
+  
+  if( mode == Synchronized ) {
+    RunContext context = { this, 1, dt };
+    for( unsigned int s = 0 ; s < remaining ; s++ ) {
+      pool->parallelFor( RunRange, &context, 0, members.size() );
+    }
+  } else {
+    RunContext context = { this, remaining, dt };
+    if( remaining > 0 ) {
+      pool->parallelFor( RunRange, &context, 0, members.size() );
+    }
+  }
+  
+  stepCount += (unsigned long long)steps * members.size();
+  runTime += wallTime() - t0;
+}
+
+
+unsigned long WorldSet::Seed( unsigned long baseSeed, unsigned int index )
+{
+  // 32-bit finalizer of MurmurHash3 over the base seed offset by the index
+  unsigned long x = (baseSeed + 0x9e3779b9UL * (index + 1UL)) & 0xffffffffUL;
+  x ^= x >> 16;
+  x = (x * 0x85ebca6bUL) & 0xffffffffUL;
+  x ^= x >> 13;
+  x = (x * 0xc2b2ae35UL) & 0xffffffffUL;
+  x ^= x >> 16;
+  return x;
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file WorldSet.hpp
+ *
+ * A set of independent ODEWorlds that are stepped concurrently.
+ */
+
+/**
+ * @class lifespace::WorldSet
+ * @ingroup Simulation
+ *
+ * @brief
+ * A set of independent ODEWorlds that are stepped concurrently.
+ *
+ * The worlds are created by a user-supplied Factory, which gets the index of
+ * each world and a seed derived deterministically from the base seed of the
+ * set and the index. The set activates each world and connects an
+ * ODECollisionRenderer of its own to it. run() then steps the worlds in
+ * parallel on a ThreadPool, one world per task, so that each world is always
+ * stepped by a single thread at a time.
+ *
+ * In the Synchronized mode, all worlds take one step before any of them takes
+ * the next one (there is a barrier after each step). In the FreeRunning mode,
+ * each task runs its world through all the requested steps at once, so cheap
+ * worlds do not wait for expensive ones. The end state of each world is the
+ * same in both modes.
+ *
+ * The set counts the world-steps taken and the wall time spent in run(), see
+ * getThroughput().
+ *
+ * \par Thread safety
+ * The first step of each world is taken serially on the calling thread, so
+ * that the lazily initialized global tables of ODE (such as the collider
+ * table) get initialized before any concurrent use. If compiled with
+ * LS_ODE_THREADING, ODE is initialized by the constructor and the per-thread
+ * data of ODE is allocated on each pool thread before it steps a world, and
+ * released when the thread exits (see ODEInstance).
+ *
+ * \par Determinism
+ * The results of a world do not depend on the thread count or the mode if
+ * its content is built from the seed only. The exception is the QuickStep
+ * solver with constraint reordering enabled (the ODE default), which draws
+ * from the global random number generator of ODE: use the BigMatrix solver
+ * or an ODE built without RANDOMLY_REORDER_CONSTRAINTS where bitwise
+ * reproducible worlds are needed.
+ *
+ * @sa ODEWorld, ThreadPool
+ */
+#ifndef LS_M_WORLDSET_HPP
+#define LS_M_WORLDSET_HPP
+
+
+#include "../types.hpp"
+#include "../Structures/ODEWorld.hpp"
+#include "../Structures/ODEInstance.hpp"
+#include "../Renderers/ODECollisionRenderer/ODECollisionRenderer.hpp"
+#include "../Utility/ThreadPool.hpp"
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <vector>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class WorldSet :
+    private boost::noncopyable
+  {
+  public:
+    
+    enum Mode {
+      Synchronized,   /**< All worlds step in lockstep. */
+      FreeRunning     /**< Each world runs through its steps on its own. */
+    };
+    
+    /** Creates and destroys the worlds of a WorldSet. */
+    class Factory {
+    public:
+      virtual ~Factory() {}
+      
+      /**
+       * Creates and populates a world. The world must not be activated, this
+       * is done by the WorldSet.
+       *
+       * @param index   The index of the world in the set.
+       * @param seed    A seed for the random content of the world.
+       */
+      virtual boost::shared_ptr<ODEWorld>
+      createWorld( unsigned int index, unsigned long seed ) = 0;
+      
+      /**
+       * Removes the content of a world before the world is released. The
+       * world has already been deactivated and its collision renderer
+       * disconnected.
+       */
+      virtual void destroyWorld( ODEWorld & world, unsigned int index ) = 0;
+    };
+    
+    
+  private:
+    
+    struct Member {
+      boost::shared_ptr<ODEWorld> world;
+      boost::shared_ptr<ODECollisionRenderer> collisionRenderer;
+      unsigned long seed;
+    };
+    
+    /** Per-call state for the range function. */
+    struct RunContext {
+      WorldSet * set;
+      unsigned int steps;
+      real dt;
+    };
+    
+    /** Keeps ODE initialized from before the first world is created until
+        after the last one is destroyed. */
+    ODEInstance ode;
+    
+    boost::shared_ptr<Factory> factory;
+    boost::shared_ptr<ThreadPool> pool;
+    std::vector<Member> members;
+    Mode mode;
+    
+    /** Whether the first, serial step has been taken. */
+    bool started;
+    
+    unsigned long long stepCount;
+    double runTime;
+    
+    
+    void create( unsigned int worldCount, unsigned long baseSeed );
+    void stepWorld( unsigned int index, unsigned int steps, real dt );
+    
+    static void RunRange( void * context,
+                          unsigned int begin, unsigned int end );
+    
+    
+  public:
+    
+    /**
+     * Creates worldCount worlds with the factory and steps them on the given
+     * pool. The pool can be shared with other users.
+     */
+    WorldSet( boost::shared_ptr<Factory> factory_,
+              unsigned int worldCount, unsigned long baseSeed,
+              boost::shared_ptr<ThreadPool> pool_ );
+    
+    /**
+     * Creates worldCount worlds with the factory and steps them on a pool of
+     * its own.
+     *
+     * @param threadCount   The total number of threads, see ThreadPool.
+     */
+    WorldSet( boost::shared_ptr<Factory> factory_,
+              unsigned int worldCount, unsigned long baseSeed = 0,
+              unsigned int threadCount = 0 );
+    
+    /** Deactivates the worlds and passes them to Factory::destroyWorld(). */
+    ~WorldSet();
+    
+    
+    unsigned int getWorldCount() const
+    { return members.size(); }
+    
+    boost::shared_ptr<ODEWorld> getWorld( unsigned int index ) const
+    { assert( index < members.size() ); return members[index].world; }
+    
+    /** Returns the seed that was given to the factory for the world. */
+    unsigned long getSeed( unsigned int index ) const
+    { assert( index < members.size() ); return members[index].seed; }
+    
+    boost::shared_ptr<ThreadPool> getThreadPool() const
+    { return pool; }
+    
+    void setMode( Mode mode_ )
+    { mode = mode_; }
+    
+    Mode getMode() const
+    { return mode; }
+    
+    
+    /**
+     * Steps each world the given number of times with the given timestep
+     * (with World::timestep() followed by a collision render), in parallel.
+     * Returns when all worlds have taken all steps.
+     */
+    void run( unsigned int steps, real dt );
+    
+    
+    /** Returns the total number of world-steps taken in run(). */
+    unsigned long long getStepCount() const
+    { return stepCount; }
+    
+    /** Returns the total wall time spent in run(), in seconds. */
+    double getRunTime() const
+    { return runTime; }
+    
+    /** Returns the aggregate throughput in world-steps per second. */
+    double getThroughput() const
+    { return runTime > 0.0 ? stepCount / runTime : 0.0; }
+    
+    /** Resets the step count and the run time. */
+    void resetCounters()
+    { stepCount = 0; runTime = 0.0; }
+    
+    
+    /**
+     * Derives the seed of a world from the base seed and the world index. The
+     * seeds of neighbouring indices are unrelated, and the result is the same
+     * on all platforms.
+     */
+    static unsigned long Seed( unsigned long baseSeed, unsigned int index );
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_M_WORLDSET_HPP */
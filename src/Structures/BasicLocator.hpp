@@ -57,9 +57,12 @@ namespace lifespace {
     public Locator
   {
     
+  protected:
+    
     /* current state */
     Vector loc;
-    BasisMatrix basis;
+    mutable BasisMatrix basis;   // mutable: subclasses may materialize it
+                                 // lazily from another representation
     
     
   public:
@@ -92,6 +95,7 @@ namespace lifespace {
     {
       loc = other.getLoc();
       basis = other.getBasis();
+      locationModified();
       return *this;
     }
     
@@ -119,19 +123,20 @@ namespace lifespace {
       static const Vector res( ZeroVector(3) );
       return res;
     }
+    /** A BasicLocator never moves by itself. */
     virtual bool isMoving() const
-    { assert(false); return false; }
+    { return false; }
     virtual bool isRotating() const
-    { assert(false); return false; }
+    { return false; }
     
     
     /* mutators */
     
     virtual void setLoc( const Vector & newLoc )
-    { loc = newLoc; }
+    { loc = newLoc; locationModified(); }
     
     virtual void setBasis( const BasisMatrix & newBasis )
-    { basis = newBasis; }
+    { basis = newBasis; locationModified(); }
     
     virtual void setVel( const Vector & newVel )
     { assert(false); }   // not implemented
@@ -168,7 +173,7 @@ namespace lifespace {
      * @param angle   Rotation angle in radians.
      */
     virtual void rotate3dRel( const Vector & axis, real angle )
-    { basis.rotate3dRel( axis, angle ); }
+    { basis.rotate3dRel( axis, angle ); locationModified(); }
     
     /** Resolves the transformation that would produce the given absolute
         locator from the given relative locator, and returns it as a
@@ -33,6 +33,9 @@
  * @brief
  * Lifespace coordinate system basis matrices.
  *
+ * The basis is stored in a fixed-size 3x3 Matrix, so copying, inverting and
+ * rotating it never allocates.
+ *
  *
  * @todo
  * dynamic dimensionality.
@@ -50,6 +53,7 @@
 #include "../types.hpp"
 #include "Vector.hpp"
 #include "Matrix.hpp"
+#include "Quaternion.hpp"
 #include <GL/gl.h>
 #include <iostream>
 
@@ -149,6 +153,15 @@ namespace lifespace {
       orthonrPhase( 0 )
     {}
     
+    /** Init from a unit quaternion. The result is orthonormal, so no
+        orthonormalization is needed. */
+    explicit BasisMatrix( const Quaternion & orientation ) :
+      Matrix( 3, 3 ),
+      orthonrPhase( 0 )
+    {
+      orientation.toMatrix( *this );
+    }
+    
     /**
      * Init from ahead and up -vectors. They don't have to be normalized. If
      * they are not orthogonal, then "up" is dominant.
@@ -169,13 +182,13 @@ namespace lifespace {
     
     /* accessors */
     
-    typedef const ublas::matrix_column< const ublas::matrix<real> >
+    typedef const ublas::matrix_column< const Matrix >
     basisvec_const_reference_t;
     
     basisvec_const_reference_t getBasisVec( unsigned int d ) const
     { return column( *(const Matrix *)this, d ); }
     
-    typedef ublas::matrix_column< ublas::matrix<real> >
+    typedef ublas::matrix_column< Matrix >
     basisvec_reference_t;
     
     basisvec_reference_t getBasisVec( unsigned int d )
@@ -190,6 +203,10 @@ namespace lifespace {
     const Vector getRight() const
     { return getBasisVec(DIM_X); }
     
+    /** Returns the orientation as a unit quaternion. */
+    Quaternion getQuaternion() const
+    { return Quaternion( *this ); }
+    
     /**
      * Returns true if the basis is axis-aligned within EPS limits.
      */
@@ -285,6 +302,10 @@ namespace lifespace {
     }
     */
   };
+  
+  
+  /** The fixed-size 3d basis. */
+  typedef BasisMatrix Basis3;
 
 
 
@@ -235,6 +235,7 @@ void Connector::connect( shared_ptr<Connector> target, Aligning aligning )
   target->targetConnector = shared_from_this();
   target->activeRole = Slave;
   
+  sendConnectionEvent( *target );
 }
 
 
@@ -244,8 +245,31 @@ void Connector::disconnect()
                "The connector being disconnected is either not connected "
                "or is not the master connector of the connection!" );
       
+  shared_ptr<Connector> target = targetConnector;
   targetConnector->targetConnector.reset();
   targetConnector->activeRole = _Invalid;
   targetConnector.reset();
   activeRole = _Invalid;
+  
+  sendConnectionEvent( *target );
+}
+
+
+void Connector::setInhibitCollisions( bool inhibitCollisions_ )
+{
+  inhibitCollisions = inhibitCollisions_;
+  if( targetConnector ) sendConnectionEvent( *targetConnector );
+}
+
+
+void Connector::sendConnectionEvent( Connector & other )
+{
+  Object::ObjectEvent event =
+    { Object::OE_CONNECTION_MODIFIED, { &hostObject, {0} } };
+  event.data.changingTarget.connectedObject = &other.hostObject;
+  hostObject.events.sendEvent( &event );
+  
+  event.data.source = &other.hostObject;
+  event.data.changingTarget.connectedObject = &hostObject;
+  other.hostObject.events.sendEvent( &event );
 }
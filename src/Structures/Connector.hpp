@@ -161,6 +161,14 @@ namespace lifespace {
     void restoreLocation( Connector & master, Connector & slave,
                           Aligning aligning );
     
+    /** Sends an OE_CONNECTION_MODIFIED event to the host Objects of this
+        connector and the given other connector. */
+    void sendConnectionEvent( Connector & other );
+    
+    /** Wakes the host Object when a control of the connector is used. */
+    virtual void wakeActor()
+    { hostObject.wake(); }
+    
     
   public:
     
@@ -221,8 +229,7 @@ namespace lifespace {
     
     /** Sets whether this connector should inhibit detection of collisions
         between the connected Objects. */
-    void setInhibitCollisions( bool inhibitCollisions_ )
-    { inhibitCollisions = inhibitCollisions_; }
+    void setInhibitCollisions( bool inhibitCollisions_ );
     
     
     /**
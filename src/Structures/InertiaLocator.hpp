@@ -121,8 +121,8 @@ namespace lifespace {
     
   protected:
     
-    /* prepared next state (dt, nextLoc and nextBasis are inherited from
-       MotionLocator) */
+    /* prepared next state (dt, nextLoc and nextOrientation are inherited
+       from MotionLocator) */
     Vector nextVel;
     Vector nextRotation;
     
@@ -197,17 +197,17 @@ namespace lifespace {
     
     /* add force in world coordinates */
     virtual void addForceAbs( const Vector & force )
-    { extForce += force; }
+    { extForce += force; wakeHostObject(); }
     
     /* add force in local coordinates */
     virtual void addForceRel( const Vector & force )
-    { extForce += prod( getBasis(), force ); }
+    { extForce += prod( getBasis(), force ); wakeHostObject(); }
     
     virtual void addTorqueAbs( const Vector & torque )
-    { extTorque += torque; }
+    { extTorque += torque; wakeHostObject(); }
 
     virtual void addTorqueRel( const Vector & torque )
-    { extTorque += prod( getBasis(), torque ); }
+    { extTorque += prod( getBasis(), torque ); wakeHostObject(); }
     
     
     /* operations */
@@ -278,11 +278,11 @@ namespace lifespace {
         real angle = norm_2( axis );
         axis /= angle;
         
-        nextBasis = getBasis();
-        nextBasis.rotate3dAbs( axis, angle );
+        nextOrientation = Quaternion( axis, angle ) * getOrientation();
+        nextOrientation.renormalize();
         
       } else {
-        nextBasis = getBasis();
+        nextOrientation = getOrientation();
       }
     }
     
@@ -293,14 +293,14 @@ namespace lifespace {
       
       // move to next state
       setLoc( nextLoc );
-      setBasis( nextBasis );
+      setOrientation( nextOrientation );
       setVel( nextVel );
       setRotation( nextRotation );
       
       // reset the step length and acceleration accumulators
       dt = NAN;
-      extForce = ZeroVector(3);
-      extTorque = ZeroVector(3);
+      extForce.clear();
+      extTorque.clear();
     }
   };
 
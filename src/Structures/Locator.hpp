@@ -156,6 +156,27 @@ namespace lifespace {
     virtual void setHostObject( Object * newHostObject )
     { hostObject = newHostObject; }
     
+    /**
+     * Implementations must call this whenever their location or orientation
+     * is modified. Bumps the location stamp of the host Object, if any (see
+     * Object::getLocationStamp()).
+     */
+    void locationModified() const;
+    
+    /**
+     * Implementations must call this when a force, torque or a non-zero
+     * velocity is applied to the locator. Wakes the host Object if it is
+     * sleeping (see Object::wake()).
+     */
+    void wakeHostObject() const;
+    
+    /**
+     * Puts the host Object to sleep if it has auto-sleep enabled (see
+     * Object::setAutoSleep()). For implementations whose state is restored
+     * to a moment at which the object was at rest.
+     */
+    void sleepHostObject() const;
+    
     /** Object needs access to the private setHostObject() method. */
     friend class Object;
     
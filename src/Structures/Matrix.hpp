@@ -33,6 +33,9 @@
  * @brief
  * Lifespace matrices.
  *
+ * Matrix is a fixed-size 3x3 matrix (Matrix3) with in-place storage. Use
+ * DynamicMatrix for run-time sized matrices; the two convert implicitly.
+ *
  * @todo
  * dynamic dimensionality.
  */
@@ -52,7 +55,14 @@ namespace lifespace {
   
   
   
-  typedef ublas::matrix<real> Matrix;
+  /** Fixed-size 3x3 matrix with in-place (stack) storage. */
+  typedef ublas::c_matrix<real,3,3> Matrix3;
+  
+  typedef Matrix3 Matrix;
+  
+  /** Heap-allocated, run-time sized matrix for interfacing with generic
+      uBLAS code. Converts implicitly to and from Matrix. */
+  typedef ublas::matrix<real> DynamicMatrix;
 
   typedef ublas::identity_matrix<real> IdentityMatrix;
   
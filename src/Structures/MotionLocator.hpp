@@ -39,6 +39,11 @@
  * related functionality. Methods relating to higher order properties
  * (i.e. forces) will assert-fail in debug mode and do nothing in release mode.
  *
+ * The orientation is stored as a unit Quaternion, and rotations are composed
+ * with quaternion products. The BasisMatrix returned by getBasis() is
+ * materialized from the quaternion on demand and cached until the orientation
+ * changes again.
+ *
  * @warning
  * Not yet fully implemented!
  *
@@ -75,14 +80,17 @@ namespace lifespace {
     Vector rotation;   // in absolute (host) coordinates
     bool moving;
     bool rotating;
+    Quaternion orientation;
+    mutable bool basisValid;   // if false, then basis has to be materialized
+                               // from orientation
     
   protected:
     
     /* prepared next state */
     real dt;   // if NAN, then the step is not prepared and nextLoc and
-               // nextBasis are not valid
+               // nextOrientation are not valid
     Vector nextLoc;
-    BasisMatrix nextBasis;
+    Quaternion nextOrientation;
     
     
   public:
@@ -97,9 +105,10 @@ namespace lifespace {
       rotation( ZeroVector(3) ),
       moving( false ),
       rotating( false ),
+      orientation( basis.getQuaternion() ),
+      basisValid( true ),
       dt( NAN ),
-      nextLoc( ZeroVector(3) ),
-      nextBasis( BasisMatrix(3) )
+      nextLoc( ZeroVector(3) )
     {}
     
     /**
@@ -113,9 +122,10 @@ namespace lifespace {
      */
     MotionLocator( const Locator & other ) :
       BasicLocator( other ),
+      orientation( basis.getQuaternion() ),
+      basisValid( true ),
       dt( NAN ),
-      nextLoc( ZeroVector(3) ),
-      nextBasis( BasisMatrix(3) )
+      nextLoc( ZeroVector(3) )
     {
       setVel( other.getVel() );
       setRotation( other.getRotation() );
@@ -133,6 +143,8 @@ namespace lifespace {
     MotionLocator & operator=( const Locator & other )
     {
       *(BasicLocator *)this = other;
+      orientation = basis.getQuaternion();
+      basisValid = true;
       setVel( other.getVel() );
       setRotation( other.getRotation() );
       dt = NAN;
@@ -147,6 +159,19 @@ namespace lifespace {
     
     /* accessors */
     
+    virtual const BasisMatrix & getBasis() const
+    {
+      if( !basisValid ) {
+        orientation.toMatrix( basis );
+        basisValid = true;
+      }
+      return basis;
+    }
+    
+    /** Returns the orientation as a unit quaternion. */
+    const Quaternion & getOrientation() const
+    { return orientation; }
+    
     virtual const Vector & getVel() const
     { return vel; }
     virtual const Vector & getRotation() const
@@ -159,10 +184,28 @@ namespace lifespace {
     
     /* mutators */
     
+    virtual void setBasis( const BasisMatrix & newBasis )
+    {
+      basis = newBasis;
+      orientation = newBasis.getQuaternion();
+      basisValid = true;
+      locationModified();
+    }
+    
+    /** Sets the orientation from a unit quaternion. The basis is
+        materialized only when it is requested the next time. */
+    void setOrientation( const Quaternion & newOrientation )
+    {
+      orientation = newOrientation;
+      basisValid = false;
+      locationModified();
+    }
+    
     virtual void setVel( const Vector & newVel )
     {
       if( lengthSquared( newVel ) >= EPS ) {
         vel = newVel; moving = true;
+        wakeHostObject();
       } else stopMoving();
     }
     
@@ -170,18 +213,27 @@ namespace lifespace {
     {
       if( lengthSquared( newRotation ) >= EPS ) {
         rotation = newRotation; rotating = true;
+        wakeHostObject();
       } else stopRotating();
     }
     
     void stopMoving()
-    { vel = ZeroVector(3); moving = false; }
+    { vel.clear(); moving = false; }
     
     void stopRotating()
-    { rotation = ZeroVector(3); rotating = false; }
+    { rotation.clear(); rotating = false; }
     
     
     /* operations */
     
+    virtual void rotate3dRel( const Vector & axis, real angle )
+    {
+      orientation *= Quaternion( axis, angle );
+      orientation.renormalize();
+      basisValid = false;
+      locationModified();
+    }
+    
     /** Calculates the new location. */
     virtual void prepare( real dt_ )
     {
@@ -198,11 +250,11 @@ namespace lifespace {
         real angle = norm_2( axis );
         axis /= angle;
         
-        nextBasis = getBasis();
-        nextBasis.rotate3dAbs( axis, angle );
+        nextOrientation = Quaternion( axis, angle ) * orientation;
+        nextOrientation.renormalize();
         
       } else {
-        nextBasis = getBasis();
+        nextOrientation = orientation;
       }
     }
     
@@ -213,7 +265,7 @@ namespace lifespace {
       
       // move to next state
       setLoc( nextLoc );
-      setBasis( nextBasis );
+      setOrientation( nextOrientation );
       
       // reset the step length
       dt = NAN;
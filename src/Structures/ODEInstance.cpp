@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file ODEInstance.cpp
+ *
+ * Implementation for the ODEInstance class.
+ */
+#include "../types.hpp"
+#include "ODEInstance.hpp"
+#include <ode/ode.h>
+#include <pthread.h>
+using namespace lifespace;
+
+
+
+
+#ifdef LS_ODE_THREADING
+/** Protects the reference count, as the counter of ODE is not atomic. */
+static pthread_mutex_t referenceLock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int references = 0;
+
+/** Non-null for the threads whose ODE data has been allocated. */
+static pthread_key_t threadKey;
+static pthread_once_t threadKeyOnce = PTHREAD_ONCE_INIT;
+#endif
+
+
+
+
+void ODEInstance::Acquire()
+{
+#ifdef LS_ODE_THREADING
+  pthread_mutex_lock( &referenceLock );
+  if( references++ == 0 ) dInitODE2( 0 );
+  pthread_mutex_unlock( &referenceLock );
+#endif
+}
+
+
+void ODEInstance::Release()
+{
+#ifdef LS_ODE_THREADING
+  pthread_mutex_lock( &referenceLock );
+  if( --references == 0 ) dCloseODE();
+  pthread_mutex_unlock( &referenceLock );
+#endif
+}
+
+
+void ODEInstance::ThreadExit( void * )
+{
+#ifdef LS_ODE_THREADING
+  dCleanupODEAllDataForThread();
+  Release();
+#endif
+}
+
+
+void ODEInstance::CreateThreadKey()
+{
+#ifdef LS_ODE_THREADING
+  pthread_key_create( &threadKey, ThreadExit );
+#endif
+}
+
+
+void ODEInstance::AttachThread()
+{
+#ifdef LS_ODE_THREADING
+  pthread_once( &threadKeyOnce, CreateThreadKey );
+  if( pthread_getspecific( threadKey ) ) return;
+  
+  Acquire();
+  dAllocateODEDataForThread( dAllocateMaskAll );
+  pthread_setspecific( threadKey, (void *)1 );
+#endif
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file ODEInstance.hpp
+ *
+ * A reference to the global initialization of ODE.
+ */
+
+/**
+ * @class lifespace::ODEInstance
+ * @ingroup Structures
+ *
+ * @brief
+ * A reference to the global initialization of ODE.
+ *
+ * If compiled with LS_ODE_THREADING, ODE is initialized with dInitODE2()
+ * when the first instance is created, and closed with dCloseODE() when the
+ * last one is destroyed. ODEWorld and WorldSet hold an instance, so ODE stays
+ * initialized while they exist.
+ *
+ * AttachThread() allocates the per-thread data of ODE for the calling thread
+ * if it has not been allocated yet. Run it on each thread of a ThreadPool
+ * with ThreadPool::runOnEachThread() before the pool is used with ODE. The data is released when the thread
+ * exits, and the thread holds a reference until then, so that ODE is not
+ * closed under it. (The data of the main thread is left to the process
+ * exit.)
+ *
+ * Without LS_ODE_THREADING ODE is used as before, without explicit
+ * initialization, and the class does nothing.
+ */
+#ifndef LS_S_ODEINSTANCE_HPP
+#define LS_S_ODEINSTANCE_HPP
+
+
+#include "../types.hpp"
+#include <boost/utility.hpp>
+
+
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class ODEInstance :
+    private boost::noncopyable
+  {
+    static void Acquire();
+    static void Release();
+    
+    /** Releases the ODE data of an exiting thread. */
+    static void ThreadExit( void * );
+    static void CreateThreadKey();
+    
+    
+  public:
+    
+    ODEInstance()
+    { Acquire(); }
+    
+    ~ODEInstance()
+    { Release(); }
+    
+    /** Allocates the per-thread data of ODE for the calling thread, if not
+        yet done. Cheap to call repeatedly. */
+    static void AttachThread();
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_S_ODEINSTANCE_HPP */
@@ -40,6 +40,9 @@ void ODELocator::prepare( real dt )
 {
   assert( isActive() );
   
+  // the host world applies the drag of all bodies in one pass by default
+  if( worldLocator->getHostODEWorld().hasBatchedDrag() ) return;
+  
   /* Apply linear and rotational air drag. The drag works in world
      coordinates, so we can use directly the worldLocator and world
      coordinates. Moment of inertia shape is not taken into account in
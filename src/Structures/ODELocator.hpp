@@ -67,6 +67,10 @@
  * increase velocities in some cases (if the drag parameters are very high,
  * some joints or contacts are connected to the host object and the motion
  * state of the locator is changing extremely fast).
+ *
+ * The drag parameters are copied to the host ODEWorld upon activation, which
+ * by default computes the drag of all of its bodies in one batched pass (see
+ * ODEWorld::setBatchedDrag()).
  * 
  * @todo
  * Consider moving the locator to be a permanent part of Object (templated
@@ -106,8 +110,12 @@
 #include "Locator.hpp"
 #include "BasicLocator.hpp"
 #include "ODEWorld.hpp"
+#include "ODEStateView.hpp"
 #include "../Utility/shapes.hpp"
+#include "../Utility/Pool.hpp"
 #include <boost/utility.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/ref.hpp>
 #include <ode/ode.h>
 #include <ode/odecpp.h>
 
@@ -126,6 +134,10 @@ namespace lifespace {
     /**
      * Interface to the ODE dBody object. Also represents the locator's state
      * relative to the host World.
+     *
+     * The body state can be read in place through getStateView(). The Locator
+     * getters return converted copies, which are all refreshed at once on the
+     * first access after each step (or after a setter).
      */
     class ODEWorldLocator :
       public Locator,
@@ -136,14 +148,28 @@ namespace lifespace {
       ODELocator & hostLocator;
       ODEWorld & hostODEWorld;
       
+      /** The body's entry in the host world's body list. */
+      HandleVector<ODEWorld::Body>::Handle bodyHandle;
+      
       mutable struct {
         Vector loc;
         BasisMatrix basis;
         Vector vel;
         Vector rotation;
-        bool validLoc:1, validBasis:1, validVel:1, validRotation:1;
+        bool valid;
       } cache;
       
+      /** Converts the whole body state into the cache in one go. */
+      void updateCache() const
+      {
+        ODEBodyStateView state( getStateView() );
+        state.loc.copyTo( cache.loc );
+        state.basis.copyTo( cache.basis );
+        state.vel.copyTo( cache.vel );
+        state.rotation.copyTo( cache.rotation );
+        cache.valid = true;
+      }
+      
     public:
       
       ODEWorldLocator( ODELocator & hostLocator_,
@@ -155,6 +181,14 @@ namespace lifespace {
         hostLocator( hostLocator_ ),
         hostODEWorld( hostODEWorld_ )
       {
+        ODEWorld::Body body = {
+          dBody::id(), &hostLocator, hostLocator.mass,
+          { hostLocator.velConstantDrag, hostLocator.velLinearDrag,
+            hostLocator.velQuadraticDrag },
+          { hostLocator.rotConstantDrag, hostLocator.rotLinearDrag,
+            hostLocator.rotQuadraticDrag } };
+        bodyHandle = hostODEWorld.bodies.insert( body );
+        
         // apply information from the location locator
         setLoc( location->getLoc() );
         setBasis( location->getBasis() );
@@ -202,27 +236,25 @@ namespace lifespace {
         dBody::setFiniteRotationMode( 0 );
         
         // init cache
-        cache.loc.resize(3);
-        cache.basis.resize(3,3);
-        cache.vel.resize(3);
-        cache.rotation.resize(3);
         invalidateCache();
       }
       
-      virtual ~ODEWorldLocator() {}
+      virtual ~ODEWorldLocator()
+      { hostODEWorld.bodies.erase( bodyHandle ); }
       
       virtual Locator * clone() const
       { assert( false ); return 0; }   // not copyable
       
       void invalidateCache() const
-      {
-        cache.validLoc = cache.validBasis =
-          cache.validVel = cache.validRotation = false;
-      }
+      { cache.valid = false; }
       
       dBodyID getODEBodyId() const
       { return dBody::id(); }
       
+      /** Returns views to the body state in ODE's memory (no copying). */
+      ODEBodyStateView getStateView() const
+      { return ODEBodyStateView( dBody::id() ); }
+      
       ODEWorld & getHostODEWorld()
       { return hostODEWorld; }
       
@@ -231,59 +263,25 @@ namespace lifespace {
       
       virtual const Vector & getLoc() const
       {
-        if( cache.validLoc ) return cache.loc;
-        
-        const dReal * odeVec = dBody::getPosition();
-        cache.loc[0] = odeVec[0];
-        cache.loc[1] = odeVec[1];
-        cache.loc[2] = odeVec[2];
-        cache.validLoc = true;
-        
+        if( !cache.valid ) updateCache();
         return cache.loc;
       }
       
       virtual const BasisMatrix & getBasis() const
       {
-        if( cache.validBasis ) return cache.basis;
-        
-        const dReal * odeBasis = dBody::getRotation();
-        cache.basis.getBasisVec(DIM_X)[0] = dACCESS33(odeBasis,0,0);;
-        cache.basis.getBasisVec(DIM_X)[1] = dACCESS33(odeBasis,1,0);;
-        cache.basis.getBasisVec(DIM_X)[2] = dACCESS33(odeBasis,2,0);;
-        cache.basis.getBasisVec(DIM_Y)[0] = dACCESS33(odeBasis,0,1);;
-        cache.basis.getBasisVec(DIM_Y)[1] = dACCESS33(odeBasis,1,1);;
-        cache.basis.getBasisVec(DIM_Y)[2] = dACCESS33(odeBasis,2,1);;
-        cache.basis.getBasisVec(DIM_Z)[0] = dACCESS33(odeBasis,0,2);;
-        cache.basis.getBasisVec(DIM_Z)[1] = dACCESS33(odeBasis,1,2);;
-        cache.basis.getBasisVec(DIM_Z)[2] = dACCESS33(odeBasis,2,2);;
-        cache.validBasis = true;
-        
+        if( !cache.valid ) updateCache();
         return cache.basis;
       }
       
       virtual const Vector & getVel() const
       {
-        if( cache.validVel ) return cache.vel;
-        
-        const dReal * odeVec = dBody::getLinearVel();
-        cache.vel[0] = odeVec[0];
-        cache.vel[1] = odeVec[1];
-        cache.vel[2] = odeVec[2];
-        cache.validVel = true;
-        
+        if( !cache.valid ) updateCache();
         return cache.vel;
       }
       
       virtual const Vector & getRotation() const
       {
-        if( cache.validRotation ) return cache.rotation;
-        
-        const dReal * odeVec = dBody::getAngularVel();
-        cache.rotation[0] = odeVec[0];
-        cache.rotation[1] = odeVec[1];
-        cache.rotation[2] = odeVec[2];
-        cache.validRotation = true;
-        
+        if( !cache.valid ) updateCache();
         return cache.rotation;
       }
 
@@ -292,41 +290,38 @@ namespace lifespace {
     
       virtual bool isRotating() const
       { return dBody::isEnabled(); }
+      
+      /** Enables the body if it has been disabled by the auto-disable
+          feature of ODE. */
+      void enable()
+      { dBody::enable(); }
     
       virtual void setLoc( const Vector & newLoc )
       {
         dBody::setPosition( newLoc[0], newLoc[1], newLoc[2] );
-        cache.validLoc = false;
+        cache.valid = false;
         hostLocator.invalidateCache();
       }
       
       virtual void setBasis( const BasisMatrix & newBasis )
       {
         dMatrix3 odeBasis;
-        dACCESS33(odeBasis,0,0) = newBasis.getBasisVec(DIM_X)[0];
-        dACCESS33(odeBasis,1,0) = newBasis.getBasisVec(DIM_X)[1];
-        dACCESS33(odeBasis,2,0) = newBasis.getBasisVec(DIM_X)[2];
-        dACCESS33(odeBasis,0,1) = newBasis.getBasisVec(DIM_Y)[0];
-        dACCESS33(odeBasis,1,1) = newBasis.getBasisVec(DIM_Y)[1];
-        dACCESS33(odeBasis,2,1) = newBasis.getBasisVec(DIM_Y)[2];
-        dACCESS33(odeBasis,0,2) = newBasis.getBasisVec(DIM_Z)[0];
-        dACCESS33(odeBasis,1,2) = newBasis.getBasisVec(DIM_Z)[1];
-        dACCESS33(odeBasis,2,2) = newBasis.getBasisVec(DIM_Z)[2];
+        packODEBasis( newBasis, odeBasis );
         dBody::setRotation( odeBasis );
-        cache.validBasis = false;
+        cache.valid = false;
         hostLocator.invalidateCache();
       }
       
       virtual void setVel( const Vector & newVel )
       {
         dBody::setLinearVel( newVel[0], newVel[1], newVel[2] );
-        cache.validVel = false;
+        cache.valid = false;
       }
       
       virtual void setRotation( const Vector & newRotation )
       {
         dBody::setAngularVel( newRotation[0], newRotation[1], newRotation[2] );
-        cache.validRotation = false;
+        cache.valid = false;
       }
       
       virtual void addForceAbs( const Vector & force )
@@ -426,10 +421,11 @@ namespace lifespace {
         // activate
         assert( !isActive() );
         assert( getHostObject() && getHostObject()->getWorldLocator() );
-        worldLocator = boost::shared_ptr<ODEWorldLocator>
-          ( new ODEWorldLocator( *this, *hostODEWorld,
-                                 getHostObject()->getWorldLocator(),
-                                 mass, density, mInertiaShape ) );
+        worldLocator = boost::allocate_shared<ODEWorldLocator>
+          ( PoolAllocator<ODEWorldLocator>(),
+            boost::ref( *this ), boost::ref( *hostODEWorld ),
+            getHostObject()->getWorldLocator(),
+            mass, density, mInertiaShape );
         worldLocator->setGravityEnabled( gravityEnabled );
         thisLocatorValid = false;
       } else {
@@ -468,7 +464,18 @@ namespace lifespace {
     }
     
     void invalidateCache() const
-    { thisLocatorValid = false; }
+    {
+      thisLocatorValid = false;
+      locationModified();
+    }
+    
+    /** Re-enables the body and wakes the host Object when a force or a
+        velocity is applied from outside. */
+    void wakeBody()
+    {
+      worldLocator->enable();
+      wakeHostObject();
+    }
     
     /**
      * @warning
@@ -489,9 +496,10 @@ namespace lifespace {
         hostLocator->transform( newLocation, Reverse );
       }
       
-      // assign it directly to the BasicLocator base class
-      nonconst_this->BasicLocator::setLoc( newLocation.getLoc() );
-      nonconst_this->BasicLocator::setBasis( newLocation.getBasis() );
+      // assign it directly to the BasicLocator state (not through the
+      // setters: this is not a modification)
+      nonconst_this->loc = newLocation.getLoc();
+      nonconst_this->basis = newLocation.getBasis();
       
       // mark this locator valid
       thisLocatorValid = true;
@@ -546,6 +554,22 @@ namespace lifespace {
       thisLocatorValid( true )
     {}
     
+    /**
+     * Creates a new ODELocator like the constructor (with default drag
+     * parameters), but allocates the locator and its reference count together
+     * in a single pooled block.
+     *
+     * @sa PoolAllocator
+     */
+    static boost::shared_ptr<ODELocator>
+    create( const Vector & loc = ZeroVector(3),
+            const BasisMatrix & basis = BasisMatrix(3),
+            real mass = 1.0, real mInertia = 1.0 )
+    {
+      return boost::allocate_shared<ODELocator>
+        ( PoolAllocator<ODELocator>(), loc, basis, mass, mInertia );
+    }
+    
     /**
      * Destroys the ODELocator.
      *
@@ -615,6 +639,23 @@ namespace lifespace {
     { density = density_; }
     
     
+    /**
+     * Returns views to the body state in ODE's memory, in world
+     * coordinates. The views are valid until the next step. The locator must
+     * be active.
+     */
+    ODEBodyStateView getStateView() const
+    {
+      assert( isActive() );
+      return worldLocator->getStateView();
+    }
+    
+    /** Returns true if the locator is active and its host space has no
+        locator up to the host World, i.e., the relative location of the
+        locator equals its world location. */
+    bool isInWorldCoordinates() const
+    { return isActive() && !findHostLocator(); }
+    
     virtual boost::shared_ptr<const Locator> getDirectWorldLocator() const
     { return worldLocator; }
 
@@ -650,6 +691,13 @@ namespace lifespace {
       return BasicLocator::getBasis();
     }
     
+    /** Returns false if inactive or if the body has been disabled by ODE. */
+    virtual bool isMoving() const
+    { return isActive() && worldLocator->isMoving(); }
+    
+    virtual bool isRotating() const
+    { return isActive() && worldLocator->isRotating(); }
+    
     
     /**
      * Sets either the stored static location if inactive, or the true relative
@@ -690,6 +738,7 @@ namespace lifespace {
     {
       assert( isActive() &&
               getHostObject() && getHostObject()->getHostSpace() );
+      wakeBody();
       
       Vector absVel( newVel );
       getHostObject()->getHostSpace()->transformToWorldCoordinates( absVel );
@@ -700,6 +749,7 @@ namespace lifespace {
     {
       assert( isActive() &&
               getHostObject() && getHostObject()->getHostSpace() );
+      wakeBody();
       
       Vector absRot( newRotation );
       getHostObject()->getHostSpace()->transformToWorldCoordinates( absRot );
@@ -712,6 +762,7 @@ namespace lifespace {
     {
       assert( isActive() &&
               getHostObject() && getHostObject()->getHostSpace() );
+      wakeBody();
       
       Vector absForce( force );
       getHostObject()->getHostSpace()->transformToWorldCoordinates( absForce );
@@ -721,6 +772,7 @@ namespace lifespace {
     virtual void addForceRel( const Vector & force )
     {
       assert( isActive() );
+      wakeBody();
       worldLocator->addForceRel( force );
     }
     
@@ -730,6 +782,7 @@ namespace lifespace {
     {
       assert( isActive() &&
               getHostObject() && getHostObject()->getHostSpace() );
+      wakeBody();
       
       Vector absTorque( torque );
       getHostObject()->getHostSpace()->transformToWorldCoordinates(absTorque);
@@ -739,6 +792,7 @@ namespace lifespace {
     virtual void addTorqueRel( const Vector & torque )
     {
       assert( isActive() );
+      wakeBody();
       worldLocator->addTorqueRel( torque );
     }
     
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file ODEStateView.hpp
+ *
+ * Read-only views to body state stored in ODE's own memory.
+ */
+
+/**
+ * @class lifespace::ODEVectorView
+ * @ingroup Structures
+ *
+ * @brief
+ * A read-only view to a 3-vector in ODE's memory (a dVector3, or the arrays
+ * returned by dBodyGetPosition(), dBodyGetLinearVel() etc.).
+ *
+ * The view does not copy anything: elements are read directly from the
+ * underlying array, with the element type of the array (usually dReal). The
+ * view is valid only as long as the underlying ODE object is not stepped or
+ * destroyed.
+ */
+
+/**
+ * @class lifespace::ODEBasisView
+ * @ingroup Structures
+ *
+ * @brief
+ * A read-only view to a 3x3 rotation matrix in ODE's memory (a dMatrix3, or
+ * the array returned by dBodyGetRotation()).
+ *
+ * ODE stores the matrix row-major with a row stride of 4. As in BasisMatrix,
+ * the basis vectors are the columns of the matrix.
+ */
+
+/**
+ * @class lifespace::ODEBodyStateView
+ * @ingroup Structures
+ *
+ * @brief
+ * Views to the location, orientation, velocity and rotation of an ODE body.
+ */
+#ifndef LS_S_ODESTATEVIEW_HPP
+#define LS_S_ODESTATEVIEW_HPP
+
+
+#include "../types.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#include <ode/ode.h>
+
+
+
+
+namespace lifespace {
+  
+  
+  
+  
+  template<typename T>
+  class ODEVectorView
+  {
+    const T * data;
+    
+  public:
+    
+    explicit ODEVectorView( const T * data_ ) :
+      data( data_ )
+    {}
+    
+    T operator()( unsigned int i ) const
+    { return data[i]; }
+    
+    T operator[]( unsigned int i ) const
+    { return data[i]; }
+    
+    /** Returns the underlying ODE array. */
+    const T * get() const
+    { return data; }
+    
+    /** Copies (and converts) the elements into the given vector. */
+    template<class V>
+    void copyTo( V & target ) const
+    {
+      target(0) = data[0];
+      target(1) = data[1];
+      target(2) = data[2];
+    }
+  };
+  
+  
+  
+  
+  template<typename T>
+  class ODEBasisView
+  {
+    const T * data;
+    
+  public:
+    
+    explicit ODEBasisView( const T * data_ ) :
+      data( data_ )
+    {}
+    
+    T operator()( unsigned int row, unsigned int col ) const
+    { return data[row * 4 + col]; }
+    
+    /** Returns the underlying ODE array. */
+    const T * get() const
+    { return data; }
+    
+    /** Copies (and converts) the elements into the given 3x3 matrix. */
+    template<class M>
+    void copyTo( M & target ) const
+    {
+      for( unsigned int row = 0 ; row < 3 ; row++ )
+        for( unsigned int col = 0 ; col < 3 ; col++ )
+          target(row,col) = data[row * 4 + col];
+    }
+  };
+  
+  
+  
+  
+  struct ODEBodyStateView
+  {
+    ODEVectorView<dReal> loc;
+    ODEBasisView<dReal> basis;
+    ODEVectorView<dReal> vel;
+    ODEVectorView<dReal> rotation;
+    
+    explicit ODEBodyStateView( dBodyID body ) :
+      loc( dBodyGetPosition( body ) ),
+      basis( dBodyGetRotation( body ) ),
+      vel( dBodyGetLinearVel( body ) ),
+      rotation( dBodyGetAngularVel( body ) )
+    {}
+  };
+  
+  
+  
+  
+  /** Packs the given 3x3 basis into ODE's dMatrix3 layout. */
+  template<class M>
+  inline void packODEBasis( const M & basis, dMatrix3 target )
+  {
+    for( unsigned int row = 0 ; row < 3 ; row++ ) {
+      for( unsigned int col = 0 ; col < 3 ; col++ )
+        dACCESS33(target,row,col) = basis(row,col);
+      target[row * 4 + 3] = 0.0;
+    }
+  }
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_S_ODESTATEVIEW_HPP */
@@ -27,14 +27,161 @@
 #include "ODEWorld.hpp"
 #include "ODELocator.hpp"
 #include "Subspace.hpp"
+#include "Connector.hpp"
+#include "../Control/Actor.hpp"
 #include <boost/shared_ptr.hpp>
 #include <list>
+#include <vector>
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 using namespace lifespace;
 
 
 
 
+ODEWorld::SolverParams::SolverParams() :
+  solver( BigMatrix ),
+  quickStepIterations( 20 ),
+  quickStepW( 1.3 ),
+  erp( 0.2 ),
+#ifdef dSINGLE
+  cfm( 1e-5 ),
+#else
+  cfm( 1e-10 ),
+#endif
+  contactMaxCorrectingVel( dInfinity ),
+  contactSurfaceLayer( 0.0 ),
+  autoDisable( false ),
+  autoDisableLinearThreshold( 0.01 ),
+  autoDisableAngularThreshold( 0.01 ),
+  autoDisableSteps( 10 ),
+  autoDisableTime( 0.0 )
+{}
+
+
+ODEWorld::SolverParams::SolverParams( dWorldID world ) :
+  solver( BigMatrix ),
+  quickStepIterations( dWorldGetQuickStepNumIterations( world ) ),
+  quickStepW( dWorldGetQuickStepW( world ) ),
+  erp( dWorldGetERP( world ) ),
+  cfm( dWorldGetCFM( world ) ),
+  contactMaxCorrectingVel( dWorldGetContactMaxCorrectingVel( world ) ),
+  contactSurfaceLayer( dWorldGetContactSurfaceLayer( world ) ),
+  autoDisable( dWorldGetAutoDisableFlag( world ) != 0 ),
+  autoDisableLinearThreshold
+  ( dWorldGetAutoDisableLinearThreshold( world ) ),
+  autoDisableAngularThreshold
+  ( dWorldGetAutoDisableAngularThreshold( world ) ),
+  autoDisableSteps( dWorldGetAutoDisableSteps( world ) ),
+  autoDisableTime( dWorldGetAutoDisableTime( world ) )
+{}
+
+
+std::size_t ODEWorld::Checkpoint::getByteSize() const
+{
+  return
+    bodyHandles.size() * sizeof(bodyHandles[0]) +
+    bodyState.size() * sizeof(dReal) +
+    controls.size() * sizeof(real) +
+    connections.size() * sizeof(connections[0]) +
+    contacts.size() * sizeof(contacts[0]);
+}
+
+
+
+
+ODEWorld::ODEWorld( const Subspace::Params & subspaceParams,
+                    const SolverParams & solverParams_ ) :
+  World( subspaceParams ),
+  bodies( false ),
+  batchedDrag( true ),
+  threadCount( 0 ),
+#ifdef LS_ODE_THREADING
+  threading( 0 ), threadPool( 0 ),
+#endif
+  islandStatistics( false ), islandCount( 0 ), largestIsland( 0 )
+{
+  setSolverParams( solverParams_ );
+}
+
+
+ODEWorld::ODEWorld( const Subspace::Params & subspaceParams ) :
+  World( subspaceParams ),
+  solverParams( dWorld::id() ),
+  bodies( false ),
+  batchedDrag( true ),
+  threadCount( 0 ),
+#ifdef LS_ODE_THREADING
+  threading( 0 ), threadPool( 0 ),
+#endif
+  islandStatistics( false ), islandCount( 0 ), largestIsland( 0 )
+{}
+
+
+ODEWorld::ODEWorld() :
+  World(),
+  solverParams( dWorld::id() ),
+  bodies( false ),
+  batchedDrag( true ),
+  threadCount( 0 ),
+#ifdef LS_ODE_THREADING
+  threading( 0 ), threadPool( 0 ),
+#endif
+  islandStatistics( false ), islandCount( 0 ), largestIsland( 0 )
+{}
+
+
+ODEWorld::~ODEWorld()
+{
+  stopThreads();
+}
+
+
+
+
+void ODEWorld::activate( bool activation )
+{
+  if( activation ) {
+    Activate( (Object *)this, this );
+    startThreads();
+  } else {
+    stopThreads();
+    Activate( (Object *)this, 0 );
+  }
+}
+
+
+
+
+void ODEWorld::setSolverParams( const SolverParams & params )
+{
+  assert( params.quickStepIterations > 0 );
+  
+  solverParams = params;
+  
+  dWorldID world = id();
+  dWorldSetQuickStepNumIterations( world, params.quickStepIterations );
+  dWorldSetQuickStepW( world, params.quickStepW );
+  dWorldSetERP( world, params.erp );
+  dWorldSetCFM( world, params.cfm );
+  dWorldSetContactMaxCorrectingVel( world, params.contactMaxCorrectingVel );
+  dWorldSetContactSurfaceLayer( world, params.contactSurfaceLayer );
+  dWorldSetAutoDisableFlag( world, params.autoDisable );
+  dWorldSetAutoDisableLinearThreshold
+    ( world, params.autoDisableLinearThreshold );
+  dWorldSetAutoDisableAngularThreshold
+    ( world, params.autoDisableAngularThreshold );
+  dWorldSetAutoDisableSteps( world, params.autoDisableSteps );
+  dWorldSetAutoDisableTime( world, params.autoDisableTime );
+}
+
+
+
+
 void ODEWorld::Activate( Object * target, ODEWorld * hostODEWorld )
 {
   if( !target ) return;
@@ -52,8 +199,447 @@ void ODEWorld::Activate( Object * target, ODEWorld * hostODEWorld )
   // if the target has an ODELocator, then activate it
   boost::shared_ptr<ODELocator> odeLocator
     ( boost::dynamic_pointer_cast<ODELocator>( target->getLocator() ) );
-  if( odeLocator ) odeLocator->activate( hostODEWorld );
+  if( odeLocator ) {
+    odeLocator->activate( hostODEWorld );
+    
+    // the ODE body has changed, notify the renderers
+    Object::ObjectEvent event =
+      { Object::OE_LOCATOR_MODIFIED, { target, {0} } };
+    event.data.changingTarget.locator = odeLocator.get();
+    target->events.sendEvent( &event );
+  }
   
   // (un)lock the target to its current hostspace
   target->lockToHostSpace( hostODEWorld ? Object::Lock : Object::Unlock );
 }
+
+
+
+
+void ODEWorld::setThreadCount( unsigned int threads )
+{
+#ifndef LS_ODE_THREADING
+  assert_user( threads <= 1,
+               "Multithreaded island solving requires building with "
+               "LS_ODE_THREADING and an ODE with the threading interface!" );
+#endif
+  
+  // restart the threads if running
+#ifdef LS_ODE_THREADING
+  bool running = threading != 0;
+#else
+  bool running = false;
+#endif
+  stopThreads();
+  threadCount = threads;
+  if( running ) startThreads();
+}
+
+
+void ODEWorld::startThreads()
+{
+#ifdef LS_ODE_THREADING
+  if( threadCount <= 1 || threading ) return;
+  
+  threading = dThreadingAllocateMultiThreadedImplementation();
+  threadPool = dThreadingAllocateThreadPool( threadCount, 0,
+                                             dAllocateFlagBasicData, 0 );
+  assert_user( threading && threadPool,
+               "Could not start the ODE island solver threads!" );
+  dThreadingThreadPoolServeMultiThreadedImplementation( threadPool,
+                                                        threading );
+  dWorldSetStepIslandsProcessingMaxThreadCount( id(), threadCount );
+  dWorldSetStepThreadingImplementation
+    ( id(), dThreadingImplementationGetFunctions( threading ), threading );
+#endif
+}
+
+
+void ODEWorld::stopThreads()
+{
+#ifdef LS_ODE_THREADING
+  if( !threading ) return;
+  
+  dThreadingImplementationShutdownProcessing( threading );
+  dThreadingFreeThreadPool( threadPool );
+  dWorldSetStepThreadingImplementation( id(), 0, 0 );
+  dThreadingFreeImplementation( threading );
+  threading = 0;
+  threadPool = 0;
+#endif
+}
+
+
+
+
+unsigned int ODEWorld::findIsland( unsigned int body )
+{
+  // path halving
+  while( islandParent[body] != body ) {
+    islandParent[body] = islandParent[islandParent[body]];
+    body = islandParent[body];
+  }
+  return body;
+}
+
+
+/**
+ * Union-find over the enabled bodies, joined by the joints between enabled
+ * bodies (including contact joints). The slot of each body in the body list
+ * is its index: it is stored in the body data pointer for the pass, and the
+ * data of the application is restored afterwards.
+ */
+void ODEWorld::countIslands()
+{
+  unsigned int n = bodies.size();
+  islandParent.resize( n );
+  islandSize.assign( n, 0 );
+  islandBodyData.resize( n );
+  
+  for( unsigned int i = 0 ; i < n ; i++ ) {
+    islandParent[i] = i;
+    islandBodyData[i] = dBodyGetData( bodies[i].id );
+    dBodySetData( bodies[i].id, (void *)(size_t)i );
+  }
+  
+  for( unsigned int i = 0 ; i < n ; i++ ) {
+    dBodyID body = bodies[i].id;
+    if( !dBodyIsEnabled( body ) ) continue;
+    
+    int jointCount = dBodyGetNumJoints( body );
+    for( int j = 0 ; j < jointCount ; j++ ) {
+      dJointID joint = dBodyGetJoint( body, j );
+      for( int k = 0 ; k < 2 ; k++ ) {
+        dBodyID other = dJointGetBody( joint, k );
+        if( !other || other == body || !dBodyIsEnabled( other ) ) continue;
+        
+        // skip the bodies that are not in the list
+        unsigned int index = (unsigned int)(size_t)dBodyGetData( other );
+        if( index >= n || bodies[index].id != other ) continue;
+        
+        unsigned int a = findIsland( i );
+        unsigned int b = findIsland( index );
+        if( a != b ) islandParent[b] = a;
+      }
+    }
+  }
+  
+  islandCount = largestIsland = 0;
+  for( unsigned int i = 0 ; i < n ; i++ ) {
+    if( !dBodyIsEnabled( bodies[i].id ) ) continue;
+    unsigned int root = findIsland( i );
+    if( islandSize[root]++ == 0 ) islandCount++;
+    if( islandSize[root] > largestIsland ) largestIsland = islandSize[root];
+  }
+  
+  for( unsigned int i = 0 ; i < n ; i++ ) {
+    dBodySetData( bodies[i].id, islandBodyData[i] );
+  }
+}
+
+
+
+
+void ODEWorld::DragBuffers::resize( unsigned int n )
+{
+  // pad to a multiple of the vector width with resting (zero) entries
+  unsigned int padded = (n + 3) & ~3u;
+  body.resize( n );
+  x.assign( padded, 0.0f ); y.assign( padded, 0.0f ); z.assign( padded, 0.0f );
+  constant.assign( padded, 0.0f );
+  linear.assign( padded, 0.0f );
+  quadratic.assign( padded, 0.0f );
+  clamp.assign( padded, 0.0f );
+  factor.resize( padded );
+}
+
+
+/**
+ * The drag kernel. For each entry, computes the speed m = |(x,y,z)| and the
+ * drag magnitude d = constant + linear * m + quadratic * m^2, limited to
+ * clamp * m / dt so that the drag cannot reverse the motion within the step
+ * (no "nodding"). The result is the factor -d / m, with which the velocity is
+ * multiplied to get the drag force, or +1 if the entry should be stopped
+ * completely (m < EPS). n must be a multiple of 4.
+ */
+static void dragKernel( unsigned int n,
+                        const float * x, const float * y, const float * z,
+                        const float * constant, const float * linear,
+                        const float * quadratic, const float * clamp,
+                        float invDt, float * factor )
+{
+#ifdef __SSE__
+  const __m128 eps = _mm_set1_ps( EPS );
+  const __m128 one = _mm_set1_ps( 1.0f );
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 vInvDt = _mm_set1_ps( invDt );
+  
+  for( unsigned int i = 0 ; i < n ; i += 4 ) {
+    __m128 vx = _mm_loadu_ps( x + i );
+    __m128 vy = _mm_loadu_ps( y + i );
+    __m128 vz = _mm_loadu_ps( z + i );
+    __m128 m = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( vx, vx ),
+                                                    _mm_mul_ps( vy, vy ) ),
+                                        _mm_mul_ps( vz, vz ) ) );
+    __m128 d = _mm_add_ps( _mm_loadu_ps( constant + i ),
+                           _mm_mul_ps( m, _mm_add_ps
+                                       ( _mm_loadu_ps( linear + i ),
+                                         _mm_mul_ps( _mm_loadu_ps
+                                                     ( quadratic + i ),
+                                                     m ) ) ) );
+    d = _mm_min_ps( d, _mm_mul_ps( _mm_mul_ps( _mm_loadu_ps( clamp + i ), m ),
+                                   vInvDt ) );
+    __m128 k = _mm_div_ps( _mm_sub_ps( zero, d ), m );
+    __m128 stop = _mm_cmplt_ps( m, eps );
+    _mm_storeu_ps( factor + i, _mm_or_ps( _mm_and_ps( stop, one ),
+                                          _mm_andnot_ps( stop, k ) ) );
+  }
+#else
+  for( unsigned int i = 0 ; i < n ; i++ ) {
+    float m = std::sqrt( x[i] * x[i] + y[i] * y[i] + z[i] * z[i] );
+    if( m < EPS ) {
+      factor[i] = 1.0f;
+    } else {
+      float d = constant[i] + m * (linear[i] + quadratic[i] * m);
+      float limit = clamp[i] * m * invDt;
+      if( d > limit ) d = limit;
+      factor[i] = -d / m;
+    }
+  }
+#endif
+}
+
+
+void ODEWorld::wakeEnabledBodies()
+{
+  for( unsigned int i = 0 ; i < bodies.size() ; i++ ) {
+    const Body & body = bodies[i];
+    if( !dBodyIsEnabled( body.id ) ) continue;
+    
+    const Object * host = body.locator->getHostObject();
+    if( host && !host->isAwake() ) {
+      // the host is not stepped until the next prepare, so refresh the
+      // caches here
+      body.locator->worldLocator->invalidateCache();
+      body.locator->invalidateCache();
+      body.locator->wakeHostObject();
+    }
+  }
+}
+
+
+
+
+void ODEWorld::applyDrag( real dt )
+{
+  // gather the moving bodies (enabled bodies, see
+  // ODEWorldLocator::isMoving()) into the buffers
+  unsigned int n = 0;
+  for( unsigned int i = 0 ; i < bodies.size() ; i++ ) {
+    if( dBodyIsEnabled( bodies[i].id ) ) n++;
+  }
+  if( n == 0 ) return;
+  velDrag.resize( n );
+  rotDrag.resize( n );
+  
+  unsigned int j = 0;
+  for( unsigned int i = 0 ; i < bodies.size() ; i++ ) {
+    const Body & body = bodies[i];
+    if( !dBodyIsEnabled( body.id ) ) continue;
+    
+    const dReal * vel = dBodyGetLinearVel( body.id );
+    velDrag.body[j] = i;
+    velDrag.x[j] = vel[0]; velDrag.y[j] = vel[1]; velDrag.z[j] = vel[2];
+    velDrag.constant[j] = body.velDrag[0];
+    velDrag.linear[j] = body.velDrag[1];
+    velDrag.quadratic[j] = body.velDrag[2];
+    velDrag.clamp[j] = body.mass;
+    
+    const dReal * rot = dBodyGetAngularVel( body.id );
+    rotDrag.x[j] = rot[0]; rotDrag.y[j] = rot[1]; rotDrag.z[j] = rot[2];
+    rotDrag.constant[j] = body.rotDrag[0];
+    rotDrag.linear[j] = body.rotDrag[1];
+    rotDrag.quadratic[j] = body.rotDrag[2];
+    rotDrag.clamp[j] = 1.0f;
+    
+    j++;
+  }
+  
+  unsigned int padded = velDrag.x.size();
+  dragKernel( padded, &velDrag.x[0], &velDrag.y[0], &velDrag.z[0],
+              &velDrag.constant[0], &velDrag.linear[0],
+              &velDrag.quadratic[0], &velDrag.clamp[0],
+              1.0f / dt, &velDrag.factor[0] );
+  dragKernel( padded, &rotDrag.x[0], &rotDrag.y[0], &rotDrag.z[0],
+              &rotDrag.constant[0], &rotDrag.linear[0],
+              &rotDrag.quadratic[0], &rotDrag.clamp[0],
+              1.0f / dt, &rotDrag.factor[0] );
+  
+  // scatter the forces (the factor is positive for stopped bodies)
+  for( j = 0 ; j < n ; j++ ) {
+    const Body & body = bodies[velDrag.body[j]];
+    
+    float k = velDrag.factor[j];
+    if( k < 0.0f ) {
+      dBodyAddForce( body.id, k * velDrag.x[j], k * velDrag.y[j],
+                     k * velDrag.z[j] );
+    } else if( k > 0.0f ) {
+      dBodySetLinearVel( body.id, 0.0, 0.0, 0.0 );
+      body.locator->worldLocator->invalidateCache();
+    }
+    
+    k = rotDrag.factor[j];
+    if( k < 0.0f ) {
+      dBodyAddTorque( body.id, k * rotDrag.x[j], k * rotDrag.y[j],
+                      k * rotDrag.z[j] );
+    } else if( k > 0.0f ) {
+      dBodySetAngularVel( body.id, 0.0, 0.0, 0.0 );
+      body.locator->worldLocator->invalidateCache();
+    }
+  }
+}
+
+
+
+
+/**
+ * Appends the control values and connector targets of the object and its
+ * contents, depth first.
+ */
+static void saveActors( const Object & object, std::vector<real> & controls,
+                        std::vector<const Connector *> & connections )
+{
+  if( const Actor * actor = dynamic_cast<const Actor *>( &object ) ) {
+    actor->saveControls( controls );
+  }
+  
+  const Object::connectors_t & connectors = object.getConnectors();
+  for( Object::connectors_t::const_iterator i = connectors.begin() ;
+       i != connectors.end() ; i++ ) {
+    i->second->saveControls( controls );
+    connections.push_back( i->second->isConnected() ?
+                           i->second->getTargetConnector().get() : 0 );
+  }
+  
+  if( const Subspace * subspace = dynamic_cast<const Subspace *>( &object ) ) {
+    const Subspace::objects_t & objects = subspace->getObjects();
+    for( Subspace::objects_t::size_type i = 0 ; i < objects.size() ; i++ ) {
+      saveActors( *objects[i], controls, connections );
+    }
+  }
+}
+
+
+/** Restores what saveActors() saved, in the same order. */
+static void restoreActors( Object & object, const std::vector<real> & controls,
+                           unsigned int & controlPos,
+                           const std::vector<const Connector *> & connections,
+                           unsigned int & connectionPos )
+{
+  if( Actor * actor = dynamic_cast<Actor *>( &object ) ) {
+    controlPos = actor->restoreControls( controls, controlPos );
+  }
+  
+  Object::connectors_t & connectors = object.getConnectors();
+  for( Object::connectors_t::iterator i = connectors.begin() ;
+       i != connectors.end() ; i++ ) {
+    controlPos = i->second->restoreControls( controls, controlPos );
+    assert_user( connectionPos < connections.size() &&
+                 connections[connectionPos] ==
+                 ( i->second->isConnected() ?
+                   i->second->getTargetConnector().get() : 0 ),
+                 "The connections have changed since the checkpoint!" );
+    connectionPos++;
+  }
+  
+  if( Subspace * subspace = dynamic_cast<Subspace *>( &object ) ) {
+    Subspace::objects_t & objects = subspace->getObjects();
+    for( Subspace::objects_t::size_type i = 0 ; i < objects.size() ; i++ ) {
+      restoreActors( *objects[i], controls, controlPos,
+                     connections, connectionPos );
+    }
+  }
+}
+
+
+void ODEWorld::checkpoint( Checkpoint & target ) const
+{
+  const unsigned int stride = Checkpoint::BodyStateSize;
+  unsigned int n = bodies.size();
+  
+  target.bodyHandles.resize( n );
+  target.bodyState.resize( n * stride );
+  for( unsigned int i = 0 ; i < n ; i++ ) {
+    dBodyID id = bodies[i].id;
+    dReal * state = &target.bodyState[i * stride];
+    
+    target.bodyHandles[i] = bodies.handleAt( i );
+    std::copy( dBodyGetPosition( id ), dBodyGetPosition( id ) + 3, state );
+    std::copy( dBodyGetQuaternion( id ), dBodyGetQuaternion( id ) + 4,
+               state + 3 );
+    std::copy( dBodyGetLinearVel( id ), dBodyGetLinearVel( id ) + 3,
+               state + 7 );
+    std::copy( dBodyGetAngularVel( id ), dBodyGetAngularVel( id ) + 3,
+               state + 10 );
+    std::copy( dBodyGetForce( id ), dBodyGetForce( id ) + 3, state + 13 );
+    std::copy( dBodyGetTorque( id ), dBodyGetTorque( id ) + 3, state + 16 );
+    state[19] = dBodyIsEnabled( id ) ? 1.0 : 0.0;
+  }
+  
+  target.controls.clear();
+  target.connections.clear();
+  saveActors( *this, target.controls, target.connections );
+  
+  target.contacts.clear();
+  target.hasContacts = false;
+  
+  target.worldTime = getWorldTime();
+  target.worldIteration = getWorldIteration();
+}
+
+
+void ODEWorld::restore( const Checkpoint & source )
+{
+  const unsigned int stride = Checkpoint::BodyStateSize;
+  unsigned int n = source.bodyHandles.size();
+  assert_user( n == bodies.size(),
+               "Bodies have been added or removed since the checkpoint!" );
+  
+  for( unsigned int i = 0 ; i < n ; i++ ) {
+    // the dense order is unchanged unless bodies have been removed
+    const HandleVector<Body>::Handle & handle = source.bodyHandles[i];
+    assert_user( bodies.contains( handle ),
+                 "Bodies have been added or removed since the checkpoint!" );
+    const Body & body = bodies.handleAt( i ) == handle ?
+      bodies[i] : bodies.get( handle );
+    const dReal * state = &source.bodyState[i * stride];
+    
+    dBodySetPosition( body.id, state[0], state[1], state[2] );
+    dBodySetQuaternion( body.id, state + 3 );
+    dBodySetLinearVel( body.id, state[7], state[8], state[9] );
+    dBodySetAngularVel( body.id, state[10], state[11], state[12] );
+    dBodySetForce( body.id, state[13], state[14], state[15] );
+    dBodySetTorque( body.id, state[16], state[17], state[18] );
+    
+    body.locator->worldLocator->invalidateCache();
+    body.locator->invalidateCache();
+    
+    // the host follows the body, as after a step (see wakeEnabledBodies())
+    if( state[19] != 0.0 ) {
+      dBodyEnable( body.id );
+      body.locator->wakeHostObject();
+    } else {
+      dBodyDisable( body.id );
+      body.locator->sleepHostObject();
+    }
+  }
+  
+  unsigned int controlPos = 0, connectionPos = 0;
+  restoreActors( *this, source.controls, controlPos,
+                 source.connections, connectionPos );
+  assert_user( controlPos == source.controls.size() &&
+               connectionPos == source.connections.size(),
+               "The controls have changed since the checkpoint!" );
+  
+  setWorldClock( source.worldTime, source.worldIteration );
+}
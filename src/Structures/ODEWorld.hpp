@@ -91,9 +91,13 @@
 
 #include "../types.hpp"
 #include "World.hpp"
+#include "ODEInstance.hpp"
+#include "../Utility/HandleVector.hpp"
 #include <ode/ode.h>
 #include <ode/odecpp.h>
 #include <boost/shared_ptr.hpp>
+#include <vector>
+#include <utility>
 
 
 
@@ -101,17 +105,215 @@
 namespace lifespace {
   
   
+  /* forwards */
+  class ODELocator;
+  class Connector;
+  class Geometry;
+  class Collider;
+  
+  
   
   
   class ODEWorld :
+    private ODEInstance,
     public World,
     public dWorld
   {
+  public:
+    
+    /** The available ODE step functions. */
+    enum Solver {
+      /** dWorldStep(): exact big-matrix solver, O(n^3) in the number of
+          constraint rows. */
+      BigMatrix,
+      /** dWorldQuickStep(): iterative SOR-LCP solver, O(n * iterations). */
+      QuickStep
+    };
+    
+    /**
+     * Solver, constraint and auto-disable parameters of the ODE world. The
+     * default constructor sets the documented defaults of ODE itself, except
+     * for the solver selection which keeps the exact BigMatrix solver. To
+     * change only some of the parameters of a world, start from its
+     * getSolverParams() instead.
+     *
+     * @sa setSolverParams()
+     */
+    struct SolverParams {
+      
+      /** The step function to use. */
+      Solver solver;
+      
+      /** Number of SOR iterations per step with QuickStep. */
+      int quickStepIterations;
+      
+      /** The SOR over-relaxation factor with QuickStep. */
+      real quickStepW;
+      
+      /** Global error reduction parameter. */
+      real erp;
+      
+      /** Global constraint force mixing. */
+      real cfm;
+      
+      /** Maximum velocity that contacts may use to correct penetration
+          (dInfinity for no limit). */
+      real contactMaxCorrectingVel;
+      
+      /** Allowed depth of penetration for resting contacts. */
+      real contactSurfaceLayer;
+      
+      /** Should idle bodies be disabled automatically? */
+      bool autoDisable;
+      
+      /** A body is idle when its linear and angular speeds have stayed
+          below these thresholds for autoDisableSteps steps and
+          autoDisableTime seconds. */
+      real autoDisableLinearThreshold;
+      real autoDisableAngularThreshold;
+      int autoDisableSteps;
+      real autoDisableTime;
+      
+      SolverParams();
+      
+      /** Reads the current parameters of the given ODE world (with the
+          BigMatrix solver). */
+      explicit SolverParams( dWorldID world );
+    };
+    
+    
+  private:
+    
     real dt;
+    SolverParams solverParams;
+    
+    /** An active ODELocator's body and a copy of its drag parameters. */
+    struct Body {
+      dBodyID id;
+      ODELocator * locator;
+      real mass;
+      real velDrag[3];
+      real rotDrag[3];
+    };
+    
+    /** The bodies of all active ODELocators in this world. Maintained by the
+        ODELocators. */
+    HandleVector<Body> bodies;
+    
+    /** Apply the drag of all bodies in one batched pass? */
+    bool batchedDrag;
+    
+    /** Structure-of-arrays buffers for the drag pass: velocity components,
+        constant, linear and quadratic drag coefficients and the nodding
+        clamp scale of each moving body, and the resulting force factors. */
+    struct DragBuffers {
+      std::vector<unsigned int> body;
+      std::vector<float> x, y, z, constant, linear, quadratic, clamp;
+      std::vector<float> factor;
+      
+      void resize( unsigned int n );
+    } velDrag, rotDrag;
+    
+    /** Number of island solver threads (0 or 1 disables threading). */
+    unsigned int threadCount;
+    
+#ifdef LS_ODE_THREADING
+    dThreadingImplementationID threading;
+    dThreadingThreadPoolID threadPool;
+#endif
+    
+    /** Island statistics of the last step, see getIslandCount(). */
+    bool islandStatistics;
+    unsigned int islandCount;
+    unsigned int largestIsland;
+    std::vector<unsigned int> islandParent;
+    std::vector<unsigned int> islandSize;
+    std::vector<void *> islandBodyData;
+    
+    
+    /** Creates the threading implementation and its thread pool and
+        attaches them to the world, if threading is enabled. */
+    void startThreads();
+    
+    /** Detaches and frees the threading implementation, if any. */
+    void stopThreads();
+    
+    /** Computes the island statistics from the current bodies and joints. */
+    void countIslands();
+    
+    unsigned int findIsland( unsigned int body );
+    
+    /** Gathers the velocities of the moving bodies, computes the drag
+        forces with a vectorized kernel and applies them to the bodies. */
+    void applyDrag( real dt );
+    
+    /** Wakes the host Objects of the enabled bodies that are sleeping, and
+        invalidates their locator caches. ODE enables bodies on its own
+        (through joints and contacts with enabled bodies), so the hosts of
+        those bodies must be processed again by the integrators. */
+    void wakeEnabledBodies();
+    
+    /** ODELocators register their bodies. */
+    friend class ODELocator;
     
     
   public:
     
+    /**
+     * The dynamic state of an ODEWorld at one moment, see checkpoint().
+     *
+     * A checkpoint can be restored any number of times. Reusing a checkpoint
+     * as the target of later checkpoints reuses its buffers, so that
+     * repeated checkpointing does not allocate memory.
+     */
+    class Checkpoint
+    {
+      friend class ODEWorld;
+      friend class Collider;
+      
+      /** dReals per body: location (3), orientation quaternion (4), linear
+          and angular velocity (3 + 3), force and torque accumulators
+          (3 + 3) and the enabled flag (1). */
+      static const unsigned int BodyStateSize = 20;
+      
+      std::vector< HandleVector<Body>::Handle > bodyHandles;
+      std::vector<dReal> bodyState;
+      
+      /** Control values of all Actors and Connectors, in hierarchy order. */
+      std::vector<real> controls;
+      
+      /** The target of each Connector (null if disconnected), in hierarchy
+          order. Used for checking that the topology has not changed. */
+      std::vector<const Connector *> connections;
+      
+      /** Geometry pairs in contact, filled by ODECollisionRenderer. */
+      std::vector< std::pair<Geometry *, Geometry *> > contacts;
+      bool hasContacts;
+      
+      double worldTime;
+      long long worldIteration;
+      
+    public:
+      
+      Checkpoint() :
+        hasContacts( false ),
+        worldTime( 0.0 ),
+        worldIteration( 0 )
+      {}
+      
+      /** Returns the number of bodies in the checkpoint. */
+      unsigned int getBodyCount() const
+      { return bodyHandles.size(); }
+      
+      /** Returns true if the checkpoint contains the collision contacts. */
+      bool hasContactState() const
+      { return hasContacts; }
+      
+      /** Returns the size of the captured state in bytes. */
+      std::size_t getByteSize() const;
+    };
+    
+    
     /**
      * Activates or deactivates the target object or subspace (and recursively
      * all entities that are connected to it).
@@ -144,32 +346,91 @@ namespace lifespace {
     
     
     /**
-     * Creates a new ODE-managed world.
+     * Creates a new ODE-managed world with the given solver parameters.
      *
      * @param subspaceParams   Constructor params for the subspace base class.
      */
-    ODEWorld( const Subspace::Params & subspaceParams ) :
-      World( subspaceParams )
-    {}
+    ODEWorld( const Subspace::Params & subspaceParams,
+              const SolverParams & solverParams_ );
     
     /**
-     * Creates a new world with a default constructed Subspace base class.
+     * Creates a new ODE-managed world. The solver parameters are left to the
+     * defaults of ODE.
+     *
+     * @param subspaceParams   Constructor params for the subspace base class.
      */
-    ODEWorld() :
-      World()
-    {}
+    ODEWorld( const Subspace::Params & subspaceParams );
+    
+    /**
+     * Creates a new world with a default constructed Subspace base class. The
+     * solver parameters are left to the defaults of ODE.
+     */
+    ODEWorld();
+    
+    /** Stops the solver threads, if running. */
+    virtual ~ODEWorld();
     
     
     /**
      * Activates or deactivates the whole world (all connected entities).
      *
      * This method calls the static ODEWorld::Activate() method with this world
-     * as the target object, see its documentation for details.
+     * as the target object, see its documentation for details. The island
+     * solver threads (see setThreadCount()) are started upon activation and
+     * stopped upon deactivation.
      *
      * @sa Activate()
      */
-    void activate( bool activation )
-    { Activate( (Object *)this, activation ? this : 0 ); }
+    void activate( bool activation );
+    
+    
+    /**
+     * Sets the number of threads used for solving independent islands of
+     * bodies in parallel. Zero or one solves all islands on the stepping
+     * thread, which is the default. The threads are running only while the
+     * world is active: if it is active already, they are restarted with the
+     * new count.
+     *
+     * Requires an ODE with the threading interface (0.13 or later) and the
+     * library built with LS_ODE_THREADING defined. Otherwise only zero or one
+     * is accepted.
+     */
+    void setThreadCount( unsigned int threads );
+    
+    unsigned int getThreadCount() const
+    { return threadCount; }
+    
+    /**
+     * Selects whether the drag forces of the ODELocators (see ODELocator) are
+     * computed for all bodies in one batched pass at the start of the prepare
+     * pass, or separately in each ODELocator::prepare(). The results are the
+     * same, except that the batched pass reads the velocities before any
+     * Object is prepared. Enabled by default.
+     */
+    void setBatchedDrag( bool enable )
+    { batchedDrag = enable; }
+    
+    bool hasBatchedDrag() const
+    { return batchedDrag; }
+    
+    /**
+     * Enables or disables the island statistics. When enabled, each step
+     * counts the islands (groups of enabled bodies connected by joints or
+     * contacts) that ODE will solve independently. Costs one pass over the
+     * bodies and their joints per step. Disabled by default.
+     */
+    void setIslandStatistics( bool enable )
+    { islandStatistics = enable; islandCount = largestIsland = 0; }
+    
+    /** Returns the number of islands solved in the last step (zero if the
+        statistics are disabled). */
+    unsigned int getIslandCount() const
+    { return islandCount; }
+    
+    /** Returns the number of bodies in the largest island of the last
+        step. */
+    unsigned int getLargestIslandSize() const
+    { return largestIsland; }
     
     
     /**
@@ -199,15 +460,65 @@ namespace lifespace {
     }
     
     
+    /**
+     * Sets the solver, constraint and auto-disable parameters.
+     *
+     * @note
+     * ODE copies the auto-disable parameters into each body when the body is
+     * created, so the auto-disable settings apply only to ODELocators that
+     * are activated after this call. A body disabled by ODE reports itself as
+     * not moving, which lets an ActiveSetIntegrator put its Object to sleep.
+     */
+    void setSolverParams( const SolverParams & params );
+    
+    const SolverParams & getSolverParams() const
+    { return solverParams; }
+    
+    
+    /**
+     * Captures the dynamic state of the world into the target checkpoint:
+     * the location, orientation, velocities and accumulated forces of all
+     * active ODELocators, the control values of all Actors and Connectors
+     * and the world time. See ODECollisionRenderer::checkpoint() for also
+     * capturing the collision contacts.
+     *
+     * Structural state is not captured: the same objects must exist, be
+     * active and be connected in the same way when the checkpoint is
+     * restored. Connector joints have no state of their own besides their
+     * controls.
+     */
+    void checkpoint( Checkpoint & target ) const;
+    
+    /**
+     * Restores the state captured with checkpoint(). Takes time linear in the
+     * number of bodies and objects, and does not create or destroy any ODE
+     * objects.
+     *
+     * The host Objects of the enabled bodies are woken, and those of the
+     * disabled bodies are put to sleep if they have auto-sleep enabled (see
+     * Object::setAutoSleep()).
+     *
+     * ODE's auto-disable idle counters are not captured: they restart from
+     * zero for the enabled bodies. With auto-disable on, a restored branch
+     * may therefore disable its bodies at different steps than the original
+     * one.
+     */
+    void restore( const Checkpoint & source );
+    
+    
     virtual void prepare( real dt_ )
     {
       dt = dt_;
+      if( batchedDrag ) applyDrag( dt_ );
       World::prepare( dt_ );
     }
     
     virtual void step()
     {
-      dWorld::step( dt );
+      if( islandStatistics ) countIslands();
+      if( solverParams.solver == QuickStep ) dWorldQuickStep( id(), dt );
+      else dWorld::step( dt );
+      wakeEnabledBodies();
       World::step();
     }
   };
@@ -31,14 +31,18 @@
 #include "Locator.hpp"
 #include "BasicLocator.hpp"
 #include "Subspace.hpp"
+#include "World.hpp"
 #include "ODEWorld.hpp"
 #include "../Utility/Event.hpp"
+#include "../Utility/Pool.hpp"
 #include "../Graphics/Visual.hpp"
 #include "../Utility/Geometry.hpp"
 using namespace lifespace;
 
 #include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
 using boost::shared_ptr;
+using boost::allocate_shared;
 
 #include <string>
 using std::string;
@@ -65,6 +69,7 @@ void Object::setHostSpace( Subspace * newHostSpace )
   
   // set the hostspace
   hostSpace = newHostSpace;
+  locationModified();
 }
 
 
@@ -73,9 +78,9 @@ void Object::setHostSpace( Subspace * newHostSpace )
 Object::Params::Params( Locator * locator_,
                         Visual * visual_,
                         Geometry * geometry_ ) :
-  locator( shared_ptr<Locator>(locator_) ),
-  visual( shared_ptr<Visual>(visual_) ),
-  geometry( shared_ptr<Geometry>(geometry_) )
+  locator( pool_shared( locator_ ) ),
+  visual( pool_shared( visual_ ) ),
+  geometry( pool_shared( geometry_ ) )
 {}
 
 
@@ -99,9 +104,18 @@ Object::Object( const Object::Params & params ) :
   locator( params.locator ),
   visual( params.visual ),
   geometry( params.geometry ),
-  hostSpace( 0 ), lockedToHostSpace( false ),
-  name( "(unnamed)" )
+  hostSpace( 0 ), lockedToHostSpace( false ), threadSafePrepare( false ),
+  awake( true ), autoSleep( false ),
+  name( "(unnamed)" ),
+  pathWorld( 0 ), pathSymbol( SymbolTable::NoSymbol ),
+  pathPrev( 0 ), pathNext( 0 ),
+  locationStamp( 1 )
 {
+  TransformCache emptyCache = { shared_ptr<BasicLocator>(), 0, 0, 0, 0,
+                                false };
+  worldLocatorCache = subspaceLocatorCache = emptyCache;
+  
+
   if( locator ) {
     assert( !locator->getHostObject() );
     locator->setHostObject( this );
@@ -113,6 +127,12 @@ Object::Object( const Object::Params & params ) :
 }
 
 
+shared_ptr<Object> Object::create( const Object::Params & params )
+{
+  return allocate_shared<Object>( PoolAllocator<Object>(), params );
+}
+
+
 /**
  * - Joints will be destroyed automatically in their destructors.
  * - ODELocators will be destroyed automatically in their destructors
@@ -154,6 +174,21 @@ Object::getSubspaceLocator( const Subspace * subspace ) const
 {
   if( !locator || !hostSpace ) return shared_ptr<Locator>();
   
+  // check the cache
+  TransformCache & cache = subspaceLocatorCache;
+  unsigned long hostStamp = hostSpace->getWorldTransformStamp();
+  unsigned long subspaceStamp = subspace->getWorldTransformStamp();
+  if( cache.subspace == subspace &&
+      cache.locationStamp == locationStamp &&
+      cache.hostStamp == hostStamp &&
+      cache.subspaceStamp == subspaceStamp ) {
+    return cache.valid ? cache.locator : shared_ptr<Locator>();
+  }
+  if( !cache.locator ) {
+    cache.locator =
+      allocate_shared<BasicLocator>( PoolAllocator<BasicLocator>() );
+  }
+  
   // compute directly from world locators if they are available, except if the
   // target subspace is directly above (in which case nothing needs to be done:
   // the recursion will end immediately)
@@ -162,18 +197,22 @@ Object::getSubspaceLocator( const Subspace * subspace ) const
       subspace->getLocator() &&
       subspace->getLocator()->getDirectWorldLocator() ) {
     // compute from world locators
-    shared_ptr<Locator> result
-      ( new BasicLocator( *locator->getDirectWorldLocator() ) );
+    *cache.locator = *locator->getDirectWorldLocator();
     subspace->getLocator()->
-      getDirectWorldLocator()->transform( *result, Reverse );
-    return result;
+      getDirectWorldLocator()->transform( *cache.locator, Reverse );
+    cache.valid = true;
   } else {
     // recurse
-    shared_ptr<Locator> result( new BasicLocator( *locator ) );
-    return
-      hostSpace->transformToSubspaceCoordinates( subspace, *result ) ?
-      result : shared_ptr<Locator>();
+    *cache.locator = *locator;
+    cache.valid =
+      hostSpace->transformToSubspaceCoordinates( subspace, *cache.locator );
   }
+  
+  cache.subspace = subspace;
+  cache.locationStamp = locationStamp;
+  cache.hostStamp = hostStamp;
+  cache.subspaceStamp = subspaceStamp;
+  return cache.valid ? cache.locator : shared_ptr<Locator>();
 }
 
 
@@ -182,14 +221,27 @@ shared_ptr<const Locator> Object::getWorldLocator() const
   if( !locator || !hostSpace ) return shared_ptr<Locator>();
   
   shared_ptr<const Locator> directLocator( locator->getDirectWorldLocator() );
-  if( directLocator ) {
-    return directLocator;
-  } else {
-    shared_ptr<Locator> result( new BasicLocator( *locator ) );
-    return
-      hostSpace->transformToWorldCoordinates( *result ) ?
-      result : shared_ptr<Locator>();
+  if( directLocator ) return directLocator;
+  
+  // check the cache
+  TransformCache & cache = worldLocatorCache;
+  unsigned long hostStamp = hostSpace->getWorldTransformStamp();
+  if( cache.locationStamp == locationStamp &&
+      cache.hostStamp == hostStamp ) {
+    return cache.valid ? cache.locator : shared_ptr<Locator>();
+  }
+  if( !cache.locator ) {
+    cache.locator =
+      allocate_shared<BasicLocator>( PoolAllocator<BasicLocator>() );
   }
+  
+  // the host space uses its own cached world locator
+  *cache.locator = *locator;
+  cache.valid = hostSpace->transformToWorldCoordinates( *cache.locator );
+  
+  cache.locationStamp = locationStamp;
+  cache.hostStamp = hostStamp;
+  return cache.valid ? cache.locator : shared_ptr<Locator>();
 }
 
 
@@ -200,7 +252,11 @@ void Object::setName( const string & newName )
   assert_user( newName.find_first_of( ".:/" ) == string::npos,
                "Object names may not contain dots, colons nor slashes!" );
   
+  // reindex self and contents under the new path
+  World * world = pathWorld;
+  if( world ) world->unindexObject( this );
   name = newName;
+  if( world ) world->indexObject( this );
 }
 
 
@@ -208,6 +264,9 @@ string Object::getFullName() const
 {
   string result;
   
+  // indexed by a world?
+  if( pathWorld ) return pathWorld->getPath( pathSymbol );
+  
   // within a subspace?
   if( getHostSpace() ) {
     // return the host subspace's full name and append our own name to it
@@ -240,6 +299,7 @@ void Object::setLocator( shared_ptr<Locator> newLocator )
   
   // set the new locator
   locator = newLocator;
+  locationModified();
 }
 
 
@@ -275,6 +335,49 @@ void Object::setGeometry( boost::shared_ptr<Geometry> newGeometry )
 }
 
 
+void Object::geometryModified()
+{
+  ObjectEvent event = { OE_GEOMETRY_MODIFIED, { this, {0} } };
+  event.data.changingTarget.geometry = geometry.get();
+  events.sendEvent( &event );
+}
+
+
+
+
+void Object::awaken()
+{
+  awake = true;
+  if( hostSpace ) hostSpace->wakeObject( this );
+}
+
+
+bool Object::isResting() const
+{
+  return locator && !locator->isMoving() && !locator->isRotating();
+}
+
+
+/** Defined here, as Locator.hpp cannot see the Object class. */
+void Locator::wakeHostObject() const
+{
+  if( hostObject ) hostObject->wake();
+}
+
+
+void Locator::sleepHostObject() const
+{
+  if( hostObject && hostObject->hasAutoSleep() ) hostObject->sleep();
+}
+
+
+/** Defined here, as Locator.hpp cannot see the Object class. */
+void Locator::locationModified() const
+{
+  if( hostObject ) hostObject->locationModified();
+}
+
+
 
 
 shared_ptr<const Connector> Object::getConnector( unsigned int id ) const
@@ -64,6 +64,16 @@
  *   - OE_HOSTSPACE_CHANGING: The object is being (dis)connected to a host
  *     subspace. Either the object's current hostSpace or the new hostSpace is
  *     always null.
+ *   - OE_LOCATOR_MODIFIED: The ODELocator of the object has been activated or
+ *     deactivated, so its ODE body has been created or destroyed. Sent by
+ *     ODEWorld::Activate(), after the change.
+ *   - OE_GEOMETRY_MODIFIED: The current geometry has been modified in
+ *     place. Sent by geometryModified().
+ *   - OE_CONNECTION_MODIFIED: A Connector of the object has been connected or
+ *     disconnected, or the collision inhibition of a connected Connector has
+ *     been changed. Sent to the host objects of both connectors, after the
+ *     change. The changingTarget.connectedObject field points to the host
+ *     object of the other connector.
  *
  * The ObjectEventData struct passed along with the OE_*_CHANGING events will
  * contain a pointer to the source Object (which still has the old target
@@ -137,6 +147,8 @@
 
 
 #include "../Utility/Event.hpp"
+#include "../Utility/HandleVector.hpp"
+#include "../Utility/SymbolTable.hpp"
 #include "../types.hpp"
 
 #include <list>
@@ -161,6 +173,7 @@ namespace lifespace {
   /* forwards */
   class Visual;
   class Locator;
+  class BasicLocator;
   class Geometry;
   class Subspace;
   class World;
@@ -187,9 +200,44 @@ namespace lifespace {
     boost::shared_ptr<Visual> visual;
     boost::shared_ptr<Geometry> geometry;
     Subspace * hostSpace;
+    
+    /** The object's handle in the object storage of its hostspace. Set and
+        used by Subspace::addObject() and Subspace::removeObject(). */
+    HandleVector< boost::shared_ptr<Object> >::Handle hostSpaceHandle;
+    
     int lockedToHostSpace;
+    bool threadSafePrepare;
+    bool awake;
+    bool autoSleep;
     std::string name;
     
+    /** Path index entry, maintained by the World that this object is in (see
+        World::findObject()). pathWorld is null when the object is not
+        indexed. Objects with the same full path are linked together with
+        pathPrev and pathNext. */
+    World * pathWorld;
+    SymbolTable::Symbol pathSymbol;
+    Object * pathPrev;
+    Object * pathNext;
+    
+    /** Modification stamp of the object's own location, see
+        getLocationStamp(). */
+    unsigned long locationStamp;
+    
+    /** Cached transforms for getWorldLocator() and getSubspaceLocator(). The
+        locators are allocated once and updated in place whenever the
+        location stamp of the object, or the world transform stamp of the host
+        Subspace or the target subspace has changed (see
+        Subspace::getWorldTransformStamp()). */
+    mutable struct TransformCache {
+      boost::shared_ptr<BasicLocator> locator;
+      const Subspace * subspace;
+      unsigned long locationStamp;
+      unsigned long hostStamp;
+      unsigned long subspaceStamp;
+      bool valid;
+    } worldLocatorCache, subspaceLocatorCache;
+    
     
     /**
      * Sets the object's current hostspace pointer, or marks the object as
@@ -205,10 +253,25 @@ namespace lifespace {
      */
     void setHostSpace( Subspace * newHostSpace );
     
+    /** Marks the object awake and notifies the hostspace. Called by wake()
+        for sleeping objects only. */
+    void awaken();
+    
+    /** Bumps the location stamp. Called when the locator is modified or
+        replaced, and when the object is (dis)connected to a host subspace. */
+    void locationModified()
+    { locationStamp++; }
+    
     /** Subspace::addObject() and Subspace::removeObject() need access to the
         private setHostSpace() method. */
     friend class Subspace;
     
+    /** The World maintains the path index entries. */
+    friend class World;
+    
+    /** Locators report their modifications with locationModified(). */
+    friend class Locator;
+    
     
   protected:
     
@@ -243,6 +306,7 @@ namespace lifespace {
       OE_LOCATOR_MODIFIED,
       OE_VISUAL_MODIFIED,
       OE_GEOMETRY_MODIFIED,
+      OE_CONNECTION_MODIFIED,
     };
     
     /** ObjectEvent data. */
@@ -253,6 +317,7 @@ namespace lifespace {
         Visual * visual;
         Geometry * geometry;
         Subspace * hostSpace;
+        Object * connectedObject;
       } changingTarget;
     };
     
@@ -295,6 +360,15 @@ namespace lifespace {
      */
     Object( const Object::Params & params = Object::Params() );
     
+    /**
+     * Creates a new Object like the constructor, but allocates the Object and
+     * its reference count together in a single pooled block.
+     *
+     * @sa PoolAllocator
+     */
+    static boost::shared_ptr<Object>
+    create( const Object::Params & params = Object::Params() );
+    
     /**
      * Releases all bound composite objects and destructs the object.
      *
@@ -331,6 +405,11 @@ namespace lifespace {
         composed from the object's name, preceded by the names of all host
         Subspaces and the root World separated by the '/' character. Example:
         "theworld/space2/object5"
+        
+        Within a World, the full name is read from the World's path index
+        instead of being rebuilt.
+        
+        @sa World::findObject()
     */
     std::string getFullName() const;
     
@@ -386,9 +465,13 @@ namespace lifespace {
      * orientation within the given Subspace (can be null if not under the
      * given Subspace).
      *
-     * Note that this operation might be quite expensive if the locator was not
-     * precomputed and cached somewhere! The returned locator is most probably,
-     * but not necessarily a temporary and is therefore defined as const.
+     * The result for the last queried subspace is cached until the object
+     * or one of its host subspaces moves (see getLocationStamp()), so
+     * repeated queries do not allocate or recompute anything.
+     *
+     * @warning
+     * The returned locator is updated in place by later calls. Copy it if
+     * you need to keep it over a modification of the world.
      *
      * @sa getLocator(), getWorldLocator()
      */
@@ -399,9 +482,15 @@ namespace lifespace {
      * Returns a locator representing the Object's absolute location and
      * orientation within the host World (can be null if not within a World).
      *
-     * Note that this operation might be quite expensive if the locator was not
-     * precomputed and cached somewhere! The returned locator is most probably,
-     * but not necessarily a temporary and is therefore defined as const.
+     * The result is cached until the object or one of its host subspaces
+     * moves (see getLocationStamp()). The computation uses the cached
+     * world locator of the host Subspace, so a deep hierarchy is traversed
+     * only once per modification, and repeated queries do not allocate or
+     * recompute anything.
+     *
+     * @warning
+     * The returned locator is updated in place by later calls. Copy it if
+     * you need to keep it over a modification of the world.
      *
      * @todo
      * Combine this and getSubspaceLocator() to getRelativeLocator(), with null
@@ -411,6 +500,16 @@ namespace lifespace {
      */
     boost::shared_ptr<const Locator> getWorldLocator() const;
     
+    /**
+     * Returns the location stamp of the object. The stamp changes whenever
+     * the location or orientation of the object's locator is modified, the
+     * locator is replaced, or the object is (dis)connected to a host
+     * subspace. It does not reflect the movements of the host subspaces (see
+     * Subspace::getWorldTransformStamp()).
+     */
+    unsigned long getLocationStamp() const
+    { return locationStamp; }
+    
     /**
      * Find and return the connector with the given id. It is an error to try
      * to get a connector which is not present in the Object (is asserted in
@@ -440,6 +539,78 @@ namespace lifespace {
     
     void setGeometry( boost::shared_ptr<Geometry> newGeometry );
     
+    /** Notifies the listeners that the current geometry has been modified in
+        place (its shape, material or collision layers have been changed), by
+        sending an OE_GEOMETRY_MODIFIED event. */
+    void geometryModified();
+    
+    
+    /**
+     * Declares whether prepare() of this object may be run concurrently with
+     * the prepare() of other objects (see ParallelIntegrator). Defaults to
+     * false.
+     *
+     * A thread-safe prepare() may only modify the state of the object itself
+     * (the next state of its locator, forces on its own ODE body etc.). It
+     * must not modify locations, send events, or add or remove objects. A
+     * thread-safe Subspace is prepared concurrently with its siblings as a
+     * whole, so the same applies to all of its contents.
+     */
+    void setThreadSafePrepare( bool threadSafe )
+    { threadSafePrepare = threadSafe; }
+    
+    bool hasThreadSafePrepare() const
+    { return threadSafePrepare; }
+    
+    
+    /**
+     * Wakes the object if it is sleeping, so that it is processed again by
+     * the host Subspace's integrator. Objects are woken automatically when
+     * they are added to a Subspace, when a force, torque or velocity is
+     * applied to their locator, when their controls are used (see
+     * Actor::useControl()) and when they touch an awake object. Waking a
+     * contained object wakes also its host Subspace.
+     *
+     * Cheap to call for an already awake object.
+     *
+     * @sa sleep(), ActiveSetIntegrator
+     */
+    void wake()
+    { if( !awake ) awaken(); }
+    
+    /**
+     * Puts the object to sleep. A sleeping object is skipped by the prepare
+     * and step passes of an ActiveSetIntegrator until it is woken again.
+     * Other integrators process all objects regardless of this flag.
+     */
+    void sleep()
+    { awake = false; }
+    
+    bool isAwake() const
+    { return awake; }
+    
+    /**
+     * Allows the host Subspace's integrator to put the object to sleep
+     * automatically whenever it is at rest after a step (see isResting()).
+     * Defaults to false.
+     *
+     * Enable this only for objects that do nothing on their own while at
+     * rest: a sleeping object's prepare() and step() are not called, so it
+     * will not react to anything but the wake triggers listed in wake().
+     */
+    void setAutoSleep( bool enable )
+    { autoSleep = enable; }
+    
+    bool hasAutoSleep() const
+    { return autoSleep; }
+    
+    /**
+     * Returns true if the object is at rest, i.e.\ its locator is definitely
+     * neither moving nor rotating. Objects without a locator are never at
+     * rest.
+     */
+    virtual bool isResting() const;
+    
     
     /* method dispatch to Locator */
     
@@ -468,9 +639,10 @@ namespace lifespace {
      * methods, then try to keep the order-dependent objects on different
      * levels in the same branch of the world hierarchy to keep the actual
      * execution order predictable: the prepare method calls propagate in the
-     * world hierarchy from top to down, and in insertion order within
-     * container objects. This means that the order within containers is not
-     * very well defined.
+     * world hierarchy from top to down, and in storage order within
+     * container objects (which is the insertion order only for ordered
+     * Subspaces, see Subspace::setOrderedObjects()). This means that the
+     * order within containers is not very well defined.
      *
      * @note
      * Remember: overriding versions of prepare() should call the underlying
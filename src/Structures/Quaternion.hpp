@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file Quaternion.hpp
+ *
+ * Unit quaternions for representing 3d orientations.
+ */
+
+/**
+ * @class lifespace::Quaternion
+ * @ingroup Structures
+ *
+ * @brief
+ * Unit quaternions for representing 3d orientations.
+ *
+ * The rotation conventions are the same as in BasisMatrix: composing
+ * <tt>Quaternion( axis, angle ) * q</tt> corresponds to
+ * <tt>basis.rotate3dAbs( axis, angle )</tt>, and <tt>q * Quaternion( axis,
+ * angle )</tt> corresponds to <tt>basis.rotate3dRel( axis, angle )</tt>.
+ *
+ * Composing two unit quaternions is cheaper than rotating a 3x3 basis, and the
+ * drift from repeated compositions can be removed with renormalize(), which
+ * needs no square root. Use BasisMatrix( const Quaternion & ) to get the
+ * corresponding basis.
+ */
+#ifndef LS_S_QUATERNION_HPP
+#define LS_S_QUATERNION_HPP
+
+
+#include "../types.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#include <cmath>
+
+
+
+
+namespace lifespace {
+  
+  
+  
+  
+  struct Quaternion
+  {
+    real w, x, y, z;
+    
+    
+    /* constructors */
+    
+    /** Init to identity rotation. */
+    Quaternion() :
+      w( 1.0 ), x( 0.0 ), y( 0.0 ), z( 0.0 )
+    {}
+    
+    Quaternion( real w_, real x_, real y_, real z_ ) :
+      w( w_ ), x( x_ ), y( y_ ), z( z_ )
+    {}
+    
+    /**
+     * Init to a rotation around the given axis.
+     *
+     * @param axis    A normalized rotation axis.
+     * @param angle   Rotation angle in radians.
+     */
+    template<typename E>
+    Quaternion( const ublas::vector_expression<E> & axis, real angle )
+    {
+      real s = std::sin( 0.5 * angle );
+      w = std::cos( 0.5 * angle );
+      x = axis()(0) * s; y = axis()(1) * s; z = axis()(2) * s;
+    }
+    
+    /**
+     * Init from an orthonormal 3x3 rotation matrix (whose columns are the
+     * basis vectors).
+     */
+    explicit Quaternion( const Matrix & m )
+    {
+      real trace = m(0,0) + m(1,1) + m(2,2);
+      
+      if( trace > 0.0 ) {
+        real s = 2.0 * std::sqrt( trace + 1.0 );
+        w = 0.25 * s;
+        x = (m(2,1) - m(1,2)) / s;
+        y = (m(0,2) - m(2,0)) / s;
+        z = (m(1,0) - m(0,1)) / s;
+      } else if( m(0,0) > m(1,1) && m(0,0) > m(2,2) ) {
+        real s = 2.0 * std::sqrt( 1.0 + m(0,0) - m(1,1) - m(2,2) );
+        w = (m(2,1) - m(1,2)) / s;
+        x = 0.25 * s;
+        y = (m(0,1) + m(1,0)) / s;
+        z = (m(0,2) + m(2,0)) / s;
+      } else if( m(1,1) > m(2,2) ) {
+        real s = 2.0 * std::sqrt( 1.0 + m(1,1) - m(0,0) - m(2,2) );
+        w = (m(0,2) - m(2,0)) / s;
+        x = (m(0,1) + m(1,0)) / s;
+        y = 0.25 * s;
+        z = (m(1,2) + m(2,1)) / s;
+      } else {
+        real s = 2.0 * std::sqrt( 1.0 + m(2,2) - m(0,0) - m(1,1) );
+        w = (m(1,0) - m(0,1)) / s;
+        x = (m(0,2) + m(2,0)) / s;
+        y = (m(1,2) + m(2,1)) / s;
+        z = 0.25 * s;
+      }
+      
+      normalize();
+    }
+    
+    
+    /* operations */
+    
+    /** Composes the rotations: the rhs rotation is applied first. */
+    Quaternion operator*( const Quaternion & rhs ) const
+    {
+      return Quaternion( w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z,
+                         w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,
+                         w * rhs.y - x * rhs.z + y * rhs.w + z * rhs.x,
+                         w * rhs.z + x * rhs.y - y * rhs.x + z * rhs.w );
+    }
+    
+    Quaternion & operator*=( const Quaternion & rhs )
+    { return *this = *this * rhs; }
+    
+    /** Returns the inverse rotation. */
+    Quaternion conjugated() const
+    { return Quaternion( w, -x, -y, -z ); }
+    
+    real lengthSquared() const
+    { return w * w + x * x + y * y + z * z; }
+    
+    /** Scales the quaternion to unit length. */
+    void normalize()
+    {
+      real len = std::sqrt( lengthSquared() );
+      w /= len; x /= len; y /= len; z /= len;
+    }
+    
+    /**
+     * Pulls an almost-unit quaternion back to unit length with a first-order
+     * approximation of 1/sqrt (no square root or division needed). This is
+     * enough to cancel the rounding drift of repeated compositions when
+     * called once per composition.
+     */
+    void renormalize()
+    {
+      real scale = 0.5 * (3.0 - lengthSquared());
+      w *= scale; x *= scale; y *= scale; z *= scale;
+    }
+    
+    /**
+     * Interpolates from one rotation to another along the shorter arc by
+     * normalized linear interpolation (nlerp). Differs from slerp only in
+     * the speed along the arc, which is negligible for the small rotations
+     * between consecutive simulation steps.
+     */
+    static Quaternion Nlerp( const Quaternion & from, const Quaternion & to,
+                             real t )
+    {
+      real dot = from.w * to.w + from.x * to.x + from.y * to.y + from.z * to.z;
+      real s = dot < 0.0 ? -t : t;
+      Quaternion result( (1.0 - t) * from.w + s * to.w,
+                         (1.0 - t) * from.x + s * to.x,
+                         (1.0 - t) * from.y + s * to.y,
+                         (1.0 - t) * from.z + s * to.z );
+      result.normalize();
+      return result;
+    }
+    
+    /** Writes the corresponding 3x3 rotation matrix into the given matrix
+        (any type indexable with (row,col)). */
+    template<class M>
+    void toMatrix( M & m ) const
+    {
+      real xx = x * x, yy = y * y, zz = z * z;
+      real xy = x * y, xz = x * z, yz = y * z;
+      real wx = w * x, wy = w * y, wz = w * z;
+      
+      m(0,0) = 1.0 - 2.0 * (yy + zz);
+      m(0,1) = 2.0 * (xy - wz);
+      m(0,2) = 2.0 * (xz + wy);
+      m(1,0) = 2.0 * (xy + wz);
+      m(1,1) = 1.0 - 2.0 * (xx + zz);
+      m(1,2) = 2.0 * (yz - wx);
+      m(2,0) = 2.0 * (xz - wy);
+      m(2,1) = 2.0 * (yz + wx);
+      m(2,2) = 1.0 - 2.0 * (xx + yy);
+    }
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_S_QUATERNION_HPP */
@@ -66,6 +66,7 @@
 #include "../types.hpp"
 #include "World.hpp"
 #include "ODEWorld.hpp"
+#include "ODEInstance.hpp"
 #include "Object.hpp"
 #include "Subspace.hpp"
 #include "Connector.hpp"
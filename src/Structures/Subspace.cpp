@@ -26,6 +26,7 @@
  * Implementations for the Subspace class.
  */
 #include "Subspace.hpp"
+#include "World.hpp"
 #include "Locator.hpp"
 #include "ODEWorld.hpp"
 #include "../Graphics/Environment.hpp"
@@ -54,7 +55,8 @@ Subspace::Params::Params() :
   objectParams(),
   environment( shared_ptr<Environment>( new Environment ) ),
   integrator( shared_ptr<Integrator>( new BasicIntegrator ) ),
-  selfCollide( true )
+  selfCollide( true ),
+  orderedObjects( false )
 {}
 
 
@@ -62,7 +64,8 @@ Subspace::Params::Params( const Object::Params & objectParams_ ) :
   objectParams( objectParams_ ),
   environment( shared_ptr<Environment>( new Environment ) ),
   integrator( shared_ptr<Integrator>( new BasicIntegrator ) ),
-  selfCollide( true )
+  selfCollide( true ),
+  orderedObjects( false )
 {}
 
 
@@ -72,7 +75,8 @@ Subspace::Params::Params( const Object::Params & objectParams_,
   objectParams( objectParams_ ),
   environment( environment_ ),
   integrator( integrator_ ),
-  selfCollide( true )
+  selfCollide( true ),
+  orderedObjects( false )
 {}
 
 
@@ -81,7 +85,8 @@ Subspace::Params::Params( const Object::Params & objectParams_,
   objectParams( objectParams_ ),
   environment( shared_ptr<Environment>( new Environment ) ),
   integrator( shared_ptr<Integrator>( new BasicIntegrator ) ),
-  selfCollide( selfCollide_ )
+  selfCollide( selfCollide_ ),
+  orderedObjects( false )
 {}
 
 
@@ -92,19 +97,20 @@ Subspace::Params::Params( const Object::Params & objectParams_,
   objectParams( objectParams_ ),
   environment( environment_ ),
   integrator( integrator_ ),
-  selfCollide( selfCollide_ )
+  selfCollide( selfCollide_ ),
+  orderedObjects( false )
 {}
 
 
 Subspace::Subspace( const Subspace::Params & params ) :
   Object( params.objectParams ),
+  objects( params.orderedObjects ),
   environment( params.environment ),
   integrator( params.integrator ),
   selfCollide( params.selfCollide )
 {
-  assert_user( selfCollide == true,
-               "Disabling self-collide is not yet implemented, so currently "
-               "the selfCollide flag must always be set true!" );
+  WorldTransformStamp initialStamp = { 0, 0, 0 };
+  worldTransformStamp = initialStamp;
 }
 
 
@@ -120,15 +126,65 @@ Subspace::~Subspace()
 
 
 
+void Subspace::addObject( shared_ptr<Object> object )
+{
+  object->hostSpaceHandle = objects.insert( object );
+  object->setHostSpace( this );
+  
+  // (re)activate the object in the integrator
+  object->awake = false;
+  object->wake();
+  
+  // index the object (and its contents) if we are within a world
+  if( pathWorld ) pathWorld->indexObject( object.get() );
+}
+
+
+void Subspace::removeObject( shared_ptr<Object> object )
+{
+  // assert that the object really is contained in this subspace
+  assert( object->getHostSpace() == this &&
+          objects.contains( object->hostSpaceHandle ) &&
+          objects.get( object->hostSpaceHandle ) == object );
+  
+  if( object->pathWorld ) object->pathWorld->unindexObject( object.get() );
+  
+  objects.erase( object->hostSpaceHandle );
+  object->hostSpaceHandle = objects_t::Handle();
+  object->setHostSpace( 0 );
+  object->awake = true;
+}
+
+
+void Subspace::wakeObject( Object * object )
+{
+  assert( object->getHostSpace() == this );
+  
+  if( integrator ) integrator->wakeObject( object->hostSpaceHandle );
+  wake();
+}
+
+
+bool Subspace::isResting() const
+{
+  return Object::isResting() &&
+    !(integrator && integrator->hasAwakeObjects( objects ));
+}
+
+
+
+
 bool Subspace::transformToWorldCoordinates( Locator & target ) const
 {
   if( !hostSpace ) return false;
   
-  if( locator && locator->getDirectWorldLocator() ) {
-    locator->getDirectWorldLocator()->transform( target );
+  if( locator ) {
+    // use the (direct or cached) world locator
+    shared_ptr<const Locator> worldLocator = getWorldLocator();
+    if( !worldLocator ) return false;
+    worldLocator->transform( target );
     return true;
   } else {
-    if( locator ) locator->transform( target );
     return hostSpace->transformToWorldCoordinates( target );
   }
 }
@@ -138,11 +194,13 @@ bool Subspace::transformToWorldCoordinates( Vector & target ) const
 {
   if( !hostSpace ) return false;
   
-  if( locator && locator->getDirectWorldLocator() ) {
-    locator->getDirectWorldLocator()->transform( target );
+  if( locator ) {
+    // use the (direct or cached) world locator
+    shared_ptr<const Locator> worldLocator = getWorldLocator();
+    if( !worldLocator ) return false;
+    worldLocator->transform( target );
     return true;
   } else {
-    if( locator ) locator->transform( target );
     return hostSpace->transformToWorldCoordinates( target );
   }
 }
@@ -152,16 +210,33 @@ bool Subspace::transformToWorldCoordinates( Matrix & target ) const
 {
   if( !hostSpace ) return false;
   
-  if( locator && locator->getDirectWorldLocator() ) {
-    locator->getDirectWorldLocator()->transform( target );
+  if( locator ) {
+    // use the (direct or cached) world locator
+    shared_ptr<const Locator> worldLocator = getWorldLocator();
+    if( !worldLocator ) return false;
+    worldLocator->transform( target );
     return true;
   } else {
-    if( locator ) locator->transform( target );
     return hostSpace->transformToWorldCoordinates( target );
   }
 }
 
 
+unsigned long Subspace::getWorldTransformStamp() const
+{
+  unsigned long hostStamp =
+    hostSpace ? hostSpace->getWorldTransformStamp() : 0;
+  
+  WorldTransformStamp & s = worldTransformStamp;
+  if( s.locationStamp != getLocationStamp() || s.hostStamp != hostStamp ) {
+    s.locationStamp = getLocationStamp();
+    s.hostStamp = hostStamp;
+    s.stamp++;
+  }
+  return s.stamp;
+}
+
+
 bool Subspace::transformToSubspaceCoordinates( const Subspace * subspace,
                                                Locator & target ) const
 {
@@ -50,9 +50,9 @@
 #include "Object.hpp"
 #include "Vector.hpp"
 #include "Matrix.hpp"
+#include "../Utility/HandleVector.hpp"
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
-#include <list>
 #include <algorithm>
 
 
@@ -71,7 +71,10 @@ namespace lifespace {
     public virtual Object
   {
   public:
-    typedef std::list< boost::shared_ptr<Object> > objects_t;
+    /** Dense object storage. Objects are iterated like a std::vector, and
+        each contained object keeps a handle to its own slot so that removal
+        does not need a search. */
+    typedef HandleVector< boost::shared_ptr<Object> > objects_t;
     
     
   private:
@@ -82,6 +85,21 @@ namespace lifespace {
     /** Should the Objects in this Subspace collide with each other? */
     bool selfCollide;
     
+    /** The world transform stamp (see getWorldTransformStamp()) and the
+        location stamps it was last checked against. */
+    mutable struct WorldTransformStamp {
+      unsigned long stamp;
+      unsigned long locationStamp;
+      unsigned long hostStamp;
+    } worldTransformStamp;
+    
+    /** Passes the wake-up of a contained Object to the integrator and wakes
+        this Subspace too. Called by Object::wake(). */
+    void wakeObject( Object * object );
+    
+    /** Object::wake() needs access to the private wakeObject() method. */
+    friend class Object;
+    
     
   public:
     
@@ -108,14 +126,21 @@ namespace lifespace {
       boost::shared_ptr<Integrator> integrator;
       
       /**
-       * Should the Objects in this Subspace collide with each other?
-       *
-       * @note
-       * Handling is not yet implemented, and currently this must always be set
-       * true (is checked with an assert in debug mode)!
+       * Should the Objects in this Subspace collide with each other? The
+       * contents of the Subspace still collide with the outside Objects.
+       * Implemented by the ODECollisionRenderer.
        */
       bool selfCollide;
       
+      /**
+       * Should the processing order of the Objects be kept in the order they
+       * were added? If false, removing an Object is O(1) but moves the last
+       * Object to its place. If true, removing is O(n). Defaults to false.
+       *
+       * @sa setOrderedObjects()
+       */
+      bool orderedObjects;
+      
       Params();
       Params( const Object::Params & objectParams );
       Params( const Object::Params & objectParams,
@@ -174,6 +199,17 @@ namespace lifespace {
     bool transformToSubspaceCoordinates( const Subspace * subspace,
                                          Locator & target ) const;
     
+    /**
+     * Returns a stamp that changes whenever the transform applied by
+     * transformToWorldCoordinates() may have changed, i.e.\ when the location
+     * stamp (see Object::getLocationStamp()) of this subspace or any of its
+     * host subspaces has changed. Cached world transforms of the contained
+     * objects are valid as long as the stamp stays the same.
+     *
+     * Walks the host chain, but does not compute anything.
+     */
+    virtual unsigned long getWorldTransformStamp() const;
+    
     
     /* mutators */
     
@@ -191,7 +227,9 @@ namespace lifespace {
      * method.
      *
      * @note
-     * Objects will always be processed in the order they were added.
+     * Objects will be processed in the order they were added only if ordered
+     * processing has been enabled with setOrderedObjects(). By default,
+     * removing an Object moves the last Object to its place.
      *
      * @remarks
      * An object is not allowed to exist multiple times even in a \em single
@@ -201,11 +239,7 @@ namespace lifespace {
      *
      * @sa removeObject()
      */
-    virtual void addObject( boost::shared_ptr<Object> object )
-    {
-      objects.push_back( object );
-      object->setHostSpace( this );
-    }
+    virtual void addObject( boost::shared_ptr<Object> object );
     
     /**
      * Removes the given Object from the Subspace. It is an error to call this
@@ -213,16 +247,21 @@ namespace lifespace {
      *
      * @sa addObject()
      */
-    virtual void removeObject( boost::shared_ptr<Object> object )
-    {
-      // assert that the object really is contained in this subspace
-      assert( object->getHostSpace() == this &&
-              std::find( objects.begin(), objects.end(), object )
-              != objects.end() );
-      
-      objects.remove( object );
-      object->setHostSpace( 0 );
-    }
+    virtual void removeObject( boost::shared_ptr<Object> object );
+    
+    /**
+     * Selects whether the contained Objects are kept in the order they were
+     * added. When disabled, removeObject() runs in constant time by moving the
+     * last Object into the hole, which changes the processing order. Objects
+     * are not reordered when the setting is changed.
+     *
+     * @sa Params::orderedObjects
+     */
+    void setOrderedObjects( bool ordered )
+    { objects.setOrdered( ordered ); }
+    
+    bool hasOrderedObjects() const
+    { return objects.isOrdered(); }
     
     
     boost::shared_ptr<const Environment> getEnvironment() const
@@ -237,6 +276,17 @@ namespace lifespace {
     objects_t & getObjects()
     { return objects; }
     
+    /** Should the Objects in this Subspace collide with each other? */
+    bool doesSelfCollide() const
+    { return selfCollide; }
+    
+    
+    /**
+     * A Subspace is at rest when its own locator is at rest and its
+     * integrator has no awake objects left.
+     */
+    virtual bool isResting() const;
+    
     
     void localPrepare( real dt );
     void localStep();
@@ -33,8 +33,15 @@
  * @brief
  * Lifespace vectors.
  *
+ * Vector is a fixed-size 3-vector (Vector3) with in-place storage, so that
+ * temporaries in the locator and geometry code never touch the heap. It is
+ * still a regular uBLAS vector container, so all uBLAS expressions and
+ * functions work with it as before. Code that really needs a
+ * run-time sized vector should use DynamicVector, which converts to and from
+ * Vector implicitly.
+ *
  * @todo
- * Dynamic dimensionality, or use a bounded array storage.
+ * Dynamic dimensionality.
  */
 #ifndef LS_S_VECTOR_HPP
 #define LS_S_VECTOR_HPP
@@ -56,9 +63,27 @@ namespace lifespace {
   
   
   
-  typedef ublas::vector<real> Vector;
+  /** Fixed-size 3d vector with in-place (stack) storage. */
+  typedef ublas::c_vector<real,3> Vector3;
+  
+  typedef Vector3 Vector;
   
-  typedef ublas::zero_vector<real> ZeroVector;
+  /** Heap-allocated, run-time sized vector for interfacing with generic
+      uBLAS code. Converts implicitly to and from Vector. */
+  typedef ublas::vector<real> DynamicVector;
+  
+  /**
+   * A zero-initialized Vector. This is a dense Vector instead of a
+   * uBLAS zero_vector, because assigning a (sparse) zero_vector to a dense
+   * vector allocates a temporary.
+   */
+  struct ZeroVector :
+    public Vector
+  {
+    explicit ZeroVector( unsigned int dim = 3 ) :
+      Vector( dim )
+    { clear(); }
+  };
   
   
   inline Vector makeVector3d( real a, real b, real c )
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file World.cpp
+ *
+ * Implementations for the World class.
+ */
+#include "World.hpp"
+#include "Object.hpp"
+#include "Subspace.hpp"
+#include "Locator.hpp"
+#include "BasisMatrix.hpp"
+#include "../Utility/SymbolTable.hpp"
+using namespace lifespace;
+
+#include <string>
+using std::string;
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include <sys/time.h>
+#include <time.h>
+
+
+
+
+void World::indexObject( Object * object )
+{
+  // nested worlds keep their own index
+  if( object != this && dynamic_cast<World *>( object ) ) return;
+  
+  assert( !object->pathWorld );
+  
+  // build the full path
+  if( object == this ) {
+    pathBuffer = object->name;
+  } else {
+    assert( object->hostSpace && object->hostSpace->pathWorld == this );
+    pathBuffer = paths.getString( object->hostSpace->pathSymbol );
+    pathBuffer += '/';
+    pathBuffer += object->name;
+  }
+  
+  // intern it and link the object to the head of the path's list
+  SymbolTable::Symbol symbol = paths.intern( pathBuffer );
+  if( symbol >= pathObjects.size() ) pathObjects.resize( symbol + 1, 0 );
+  
+  object->pathWorld = this;
+  object->pathSymbol = symbol;
+  object->pathPrev = 0;
+  object->pathNext = pathObjects[symbol];
+  if( object->pathNext ) object->pathNext->pathPrev = object;
+  pathObjects[symbol] = object;
+  
+  // recurse into subspaces
+  Subspace * subspace = dynamic_cast<Subspace *>( object );
+  if( subspace ) {
+    const Subspace::objects_t & objects = subspace->getObjects();
+    for( Subspace::objects_t::size_type i = 0 ; i < objects.size() ; i++ ) {
+      indexObject( objects[i].get() );
+    }
+  }
+}
+
+
+void World::unindexObject( Object * object )
+{
+  if( object->pathWorld != this ) return;
+  
+  // unlink, and release the path if this was the last object having it
+  if( object->pathPrev ) {
+    object->pathPrev->pathNext = object->pathNext;
+  } else {
+    pathObjects[object->pathSymbol] = object->pathNext;
+    if( !object->pathNext ) paths.release( object->pathSymbol );
+  }
+  if( object->pathNext ) object->pathNext->pathPrev = object->pathPrev;
+  
+  object->pathWorld = 0;
+  object->pathSymbol = SymbolTable::NoSymbol;
+  object->pathPrev = object->pathNext = 0;
+  
+  // recurse into subspaces
+  Subspace * subspace = dynamic_cast<Subspace *>( object );
+  if( subspace ) {
+    const Subspace::objects_t & objects = subspace->getObjects();
+    for( Subspace::objects_t::size_type i = 0 ; i < objects.size() ; i++ ) {
+      unindexObject( objects[i].get() );
+    }
+  }
+}
+
+
+
+
+void World::setFixedStep( real dt, unsigned int maxSubsteps_ )
+{
+  assert( dt >= 0.0 && (dt == 0.0 || maxSubsteps_ > 0) );
+  fixedStep = dt;
+  maxSubsteps = maxSubsteps_;
+  accumulator = 0.0;
+  lastTickTime = -1.0;
+}
+
+
+void World::setRenderInterpolation( bool enable )
+{
+  renderInterpolation = enable;
+  if( !enable ) previousPoses.clear();
+}
+
+
+/* Returns the time in seconds from a clock that is not affected by changes
+   of the system time, if available. */
+static double monotonicTime()
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  if( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 ) {
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+#endif
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+void World::tick()
+{
+  double now = monotonicTime();
+  
+  // the first event only starts the clock; a stall or a jump of the
+  // fallback clock can neither run time backwards nor queue up more than
+  // the substeps of one event
+  double elapsed = lastTickTime < 0.0 ? 0.0 : now - lastTickTime;
+  elapsed = std::min( std::max( elapsed, 0.0 ),
+                      maxSubsteps * (double)fixedStep );
+  lastTickTime = now;
+  advance( elapsed );
+}
+
+
+unsigned int World::advance( double elapsed )
+{
+  assert( fixedStep > 0.0 );
+  
+  accumulator += elapsed;
+  unsigned int steps = (unsigned int)( accumulator / fixedStep );
+  if( steps > maxSubsteps ) {
+    // drop the backlog but keep the fraction, so alpha stays continuous
+    accumulator = std::fmod( accumulator, (double)fixedStep ) +
+      maxSubsteps * (double)fixedStep;
+    steps = maxSubsteps;
+  }
+  
+  for( unsigned int i = 0 ; i < steps ; i++ ) {
+    if( renderInterpolation && i == steps - 1 ) {
+      poseStamp++;
+      if( storePoses( *this ) < previousPoses.size() ) {
+        // some objects have been removed, drop their poses
+        for( poses_t::iterator j = previousPoses.begin() ;
+             j != previousPoses.end() ; ) {
+          if( j->second.stamp != poseStamp ) j = previousPoses.erase( j );
+          else ++j;
+        }
+      }
+    }
+    timestep( fixedStep );
+    accumulator -= fixedStep;
+  }
+  
+  // guard against rounding
+  if( accumulator < 0.0 ) accumulator = 0.0;
+  return steps;
+}
+
+
+unsigned int World::storePoses( const Subspace & subspace )
+{
+  unsigned int count = 0;
+  const Subspace::objects_t & objects = subspace.getObjects();
+  for( Subspace::objects_t::size_type i = 0 ; i < objects.size() ; i++ ) {
+    const Object & object = *objects[i];
+    
+    boost::shared_ptr<const Locator> locator = object.getLocator();
+    if( locator ) {
+      Pose & pose = previousPoses[&object];
+      const Vector & loc = locator->getLoc();
+      pose.loc[0] = loc(0); pose.loc[1] = loc(1); pose.loc[2] = loc(2);
+      pose.orientation = locator->getBasis().getQuaternion();
+      pose.stamp = poseStamp;
+      count++;
+    }
+    
+    if( const Subspace * contents = dynamic_cast<const Subspace *>( &object ) ) {
+      count += storePoses( *contents );
+    }
+  }
+  return count;
+}
@@ -42,6 +42,27 @@
  * If using graphics events for automatic timestepping, then the default step
  * length must also be set with setDefaultDt().
  *
+ * \par Fixed timestep
+ * By default, each GE_TICK event takes exactly one step of the default
+ * length, so the simulation speed follows the event rate. With
+ * setFixedStep(), the world instead accumulates the time between the events
+ * (from a monotonic clock, so changes of the system time do not affect it)
+ * and consumes it in substeps of a constant length, so the simulation runs
+ * in real time independently of the event rate. The number of substeps per
+ * event is capped to keep a slow simulation from falling ever further
+ * behind; the time exceeding the cap is dropped.
+ *
+ * \par
+ * The time left over in the accumulator is exposed as an interpolation alpha
+ * (getInterpolationAlpha()). If render interpolation is enabled, the world
+ * also keeps the pose of each object before the last substep, so that a
+ * renderer can blend between the previous and the current state (see
+ * OpenGLRenderer).
+ *
+ * The world keeps an index of the full names of all contained objects, which
+ * is updated when objects are added, removed or renamed. Objects can be
+ * looked up by their full name with findObject().
+ *
  * @todo
  * Rethink what it means if a World has a locator (and is it interpreted
  * consistently when doing absolute<->relative coordinate transformations).
@@ -55,8 +76,14 @@
 #include "../types.hpp"
 #include "../Graphics/types.hpp"
 #include "Subspace.hpp"
+#include "Locator.hpp"
+#include "Quaternion.hpp"
 #include "../Utility/Event.hpp"
+#include "../Utility/SymbolTable.hpp"
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <vector>
+#include <string>
 #include <cmath>
 
 
@@ -76,12 +103,83 @@ namespace lifespace {
     public Subspace,
     public EventListener<GraphicsEvent>
   {
+  public:
+    
+    /** The location and orientation of an object relative to its host
+        space, see getPreviousPose(). */
+    struct Pose {
+      real loc[3];
+      Quaternion orientation;
+      unsigned long stamp;
+    };
+    
+    
+  private:
+    
     double worldTime;
     long long worldIteration;
     
     real defaultDt;
     GraphicsEvents syncEventId;
     
+    /** Interned full paths of the contained objects. */
+    SymbolTable paths;
+    
+    /** Objects by path symbol. Each entry is the head of a list (linked
+        through Object::pathNext) of the objects having that path, or null. */
+    std::vector<Object *> pathObjects;
+    
+    /** Scratch buffer for building paths. */
+    std::string pathBuffer;
+    
+    /** Fixed-step mode: substep length (zero if disabled), the substep cap
+        per event, the unconsumed time and the time of the last event. */
+    real fixedStep;
+    unsigned int maxSubsteps;
+    double accumulator;
+    double lastTickTime;
+    
+    bool renderInterpolation;
+    typedef boost::unordered_map<const Object *, Pose> poses_t;
+    poses_t previousPoses;
+    unsigned long poseStamp;
+    
+    
+    /** Stores the poses of the contents of the subspace, recursively.
+        Returns the number of poses stored. */
+    unsigned int storePoses( const Subspace & subspace );
+    
+    /** Advances by the wall-clock time since the previous call. */
+    void tick();
+    
+    
+    /**
+     * Adds the given object and its contents (if it is a Subspace) to the
+     * path index. The host subspace of the object must already be indexed.
+     * Nested Worlds are not indexed: they maintain their own index.
+     */
+    void indexObject( Object * object );
+    
+    /**
+     * Removes the given object and its contents from the path index.
+     */
+    void unindexObject( Object * object );
+    
+    /** Subspace::addObject() and Subspace::removeObject() maintain the
+        index. */
+    friend class Subspace;
+    
+    /** Object::setName() reindexes the renamed object. */
+    friend class Object;
+    
+    
+  protected:
+    
+    /** Sets the simulation time and iteration counters (used when restoring
+        a checkpoint, see ODEWorld::restore()). */
+    void setWorldClock( double time, long long iteration )
+    { worldTime = time; worldIteration = iteration; }
+    
     
   public:
     
@@ -95,17 +193,31 @@ namespace lifespace {
       worldTime( 0.0 ),
       worldIteration( 0 ),
       defaultDt( NAN ),
-      syncEventId( GE_TICK )
-    {}
+      syncEventId( GE_TICK ),
+      fixedStep( 0.0 ),
+      maxSubsteps( 0 ),
+      accumulator( 0.0 ),
+      lastTickTime( -1.0 ),
+      renderInterpolation( false ),
+      poseStamp( 0 )
+    { indexObject( this ); }
     
     /**
      * Creates a new world with a default constructed Subspace base class.
      */
     World() :
       Subspace(),
+      worldTime( 0.0 ),
+      worldIteration( 0 ),
       defaultDt( NAN ),
-      syncEventId( GE_TICK )
-    {}
+      syncEventId( GE_TICK ),
+      fixedStep( 0.0 ),
+      maxSubsteps( 0 ),
+      accumulator( 0.0 ),
+      lastTickTime( -1.0 ),
+      renderInterpolation( false ),
+      poseStamp( 0 )
+    { indexObject( this ); }
     
     
     /**
@@ -131,6 +243,33 @@ namespace lifespace {
     virtual bool transformToWorldCoordinates( Matrix & target ) const
     { return true; }
     
+    /** Returns always zero: the world coordinates never move. */
+    virtual unsigned long getWorldTransformStamp() const
+    { return 0; }
+    
+    
+    /**
+     * Returns the contained object with the given full name (see
+     * Object::getFullName()), or null if there is no such object. The world
+     * itself can be found with its own name. If several objects have the same
+     * full name, then one of them is returned.
+     *
+     * This is a single hash table lookup.
+     */
+    Object * findObject( const std::string & fullName ) const
+    {
+      SymbolTable::Symbol symbol = paths.find( fullName );
+      return symbol == SymbolTable::NoSymbol ? 0 : pathObjects[symbol];
+    }
+    
+    /** Returns the full name of the given path symbol. */
+    const std::string & getPath( SymbolTable::Symbol symbol ) const
+    { return paths.getString( symbol ); }
+    
+    /** Returns the number of distinct full names in the path index. */
+    unsigned int getPathCount() const
+    { return paths.count(); }
+    
     
     /**
      * Takes a timestep of the given length.
@@ -170,12 +309,73 @@ namespace lifespace {
     void setDefaultDt( real dt )
     { defaultDt = dt; }
     
+    /**
+     * Enables the fixed-step mode for GE_TICK events (see the class
+     * documentation). A zero step length restores the default mode of one
+     * step of the default length per event.
+     *
+     * @param dt              The substep length.
+     * @param maxSubsteps_    The maximum number of substeps per event.
+     */
+    void setFixedStep( real dt, unsigned int maxSubsteps_ = 8 );
+    
+    /** Returns the substep length, or zero if the fixed-step mode is
+        disabled. */
+    real getFixedStep() const
+    { return fixedStep; }
+    
+    unsigned int getMaxSubsteps() const
+    { return maxSubsteps; }
+    
+    /**
+     * Consumes the given amount of time in fixed substeps and returns the
+     * number of substeps taken. This is called by processEvent() with the
+     * wall-clock time since the previous event, but it can be called directly
+     * as well. The fixed-step mode must be enabled.
+     */
+    unsigned int advance( double elapsed );
+    
+    /**
+     * Returns the fraction of a substep left in the accumulator after the
+     * last advance(), in [0, 1). A renderer can use this to interpolate
+     * between the previous and the current state. Returns one in the default
+     * mode.
+     */
+    real getInterpolationAlpha() const
+    { return fixedStep > 0.0 ? accumulator / fixedStep : 1.0; }
+    
+    /**
+     * Enables storing the pose of each object before the last substep of each
+     * advance(), for render interpolation. Costs one pass over the objects
+     * per advance(). Disabled by default.
+     */
+    void setRenderInterpolation( bool enable );
+    
+    bool hasRenderInterpolation() const
+    { return renderInterpolation && fixedStep > 0.0; }
+    
+    /**
+     * Returns the pose of the object before the last substep, or null if
+     * none has been stored (render interpolation is disabled, or the object
+     * was added after the last substep).
+     */
+    const Pose * getPreviousPose( const Object & object ) const
+    {
+      poses_t::const_iterator i = previousPoses.find( &object );
+      return i == previousPoses.end() ? 0 : &i->second;
+    }
+    
+    
     /** */
     virtual void processEvent( const GraphicsEvent * event )
     {
       if( event->id == syncEventId ) {
-        assert( !std::isnan( defaultDt ) );
-        timestep( defaultDt );
+        if( fixedStep > 0.0 ) {
+          tick();
+        } else {
+          assert( !std::isnan( defaultDt ) );
+          timestep( defaultDt );
+        }
       }
     }
     
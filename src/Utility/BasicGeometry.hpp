@@ -43,8 +43,11 @@
 #include "Geometry.hpp"
 #include "shapes.hpp"
 #include "CollisionMaterial.hpp"
+#include "CollisionLayers.hpp"
+#include "Pool.hpp"
 
 #include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
 
 
 
@@ -60,12 +63,37 @@ namespace lifespace {
     boost::shared_ptr<const Shape> shape;
     boost::shared_ptr<const CollisionMaterial> collisionMaterial;
     
+    /** The collision layers this geometry belongs to, and the layers it
+        collides with (see CollisionLayers). By default the geometry belongs
+        to the default layer and collides with all layers. */
+    CollisionLayers::Mask categoryBits;
+    CollisionLayers::Mask collideBits;
+    
     BasicGeometry( boost::shared_ptr<const Shape> shape_,
                    boost::shared_ptr<const CollisionMaterial>
-                   collisionMaterial_ ) :
+                   collisionMaterial_,
+                   CollisionLayers::Mask categoryBits_ =
+                   CollisionLayers::Bit( CollisionLayers::Default ),
+                   CollisionLayers::Mask collideBits_ =
+                   CollisionLayers::All ) :
       Geometry(),
-      shape( shape_ ), collisionMaterial( collisionMaterial_ )
+      shape( shape_ ), collisionMaterial( collisionMaterial_ ),
+      categoryBits( categoryBits_ ), collideBits( collideBits_ )
     {}
+    
+    /** Creates a new BasicGeometry, allocating it and its reference count
+        together in a single pooled block. */
+    static boost::shared_ptr<BasicGeometry>
+    create( boost::shared_ptr<const Shape> shape,
+            boost::shared_ptr<const CollisionMaterial> collisionMaterial,
+            CollisionLayers::Mask categoryBits =
+            CollisionLayers::Bit( CollisionLayers::Default ),
+            CollisionLayers::Mask collideBits = CollisionLayers::All )
+    {
+      return boost::allocate_shared<BasicGeometry>
+        ( PoolAllocator<BasicGeometry>(), shape, collisionMaterial,
+          categoryBits, collideBits );
+    }
   };
 
 
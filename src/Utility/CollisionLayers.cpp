@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file CollisionLayers.cpp
+ */
+#include "../types.hpp"
+#include "CollisionLayers.hpp"
+#include "SymbolTable.hpp"
+using namespace lifespace;
+
+#include <string>
+using std::string;
+
+
+
+
+/** Returns the layer name table, with the predefined layers interned in the
+    order of the Layer enum. */
+static SymbolTable & Layers()
+{
+  static SymbolTable layers;
+  
+  if( layers.size() == 0 ) {
+    layers.intern( "default" );
+    layers.intern( "terrain" );
+    layers.intern( "actors" );
+    layers.intern( "debris" );
+    layers.intern( "sensors" );
+    assert( layers.size() == CollisionLayers::FirstUserLayer );
+  }
+  
+  return layers;
+}
+
+
+
+
+unsigned int CollisionLayers::GetLayer( const string & name )
+{
+  SymbolTable::Symbol layer = Layers().intern( name );
+  assert_user( layer < MaxLayers,
+               "Too many collision layers, at most " << MaxLayers
+               << " are supported!" );
+  return layer;
+}
+
+
+const string & CollisionLayers::GetName( unsigned int layer )
+{
+  assert( layer < Layers().size() );
+  return Layers().getString( layer );
+}
+
+
+unsigned int CollisionLayers::GetLayerCount()
+{
+  return Layers().size();
+}
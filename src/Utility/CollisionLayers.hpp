@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+/**
+ * @file CollisionLayers.hpp
+ *
+ * Named collision layers and the category and collide masks built from them.
+ */
+
+/**
+ * @class lifespace::CollisionLayers
+ * @ingroup Utility
+ *
+ * @brief
+ * Named collision layers and the category and collide masks built from them.
+ *
+ * Each layer is a single bit of a Mask. A BasicGeometry belongs to the layers
+ * in its category mask and collides with the layers in its collide mask. Two
+ * geometries collide if either one's category mask intersects the other's
+ * collide mask. The masks are pushed into the ODE geoms, so that filtered
+ * pairs are rejected by the broadphase, before any narrowphase work.
+ *
+ * The predefined layers are listed in the Layer enum. Further layers are
+ * registered by name with GetLayer(), up to the number of bits in a Mask.
+ * Registering is not thread-safe, so register the layers during setup.
+ *
+ * Example: debris that collides with everything except other debris:
+ * \code
+ *   BasicGeometry::create( shape, material,
+ *                          CollisionLayers::Bit( CollisionLayers::Debris ),
+ *                          ~CollisionLayers::Bit( CollisionLayers::Debris ) );
+ * \endcode
+ */
+#ifndef LS_U_COLLISIONLAYERS_HPP
+#define LS_U_COLLISIONLAYERS_HPP
+
+
+#include "../types.hpp"
+#include <string>
+#include <cassert>
+
+
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class CollisionLayers
+  {
+  public:
+    
+    /** A set of layers, one bit per layer (the type used by ODE). */
+    typedef unsigned long Mask;
+    
+    /** The mask of all layers. */
+    static const Mask All = ~0ul;
+    
+    /** The mask of no layers. */
+    static const Mask None = 0ul;
+    
+    /** The predefined layers, named "default", "terrain", "actors",
+        "debris" and "sensors". */
+    enum Layer {
+      Default,
+      Terrain,
+      Actors,
+      Debris,
+      Sensors,
+      
+      /** The first layer available for named user layers. */
+      FirstUserLayer
+    };
+    
+    /** The maximum number of layers. */
+    static const unsigned int MaxLayers = sizeof(Mask) * 8;
+    
+    
+    /** Returns the mask of a single layer. */
+    static Mask Bit( unsigned int layer )
+    {
+      assert( layer < MaxLayers );
+      return 1ul << layer;
+    }
+    
+    /** Returns the layer with the given name, registering a new layer if
+        the name is not known yet. */
+    static unsigned int GetLayer( const std::string & name );
+    
+    /** Returns the mask of the named layer (see GetLayer()). */
+    static Mask GetMask( const std::string & name )
+    { return Bit( GetLayer( name ) ); }
+    
+    /** Returns the name of a registered layer. */
+    static const std::string & GetName( unsigned int layer );
+    
+    /** Returns the number of registered layers, including the predefined
+        ones. */
+    static unsigned int GetLayerCount();
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+
+
+#endif   /* LS_U_COLLISIONLAYERS_HPP */
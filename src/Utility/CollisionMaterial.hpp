@@ -33,6 +33,10 @@
  * @brief
  * Collision and friction properties of a surface.
  *
+ * A material is immutable, as the contact surfaces between the materials are
+ * precomputed when they are first used (see ODECollisionRenderer). Create a
+ * new material for different properties.
+ *
  * @todo
  * Implement a factory method for easily instantiate a collision material and
  * wrap it in a shared_ptr.
@@ -53,9 +57,9 @@ namespace lifespace {
   
   struct CollisionMaterial
   {
-    float friction;
-    float bounciness;
-    float bounceMinVel;
+    const float friction;
+    const float bounciness;
+    const float bounceMinVel;
     
     /**
      * Creates a new CollisionMaterial object, which can be used with
@@ -23,7 +23,7 @@
 /**
  * @file Contact.hpp
  *
- * <brief>
+ * A contact between two Geometry objects.
  */
 
 /**
@@ -31,14 +31,20 @@
  * @ingroup Utility
  *
  * @brief
- * <brief>
+ * A contact between two Geometry objects.
+ *
+ * Contacts are created and owned by the collision detector, which keeps a
+ * contact alive for as long as the geometries keep touching. Each contact is
+ * linked into the contact lists of both geometries (see
+ * Geometry::getContacts()).
  */
 #ifndef LS_U_CONTACT_HPP
 #define LS_U_CONTACT_HPP
 
 
 #include "../types.hpp"
-#include <algorithm>
+#include <cstddef>
+#include <cassert>
 
 
 
@@ -57,39 +63,72 @@ namespace lifespace {
     Geometry * lhs;
     Geometry * rhs;
     
-    /** For quick wiping of old contacts. */
-    bool flipflop;
+    /** The collision detector's generation stamp of the last collision
+        between the geometries, for quick wiping of old contacts. */
+    unsigned long generation;
+    
+    /** Position in the collision detector's contact list. */
+    std::size_t index;
+    
+    /** Links of the contact lists of the two geometries: [0] for the list of
+        lhs and [1] for the list of rhs. */
+    Contact * next[2];
+    Contact * prev[2];
+    
+    int side( const Geometry * geometry ) const
+    {
+      assert( geometry == lhs || geometry == rhs );
+      return geometry == lhs ? 0 : 1;
+    }
+    
+    
+    /** Geometry maintains the links of its contact list. */
+    friend class Geometry;
     
     
   public:
     
     /* constructors/destructors/etc */
     
-    Contact( Geometry * lhs_, Geometry * rhs_ ) :
-      lhs( std::min(lhs_,rhs_) ),
-      rhs( std::max(lhs_,rhs_) )
-    {
-      assert( lhs && rhs );
-      
-      lhs->addContact( rhs, this );
-      rhs->addContact( lhs, this );
-    }
+    /** Creates the contact and inserts it into the contact lists of both
+        geometries. */
+    Contact( Geometry * lhs_, Geometry * rhs_ );
     
-    ~Contact()
-    {
-      lhs->removeContact( rhs );
-      rhs->removeContact( lhs );
-    }
+    /** Removes the contact from the contact lists of both geometries. */
+    ~Contact();
     
     
     /* accessors */
     
-    bool & getFlipflop()
-    { return flipflop; }
+    Geometry * getLhs() const
+    { return lhs; }
+    
+    Geometry * getRhs() const
+    { return rhs; }
+    
+    /** Returns the geometry at the other end of the contact. */
+    Geometry * getOther( const Geometry * geometry ) const
+    { return side( geometry ) == 0 ? rhs : lhs; }
+    
+    /** Returns the next contact in the contact list of the given geometry
+        (which must be either end of this contact). */
+    Contact * getNext( const Geometry * geometry ) const
+    { return next[side( geometry )]; }
+    
+    unsigned long & getGeneration()
+    { return generation; }
+    
+    std::size_t & getIndex()
+    { return index; }
     
     
     /* operations */
     
+    /** Wakes the host Object of either geometry if the other one is awake
+        (see Object::wake()). Called when the contact is created, and by the
+        collision detector whenever the geometries still touch. */
+    void wakeHosts();
+    
   };
   
   
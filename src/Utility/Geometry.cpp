@@ -26,17 +26,19 @@
 #include "../types.hpp"
 #include "Geometry.hpp"
 #include "Event.hpp"
+#include "Contact.hpp"
+#include "../Structures/Object.hpp"
 using namespace lifespace;
 
-#include <utility>
-using std::make_pair;
+#include <algorithm>
 
 
 
 
 Geometry::Geometry() :
   hostObject( 0 ),
-  contacts(),
+  firstContact( 0 ),
+  contactCount( 0 ),
   events( *this )
 {}
 
@@ -49,26 +51,74 @@ Geometry::~Geometry()
 
 
 
-void Geometry::addContact( const Geometry * other,
-                           Contact * contact )
+void Geometry::addContact( Contact * contact )
 {
+  const Geometry * other = contact->getOther( this );
   events.sendEvent( AddContactEvent( other, contact ) );
   
   // make sure that no contact between these Geometries exist already
-  assert( contacts.find( other ) == contacts.end() );
+  assert( getContacts().find( other ) == getContacts().end() );
   
-  contacts.insert( make_pair(other, contact) );
+  // link to the head of the list
+  int side = contact->side( this );
+  contact->next[side] = firstContact;
+  contact->prev[side] = 0;
+  if( firstContact ) firstContact->prev[firstContact->side( this )] = contact;
+  firstContact = contact;
+  contactCount++;
 }
 
 
-void Geometry::removeContact( const Geometry * other )
+void Geometry::removeContact( Contact * contact )
 {
-  events.sendEvent( RemoveContactEvent( other ) );
-  
-  contacts_t::iterator i = contacts.find( other );
+  events.sendEvent( RemoveContactEvent( contact->getOther( this ) ) );
   
   // assert that the contact existed
-  assert( i != contacts.end() );
+  assert( getContacts().find( contact->getOther( this ) ) !=
+          getContacts().end() );
+  
+  int side = contact->side( this );
+  Contact * next = contact->next[side];
+  Contact * prev = contact->prev[side];
+  if( next ) next->prev[next->side( this )] = prev;
+  if( prev ) {
+    prev->next[prev->side( this )] = next;
+  } else {
+    firstContact = next;
+  }
+  contactCount--;
+}
+
+
+
+
+Contact::Contact( Geometry * lhs_, Geometry * rhs_ ) :
+  lhs( std::min(lhs_,rhs_) ),
+  rhs( std::max(lhs_,rhs_) ),
+  generation( 0 ),
+  index( 0 )
+{
+  assert( lhs && rhs && lhs != rhs );
+  
+  lhs->addContact( this );
+  rhs->addContact( this );
+  wakeHosts();
+}
+
+
+Contact::~Contact()
+{
+  lhs->removeContact( this );
+  rhs->removeContact( this );
+}
+
+
+void Contact::wakeHosts()
+{
+  Object * lhsHost = lhs->getHostObject();
+  Object * rhsHost = rhs->getHostObject();
+  if( !lhsHost || !rhsHost ) return;
   
-  contacts.erase( i );
+  if( lhsHost->isAwake() ) rhsHost->wake();
+  else if( rhsHost->isAwake() ) lhsHost->wake();
 }
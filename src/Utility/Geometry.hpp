@@ -41,7 +41,9 @@
 
 #include "../types.hpp"
 #include "Event.hpp"
-#include <map>
+#include "Contact.hpp"
+#include <cstddef>
+#include <utility>
 
 
 
@@ -51,7 +53,6 @@ namespace lifespace {
   
   /* forwards */
   class Object;
-  class Contact;
   
   
   
@@ -61,11 +62,99 @@ namespace lifespace {
     
   public:
     
-    /** A mapping for active physical contacts between Geometry objects. The
-        key type is the target Geometry's raw pointer, and the value type is a
-        raw pointer to the Contact object representing the contact. The Contact
-        objects are owned by the collision detector. */
-    typedef std::map<const Geometry *, Contact *> contacts_t;
+    /**
+     * A view of the active physical contacts of a Geometry. Iterates like a
+     * map from the target Geometry's raw pointer to the Contact object
+     * representing the contact: the iterators point to pairs (first is the
+     * other Geometry, second is the Contact). The Contact objects are owned
+     * by the collision detector.
+     *
+     * The view is a few pointers that are returned by value. It stays valid
+     * until the contacts of the Geometry change, and the order of the
+     * contacts is unspecified.
+     */
+    class ContactList
+    {
+    public:
+      
+      typedef std::pair<const Geometry *, Contact *> value_type;
+      
+      class const_iterator
+      {
+        const Geometry * owner;
+        Contact * contact;
+        value_type value;
+        
+      public:
+        
+        const_iterator( const Geometry * owner_, Contact * contact_ ) :
+          owner( owner_ ), contact( contact_ ),
+          value( contact_ ? contact_->getOther( owner_ ) : 0, contact_ )
+        {}
+        
+        const value_type & operator*() const
+        { return value; }
+        
+        const value_type * operator->() const
+        { return &value; }
+        
+        const_iterator & operator++()
+        {
+          contact = contact->getNext( owner );
+          value = value_type( contact ? contact->getOther( owner ) : 0,
+                              contact );
+          return *this;
+        }
+        
+        const_iterator operator++( int )
+        { const_iterator result( *this ); ++*this; return result; }
+        
+        bool operator==( const const_iterator & other ) const
+        { return contact == other.contact; }
+        
+        bool operator!=( const const_iterator & other ) const
+        { return contact != other.contact; }
+      };
+      
+      typedef const_iterator iterator;
+      
+      
+    private:
+      
+      const Geometry * owner;
+      Contact * first;
+      std::size_t count;
+      
+      
+    public:
+      
+      ContactList( const Geometry * owner_, Contact * first_,
+                   std::size_t count_ ) :
+        owner( owner_ ), first( first_ ), count( count_ ) {}
+      
+      const_iterator begin() const
+      { return const_iterator( owner, first ); }
+      
+      const_iterator end() const
+      { return const_iterator( owner, 0 ); }
+      
+      std::size_t size() const
+      { return count; }
+      
+      bool empty() const
+      { return count == 0; }
+      
+      /** Returns the contact with the given Geometry, or end(). Linear in the
+          number of contacts of this Geometry. */
+      const_iterator find( const Geometry * other ) const
+      {
+        const_iterator i = begin();
+        while( i != end() && i->first != other ) ++i;
+        return i;
+      }
+    };
+    
+    typedef ContactList contacts_t;
     
     
     /* events */
@@ -136,19 +225,30 @@ namespace lifespace {
         at the same time. */
     Object * hostObject;
     
-    /** All currently active contacts (for objects which support collision
-        detection). The Contact objects (the value types of the map) are owned
-        by the collision detector. */
-    contacts_t contacts;
+    /** The head of the list of all currently active contacts (for objects
+        which support collision detection), linked through the Contact
+        objects. The Contact objects are owned by the collision detector. */
+    Contact * firstContact;
+    std::size_t contactCount;
     
     
     void setHostObject( Object * newHostObject )
     { hostObject = newHostObject; }
     
+    /** Links a new contact into the contact list. */
+    void addContact( Contact * contact );
+    
+    /** Unlinks a contact from the contact list. */
+    void removeContact( Contact * contact );
+    
     
     /** Object needs access to the private setHostObject() method. */
     friend class Object;
     
+    /** Contact adds and removes itself with addContact() and
+        removeContact(). */
+    friend class Contact;
+    
     
   public:
     
@@ -171,18 +271,9 @@ namespace lifespace {
     Object * getHostObject()
     { return hostObject; }
     
-    const contacts_t & getContacts() const
-    { return contacts; }
-    
-    contacts_t & getContacts()
-    { return contacts; }
-    
-    
-    /* operations */
-    
-    void addContact( const Geometry * other, Contact * contact );
-    
-    void removeContact( const Geometry * other );
+    /** Returns a view of the active contacts. */
+    contacts_t getContacts() const
+    { return contacts_t( this, firstContact, contactCount ); }
     
   };
 
@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file HandleVector.hpp
+ *
+ * A dense, contiguous container with stable integer handles.
+ */
+
+/**
+ * @class lifespace::HandleVector
+ * @ingroup Utility
+ *
+ * @brief
+ * A dense, contiguous container with stable integer handles.
+ *
+ * The elements are stored in a single std::vector, so iterating over them is
+ * as cheap as iterating over an array. Each inserted element is given a
+ * Handle, which stays valid until the element is erased, regardless of how
+ * the other elements move around. Erasing by handle is O(1) in unordered mode
+ * (the last element is swapped into the hole) and O(n) in ordered mode (the
+ * tail is shifted down, preserving insertion order).
+ *
+ * Handles carry a generation count, so a stale handle (one whose element has
+ * already been erased) is detected by contains() even if its slot has since
+ * been reused.
+ *
+ * @note
+ * Like with std::vector, insert() may invalidate all iterators, and erase()
+ * invalidates iterators to the erased element and to the elements after it.
+ * Use indices if elements may be inserted during iteration.
+ */
+#ifndef LS_U_HANDLEVECTOR_HPP
+#define LS_U_HANDLEVECTOR_HPP
+
+
+#include "../types.hpp"
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  template<class T>
+  class HandleVector
+  {
+  public:
+    
+    /** Marks a null handle / an unused slot. */
+    static const unsigned int NoSlot = ~0u;
+    
+    /** A stable reference to an element of a HandleVector. */
+    struct Handle {
+      unsigned int slot;
+      unsigned int generation;
+      
+      Handle() : slot( NoSlot ), generation( 0 ) {}
+      Handle( unsigned int slot_, unsigned int generation_ ) :
+        slot( slot_ ), generation( generation_ ) {}
+      
+      bool isNull() const
+      { return slot == NoSlot; }
+      
+      bool operator==( const Handle & other ) const
+      { return slot == other.slot && generation == other.generation; }
+      bool operator!=( const Handle & other ) const
+      { return !(*this == other); }
+    };
+    
+    typedef typename std::vector<T>::value_type value_type;
+    typedef typename std::vector<T>::size_type size_type;
+    typedef typename std::vector<T>::reference reference;
+    typedef typename std::vector<T>::const_reference const_reference;
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    
+    
+  private:
+    
+    /** Maps a handle to the dense index of its element. */
+    struct Slot {
+      unsigned int index;
+      unsigned int generation;
+    };
+    
+    /** The elements, densely packed. */
+    std::vector<T> values;
+    
+    /** The slot of each element in values (parallel array). */
+    std::vector<unsigned int> valueSlots;
+    
+    std::vector<Slot> slots;
+    std::vector<unsigned int> freeSlots;
+    
+    bool ordered;
+    
+    
+  public:
+    
+    /**
+     * Constructs an empty container.
+     *
+     * @param ordered   Preserve insertion order on erase (see setOrdered()).
+     */
+    explicit HandleVector( bool ordered_ = true ) :
+      ordered( ordered_ )
+    {}
+    
+    
+    /**
+     * Selects whether erase() preserves the relative order of the remaining
+     * elements. Switching modes does not reorder the existing elements.
+     */
+    void setOrdered( bool ordered_ )
+    { ordered = ordered_; }
+    
+    bool isOrdered() const
+    { return ordered; }
+    
+    
+    /**
+     * Appends the given element and returns a handle to it.
+     */
+    Handle insert( const T & value )
+    {
+      unsigned int slot;
+      if( freeSlots.empty() ) {
+        slot = slots.size();
+        Slot newSlot = { 0, 0 };
+        slots.push_back( newSlot );
+      } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+      }
+      
+      slots[slot].index = values.size();
+      values.push_back( value );
+      valueSlots.push_back( slot );
+      
+      return Handle( slot, slots[slot].generation );
+    }
+    
+    /**
+     * Erases the element referred to by the given handle. It is an error to
+     * call this with a handle that is not contained in the container.
+     */
+    void erase( const Handle & handle )
+    {
+      assert( contains( handle ) );
+      
+      Slot & slot = slots[handle.slot];
+      unsigned int index = slot.index;
+      unsigned int last = values.size() - 1;
+      
+      if( ordered ) {
+        // rotate the element to the back with swaps (cheap for smart
+        // pointers, unlike the copy assignments done by vector::erase())
+        std::rotate( values.begin() + index, values.begin() + index + 1,
+                     values.end() );
+        values.pop_back();
+        valueSlots.erase( valueSlots.begin() + index );
+        for( unsigned int i = index ; i < last ; i++ ) {
+          slots[valueSlots[i]].index = i;
+        }
+      } else {
+        if( index != last ) {
+          values[index] = values[last];
+          valueSlots[index] = valueSlots[last];
+          slots[valueSlots[index]].index = index;
+        }
+        values.pop_back();
+        valueSlots.pop_back();
+      }
+      
+      // retire the handle
+      slot.index = NoSlot;
+      slot.generation++;
+      freeSlots.push_back( handle.slot );
+    }
+    
+    /**
+     * Erases all elements. All handles become invalid.
+     */
+    void clear()
+    {
+      for( unsigned int i = 0 ; i < valueSlots.size() ; i++ ) {
+        Slot & slot = slots[valueSlots[i]];
+        slot.index = NoSlot;
+        slot.generation++;
+        freeSlots.push_back( valueSlots[i] );
+      }
+      values.clear();
+      valueSlots.clear();
+    }
+    
+    void reserve( size_type count )
+    {
+      values.reserve( count );
+      valueSlots.reserve( count );
+      slots.reserve( count );
+    }
+    
+    
+    /**
+     * Checks whether the given handle refers to an element of this container.
+     */
+    bool contains( const Handle & handle ) const
+    {
+      return handle.slot < slots.size() &&
+        slots[handle.slot].generation == handle.generation &&
+        slots[handle.slot].index != NoSlot;
+    }
+    
+    /** Returns the dense index of the element referred to by the handle. */
+    size_type indexOf( const Handle & handle ) const
+    { assert( contains( handle ) ); return slots[handle.slot].index; }
+    
+    /** Returns the handle of the element at the given dense index. */
+    Handle handleAt( size_type index ) const
+    {
+      assert( index < values.size() );
+      return Handle( valueSlots[index], slots[valueSlots[index]].generation );
+    }
+    
+    reference get( const Handle & handle )
+    { return values[indexOf( handle )]; }
+    const_reference get( const Handle & handle ) const
+    { return values[indexOf( handle )]; }
+    
+    
+    /* std::vector-like access */
+    
+    size_type size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    
+    reference operator[]( size_type index ) { return values[index]; }
+    const_reference operator[]( size_type index ) const
+    { return values[index]; }
+    
+    reference front() { return values.front(); }
+    const_reference front() const { return values.front(); }
+    reference back() { return values.back(); }
+    const_reference back() const { return values.back(); }
+    
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_U_HANDLEVECTOR_HPP */
@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file Pool.hpp
+ *
+ * Fixed-size block pools and a pooling STL allocator.
+ *
+ * Small, frequently created objects (locators, geometries, shapes, and the
+ * shared_ptr control blocks that own them) are allocated from per-size free
+ * lists instead of the global heap. Combined with boost::allocate_shared(),
+ * an object and its reference count are placed in one pooled block:
+ *
+ * @code
+ *   boost::shared_ptr<Foo> foo =
+ *     boost::allocate_shared<Foo>( PoolAllocator<Foo>(), arg1, arg2 );
+ * @endcode
+ *
+ * Objects that have already been allocated with new can still get a pooled
+ * control block with pool_shared().
+ *
+ * The free lists are thread-local (see LS_THREAD_LOCAL in types.hpp), so the
+ * pools need no locking. A block may be freed by a different thread than the
+ * one that allocated it: it then simply moves to the freeing thread's list.
+ * When a thread exits, its list is moved to a shared list, from which the
+ * other threads refill their lists before allocating new memory. Without
+ * thread-local storage, the shared list is used directly under a mutex. Pool
+ * memory is never returned to the system, it is only recycled.
+ */
+#ifndef LS_U_POOL_HPP
+#define LS_U_POOL_HPP
+
+
+#include "../types.hpp"
+#include <boost/shared_ptr.hpp>
+#include <boost/checked_delete.hpp>
+#include <cstddef>
+#include <new>
+#include <limits>
+#include <pthread.h>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  /**
+   * @class lifespace::FixedPool
+   * @ingroup Utility
+   *
+   * @brief
+   * A free list of memory blocks of the given size.
+   */
+  template<std::size_t Size>
+  class FixedPool
+  {
+    union Block {
+      Block * next;
+      char data[Size];
+      long double alignment;
+    };
+    
+    /** Number of blocks allocated from the heap at once. */
+    static const std::size_t ChunkBlocks = 64;
+    
+    /** Free blocks not owned by any thread: the lists of exited threads, or
+        all free blocks without thread-local storage. */
+    static Block * sharedList;
+    static pthread_mutex_t sharedLock;
+    
+    /** Returns a list of free blocks, taken from the shared list or
+        allocated from the heap. Must be called with sharedLock held. */
+    static Block * TakeShared()
+    {
+      Block * result = sharedList;
+      if( result ) {
+        sharedList = 0;
+        return result;
+      }
+      
+      Block * chunk =
+        static_cast<Block *>( ::operator new( ChunkBlocks * sizeof(Block) ) );
+      for( std::size_t i = 0 ; i < ChunkBlocks - 1 ; i++ ) {
+        chunk[i].next = &chunk[i + 1];
+      }
+      chunk[ChunkBlocks - 1].next = 0;
+      return chunk;
+    }
+    
+    
+#if LS_HAVE_THREAD_LOCAL
+    
+    static LS_THREAD_LOCAL Block * freeList;
+    static LS_THREAD_LOCAL bool threadRegistered;
+    
+    /** Its destructor returns the list of an exiting thread. */
+    static pthread_key_t threadKey;
+    static pthread_once_t threadKeyOnce;
+    
+    static void CreateThreadKey()
+    { pthread_key_create( &threadKey, ThreadExit ); }
+    
+    /** Moves the free list of the exiting thread to the shared list. */
+    static void ThreadExit( void * list )
+    {
+      Block * & blocks = *static_cast<Block **>( list );
+      if( !blocks ) return;
+      
+      Block * last = blocks;
+      while( last->next ) last = last->next;
+      
+      pthread_mutex_lock( &sharedLock );
+      last->next = sharedList;
+      sharedList = blocks;
+      pthread_mutex_unlock( &sharedLock );
+      blocks = 0;
+    }
+    
+    static void Refill()
+    {
+      if( !threadRegistered ) {
+        pthread_once( &threadKeyOnce, CreateThreadKey );
+        pthread_setspecific( threadKey, &freeList );
+        threadRegistered = true;
+      }
+      
+      pthread_mutex_lock( &sharedLock );
+      freeList = TakeShared();
+      pthread_mutex_unlock( &sharedLock );
+    }
+    
+    
+  public:
+    
+    static void * Allocate()
+    {
+      if( !freeList ) Refill();
+      Block * block = freeList;
+      freeList = block->next;
+      return block;
+    }
+    
+    static void Deallocate( void * p )
+    {
+      Block * block = static_cast<Block *>( p );
+      block->next = freeList;
+      freeList = block;
+    }
+    
+#else   /* LS_HAVE_THREAD_LOCAL */
+    
+    
+  public:
+    
+    static void * Allocate()
+    {
+      pthread_mutex_lock( &sharedLock );
+      if( !sharedList ) sharedList = TakeShared();
+      Block * block = sharedList;
+      sharedList = block->next;
+      pthread_mutex_unlock( &sharedLock );
+      return block;
+    }
+    
+    static void Deallocate( void * p )
+    {
+      Block * block = static_cast<Block *>( p );
+      pthread_mutex_lock( &sharedLock );
+      block->next = sharedList;
+      sharedList = block;
+      pthread_mutex_unlock( &sharedLock );
+    }
+    
+#endif   /* LS_HAVE_THREAD_LOCAL */
+  };
+  
+  template<std::size_t Size>
+  typename FixedPool<Size>::Block * FixedPool<Size>::sharedList = 0;
+  
+  template<std::size_t Size>
+  pthread_mutex_t FixedPool<Size>::sharedLock = PTHREAD_MUTEX_INITIALIZER;
+  
+#if LS_HAVE_THREAD_LOCAL
+  template<std::size_t Size>
+  LS_THREAD_LOCAL typename FixedPool<Size>::Block *
+  FixedPool<Size>::freeList = 0;
+  
+  template<std::size_t Size>
+  LS_THREAD_LOCAL bool FixedPool<Size>::threadRegistered = false;
+  
+  template<std::size_t Size>
+  pthread_key_t FixedPool<Size>::threadKey;
+  
+  template<std::size_t Size>
+  pthread_once_t FixedPool<Size>::threadKeyOnce = PTHREAD_ONCE_INIT;
+#endif
+  
+  
+  
+  
+  /**
+   * @class lifespace::PoolAllocator
+   * @ingroup Utility
+   *
+   * @brief
+   * An STL allocator that takes single objects from a FixedPool and passes
+   * array allocations on to the global operator new.
+   *
+   * The allocator is stateless, so all instances compare equal.
+   */
+  template<class T>
+  class PoolAllocator
+  {
+  public:
+    typedef T value_type;
+    typedef T * pointer;
+    typedef const T * const_pointer;
+    typedef T & reference;
+    typedef const T & const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    
+    template<class U>
+    struct rebind { typedef PoolAllocator<U> other; };
+    
+    PoolAllocator() {}
+    template<class U>
+    PoolAllocator( const PoolAllocator<U> & ) {}
+    
+    pointer allocate( size_type n, const void * = 0 )
+    {
+      if( n == 1 ) {
+        return static_cast<pointer>( FixedPool<sizeof(T)>::Allocate() );
+      }
+      return static_cast<pointer>( ::operator new( n * sizeof(T) ) );
+    }
+    
+    void deallocate( pointer p, size_type n )
+    {
+      if( n == 1 ) FixedPool<sizeof(T)>::Deallocate( p );
+      else ::operator delete( p );
+    }
+    
+    void construct( pointer p, const T & value )
+    { new( p ) T( value ); }
+    
+    void destroy( pointer p )
+    { p->~T(); }
+    
+    pointer address( reference x ) const { return &x; }
+    const_pointer address( const_reference x ) const { return &x; }
+    
+    size_type max_size() const
+    { return std::numeric_limits<size_type>::max() / sizeof(T); }
+  };
+  
+  template<class T, class U>
+  inline bool operator==( const PoolAllocator<T> &, const PoolAllocator<U> & )
+  { return true; }
+  
+  template<class T, class U>
+  inline bool operator!=( const PoolAllocator<T> &, const PoolAllocator<U> & )
+  { return false; }
+  
+  
+  /**
+   * Takes the ownership of the given object like the shared_ptr constructor,
+   * but allocates the reference count from a pool. A null pointer results in
+   * an empty shared_ptr (with no reference count allocated at all).
+   */
+  template<class T>
+  inline boost::shared_ptr<T> pool_shared( T * p )
+  {
+    if( !p ) return boost::shared_ptr<T>();
+    return boost::shared_ptr<T>( p, boost::checked_deleter<T>(),
+                                 PoolAllocator<T>() );
+  }
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_U_POOL_HPP */
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file SymbolTable.hpp
+ *
+ * Interns strings into small integer symbols.
+ */
+
+/**
+ * @class lifespace::SymbolTable
+ * @ingroup Utility
+ *
+ * @brief
+ * Interns strings into small integer symbols.
+ *
+ * Each distinct string is stored once and given a dense integer id, which can
+ * be used to index plain arrays or compared with a single integer
+ * comparison. Symbols that are no longer needed can be released with
+ * release(), and their ids are reused by later interns, so the ids stay dense
+ * even if the strings come and go.
+ */
+#ifndef LS_U_SYMBOLTABLE_HPP
+#define LS_U_SYMBOLTABLE_HPP
+
+
+#include "../types.hpp"
+#include <boost/unordered_map.hpp>
+#include <vector>
+#include <string>
+#include <cassert>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class SymbolTable
+  {
+  public:
+    
+    typedef unsigned int Symbol;
+    
+    /** Returned by find() for strings that have not been interned. */
+    static const Symbol NoSymbol = ~0u;
+    
+    
+  private:
+    
+    typedef boost::unordered_map<std::string, Symbol> symbols_t;
+    
+    symbols_t symbols;
+    
+    /** The interned strings, indexed by symbol. Points to the keys of
+        symbols (unordered_map keeps element addresses on rehash), or null for
+        released symbols. */
+    std::vector<const std::string *> strings;
+    
+    /** Released symbols, reused by intern(). */
+    std::vector<Symbol> freeSymbols;
+    
+    
+  public:
+    
+    /** Returns the symbol of the given string, interning it if needed. */
+    Symbol intern( const std::string & string )
+    {
+      // look up first: inserting would copy the string even if it exists
+      symbols_t::const_iterator i = symbols.find( string );
+      if( i != symbols.end() ) return i->second;
+      
+      Symbol symbol;
+      if( freeSymbols.empty() ) {
+        symbol = strings.size();
+        strings.push_back( 0 );
+      } else {
+        symbol = freeSymbols.back();
+        freeSymbols.pop_back();
+      }
+      
+      symbols_t::iterator result =
+        symbols.insert( symbols_t::value_type( string, symbol ) ).first;
+      strings[symbol] = &result->first;
+      return symbol;
+    }
+    
+    /** Releases the given symbol. Its string is forgotten and the id may be
+        returned by a later intern() of any string. */
+    void release( Symbol symbol )
+    {
+      assert( symbol < strings.size() && strings[symbol] );
+      symbols.erase( *strings[symbol] );
+      strings[symbol] = 0;
+      freeSymbols.push_back( symbol );
+    }
+    
+    /** Returns the symbol of the given string, or NoSymbol if the string has
+        not been interned. */
+    Symbol find( const std::string & string ) const
+    {
+      symbols_t::const_iterator i = symbols.find( string );
+      return i == symbols.end() ? NoSymbol : i->second;
+    }
+    
+    /** Returns the string of the given symbol. */
+    const std::string & getString( Symbol symbol ) const
+    {
+      assert( symbol < strings.size() && strings[symbol] );
+      return *strings[symbol];
+    }
+    
+    /** Returns the upper bound of the symbols: all symbols are smaller than
+        this. Equals the number of interned strings if nothing has been
+        released. */
+    Symbol size() const
+    { return strings.size(); }
+    
+    /** Returns the number of currently interned strings. */
+    Symbol count() const
+    { return symbols.size(); }
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_U_SYMBOLTABLE_HPP */
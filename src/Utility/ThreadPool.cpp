@@ -0,0 +1,377 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file ThreadPool.cpp
+ *
+ * Implementations for the ThreadPool class.
+ */
+#include "../types.hpp"
+#include "ThreadPool.hpp"
+using namespace lifespace;
+
+#include <algorithm>
+using std::min;
+
+#include <cassert>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+
+
+
+/** How many times an idle worker yields before going to sleep. */
+static const unsigned int SpinCount = 64;
+
+
+/** Worker startup argument, and the identity of a worker thread. */
+struct WorkerStart {
+  ThreadPool * pool;
+  unsigned int index;
+};
+
+
+#if LS_HAVE_THREAD_LOCAL
+
+/** The pool and queue index of the current thread, if it is a worker. */
+static LS_THREAD_LOCAL const ThreadPool * CurrentPool = 0;
+static LS_THREAD_LOCAL unsigned int CurrentIndex = 0;
+
+#else   /* LS_HAVE_THREAD_LOCAL */
+
+/** The WorkerStart of the current thread, if it is a worker. */
+static pthread_key_t CurrentWorker;
+static pthread_once_t CurrentWorkerOnce = PTHREAD_ONCE_INIT;
+
+static void CreateCurrentWorker()
+{ pthread_key_create( &CurrentWorker, 0 ); }
+
+#endif   /* LS_HAVE_THREAD_LOCAL */
+
+
+#if !LS_HAVE_ATOMICS
+
+static pthread_mutex_t AtomicLock = PTHREAD_MUTEX_INITIALIZER;
+
+int lifespace::LockedFetchAndAdd( volatile int * target, int value )
+{
+  pthread_mutex_lock( &AtomicLock );
+  int result = *target;
+  *target = result + value;
+  pthread_mutex_unlock( &AtomicLock );
+  return result;
+}
+
+#endif   /* LS_HAVE_ATOMICS */
+
+
+
+
+ThreadPool::ThreadPool( unsigned int threadCount_ ) :
+  threadCount( threadCount_ ? threadCount_ : HardwareThreads() ),
+  sleeping( 0 ),
+  stopping( false ),
+  broadcast( 0 ),
+  broadcastGeneration( 0 ),
+  broadcastPending( 0 )
+{
+  pthread_mutex_init( &sleepLock, 0 );
+  pthread_cond_init( &wakeup, 0 );
+  pthread_mutex_init( &broadcastLock, 0 );
+  pthread_cond_init( &broadcastDone, 0 );
+#if !LS_HAVE_THREAD_LOCAL
+  pthread_once( &CurrentWorkerOnce, CreateCurrentWorker );
+#endif
+  
+  for( unsigned int i = 0 ; i < threadCount ; i++ ) {
+    Queue * queue = new Queue;
+    pthread_mutex_init( &queue->lock, 0 );
+    queue->head = queue->tail = 0;
+    queues.push_back( queue );
+  }
+  
+  // queue 0 belongs to the calling thread(s), start workers for the rest
+  threads.resize( threadCount - 1 );
+  for( unsigned int i = 1 ; i < threadCount ; i++ ) {
+    WorkerStart * start = new WorkerStart;
+    start->pool = this;
+    start->index = i;
+    int result = pthread_create( &threads[i - 1], 0, WorkerMain, start );
+    assert_user( result == 0, "Could not create a worker thread!" );
+  }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+  pthread_mutex_lock( &sleepLock );
+  stopping = true;
+  pthread_cond_broadcast( &wakeup );
+  pthread_mutex_unlock( &sleepLock );
+  
+  for( unsigned int i = 0 ; i < threads.size() ; i++ ) {
+    pthread_join( threads[i], 0 );
+  }
+  
+  for( unsigned int i = 0 ; i < queues.size() ; i++ ) {
+    pthread_mutex_destroy( &queues[i]->lock );
+    delete queues[i];
+  }
+  pthread_cond_destroy( &broadcastDone );
+  pthread_mutex_destroy( &broadcastLock );
+  pthread_cond_destroy( &wakeup );
+  pthread_mutex_destroy( &sleepLock );
+}
+
+
+
+
+void ThreadPool::parallelFor( RangeFunction function, void * context,
+                              unsigned int begin, unsigned int end,
+                              unsigned int grain )
+{
+  assert( grain > 0 );
+  if( begin >= end ) return;
+  
+  // single-threaded: just walk through the range
+  if( threadCount == 1 ) {
+    for( unsigned int i = begin ; i < end ; i += grain ) {
+      function( context, i, min( i + grain, end ) );
+    }
+    return;
+  }
+  
+  unsigned int self = currentThread();
+  Group group = { 1 };
+  Task root = { function, context, begin, end, grain, &group };
+  execute( self, root );
+  
+  // help with any work until our group is done
+  Task task;
+  while( LS_FETCH_AND_ADD( &group.pending, 0 ) > 0 ) {
+    if( findTask( self, task ) ) execute( self, task );
+    else sched_yield();
+  }
+}
+
+
+void ThreadPool::runOnEachThread( ThreadFunction function )
+{
+  function();
+  if( threadCount == 1 ) return;
+  
+  // one call at a time
+  pthread_mutex_lock( &broadcastLock );
+  pthread_mutex_lock( &sleepLock );
+  broadcast = function;
+  broadcastPending = threadCount - 1;
+  broadcastGeneration++;
+  pthread_cond_broadcast( &wakeup );
+  while( broadcastPending > 0 ) {
+    pthread_cond_wait( &broadcastDone, &sleepLock );
+  }
+  pthread_mutex_unlock( &sleepLock );
+  pthread_mutex_unlock( &broadcastLock );
+}
+
+
+unsigned int ThreadPool::HardwareThreads()
+{
+  long count = sysconf( _SC_NPROCESSORS_ONLN );
+  return count > 0 ? count : 1;
+}
+
+
+
+
+unsigned int ThreadPool::currentThread() const
+{
+#if LS_HAVE_THREAD_LOCAL
+  return CurrentPool == this ? CurrentIndex : 0;
+#else
+  const WorkerStart * worker =
+    static_cast<const WorkerStart *>( pthread_getspecific( CurrentWorker ) );
+  return worker && worker->pool == this ? worker->index : 0;
+#endif
+}
+
+
+bool ThreadPool::push( unsigned int self, const Task & task )
+{
+  Queue & queue = *queues[self];
+  
+  pthread_mutex_lock( &queue.lock );
+  bool full = queue.tail - queue.head == QueueSize;
+  if( !full ) {
+    queue.tasks[queue.tail % QueueSize] = task;
+    queue.tail++;
+  }
+  pthread_mutex_unlock( &queue.lock );
+  
+  // wake up sleeping workers (the atomic read is a full barrier, see
+  // workerLoop())
+  if( !full && LS_FETCH_AND_ADD( &sleeping, 0 ) > 0 ) {
+    pthread_mutex_lock( &sleepLock );
+    pthread_cond_broadcast( &wakeup );
+    pthread_mutex_unlock( &sleepLock );
+  }
+  
+  return !full;
+}
+
+
+bool ThreadPool::pop( unsigned int self, Task & task )
+{
+  Queue & queue = *queues[self];
+  
+  pthread_mutex_lock( &queue.lock );
+  bool found = queue.tail != queue.head;
+  if( found ) {
+    queue.tail--;
+    task = queue.tasks[queue.tail % QueueSize];
+  }
+  pthread_mutex_unlock( &queue.lock );
+  
+  return found;
+}
+
+
+bool ThreadPool::steal( unsigned int self, Task & task )
+{
+  for( unsigned int i = 1 ; i < threadCount ; i++ ) {
+    Queue & queue = *queues[(self + i) % threadCount];
+    
+    // peek without locking first, most queues are usually empty
+    if( queue.tail == queue.head ) continue;
+    
+    pthread_mutex_lock( &queue.lock );
+    bool found = queue.tail != queue.head;
+    if( found ) {
+      task = queue.tasks[queue.head % QueueSize];
+      queue.head++;
+    }
+    pthread_mutex_unlock( &queue.lock );
+    
+    if( found ) return true;
+  }
+  return false;
+}
+
+
+bool ThreadPool::findTask( unsigned int self, Task & task )
+{
+  return pop( self, task ) || steal( self, task );
+}
+
+
+void ThreadPool::execute( unsigned int self, Task task )
+{
+  // split off upper halves for other threads until the task is small enough
+  while( task.end - task.begin > task.grain ) {
+    Task upper = task;
+    upper.begin = task.begin + (task.end - task.begin) / 2;
+    
+    LS_FETCH_AND_ADD( &task.group->pending, 1 );
+    if( !push( self, upper ) ) {
+      // queue full: process the rest here
+      LS_FETCH_AND_ADD( &task.group->pending, -1 );
+      break;
+    }
+    task.end = upper.begin;
+  }
+  
+  task.function( task.context, task.begin, task.end );
+  LS_FETCH_AND_ADD( &task.group->pending, -1 );
+}
+
+
+void ThreadPool::runBroadcast( unsigned int & generation )
+{
+  pthread_mutex_lock( &sleepLock );
+  ThreadFunction function = broadcast;
+  generation = broadcastGeneration;
+  pthread_mutex_unlock( &sleepLock );
+  
+  function();
+  
+  pthread_mutex_lock( &sleepLock );
+  if( --broadcastPending == 0 ) pthread_cond_signal( &broadcastDone );
+  pthread_mutex_unlock( &sleepLock );
+}
+
+
+void ThreadPool::workerLoop( unsigned int self )
+{
+  Task task;
+  unsigned int idle = 0;
+  unsigned int generation = 0;
+  
+  while( !stopping ) {
+    if( broadcastGeneration != generation ) {
+      runBroadcast( generation );
+      continue;
+    }
+    
+    if( findTask( self, task ) ) {
+      execute( self, task );
+      idle = 0;
+      continue;
+    }
+    
+    if( ++idle < SpinCount ) {
+      sched_yield();
+      continue;
+    }
+    
+    // go to sleep. Announce it before the final check, so that push() either
+    // sees the announcement or we see its task.
+    pthread_mutex_lock( &sleepLock );
+    LS_FETCH_AND_ADD( &sleeping, 1 );
+    bool found = findTask( self, task );
+    if( !found && !stopping && broadcastGeneration == generation ) {
+      pthread_cond_wait( &wakeup, &sleepLock );
+    }
+    LS_FETCH_AND_ADD( &sleeping, -1 );
+    pthread_mutex_unlock( &sleepLock );
+    
+    if( found ) execute( self, task );
+    idle = 0;
+  }
+}
+
+
+void * ThreadPool::WorkerMain( void * argument )
+{
+  WorkerStart start = *static_cast<WorkerStart *>( argument );
+  delete static_cast<WorkerStart *>( argument );
+  
+#if LS_HAVE_THREAD_LOCAL
+  CurrentPool = start.pool;
+  CurrentIndex = start.index;
+#else
+  pthread_setspecific( CurrentWorker, &start );
+#endif
+  start.pool->workerLoop( start.index );
+  return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2004-2005 Paul J. Wagner
+ * This file is part of the Lifespace Simulator.
+ * 
+ * Lifespace Simulator is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * Lifespace Simulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Lifespace Simulator; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ * For more information about the program:
+ *   http://www.cis.hut.fi/pwagner/lifespace/
+ */
+
+
+/**
+ * @file ThreadPool.hpp
+ *
+ * A work-stealing thread pool for parallel loops.
+ */
+
+/**
+ * @class lifespace::ThreadPool
+ * @ingroup Utility
+ *
+ * @brief
+ * A work-stealing thread pool for parallel loops.
+ *
+ * parallelFor() splits an index range recursively in halves down to a given
+ * grain size. Each thread keeps the pieces it has split off in its own task
+ * queue and works on them from the newest end, and idle threads steal the
+ * oldest (largest) pieces from the other queues. The calling thread takes
+ * part in the work and returns when the whole range has been processed.
+ *
+ * parallelFor() may be called from within a running range function (nested
+ * parallelism). The inner loop is then executed by the same pool, and the
+ * calling worker keeps processing tasks while it waits for the inner loop to
+ * finish.
+ *
+ * A pool with a thread count of one runs everything on the calling thread
+ * and never starts any threads.
+ */
+#ifndef LS_U_THREADPOOL_HPP
+#define LS_U_THREADPOOL_HPP
+
+
+#include "../types.hpp"
+#include <boost/utility.hpp>
+#include <vector>
+#include <pthread.h>
+
+
+namespace lifespace {
+  
+  
+  
+  
+  class ThreadPool :
+    private boost::noncopyable
+  {
+  public:
+    
+    /** A function that processes the indices [begin, end). */
+    typedef void (* RangeFunction)( void * context,
+                                    unsigned int begin, unsigned int end );
+    
+    /** A function that is run once on a thread, see runOnEachThread(). */
+    typedef void (* ThreadFunction)();
+    
+    
+  private:
+    
+    /** Completion counter of a parallelFor() call. */
+    struct Group {
+      volatile int pending;
+    };
+    
+    struct Task {
+      RangeFunction function;
+      void * context;
+      unsigned int begin, end, grain;
+      Group * group;
+    };
+    
+    /** Maximum number of queued tasks per thread. Tasks that do not fit are
+        executed directly. */
+    static const unsigned int QueueSize = 256;
+    
+    /** A task queue (ring buffer). The owner pushes and pops at the tail,
+        thieves take from the head. */
+    struct Queue {
+      pthread_mutex_t lock;
+      Task tasks[QueueSize];
+      unsigned int head, tail;
+    };
+    
+    unsigned int threadCount;
+    std::vector<Queue *> queues;
+    std::vector<pthread_t> threads;
+    
+    /** Sleeping workers wait on this when there is no work. */
+    pthread_mutex_t sleepLock;
+    pthread_cond_t wakeup;
+    volatile int sleeping;
+    volatile bool stopping;
+    
+    /** The current runOnEachThread() call: the workers run the function
+        when they see a new generation. Protected by sleepLock. */
+    pthread_mutex_t broadcastLock;
+    pthread_cond_t broadcastDone;
+    ThreadFunction broadcast;
+    volatile unsigned int broadcastGeneration;
+    unsigned int broadcastPending;
+    
+    
+    bool push( unsigned int self, const Task & task );
+    bool pop( unsigned int self, Task & task );
+    bool steal( unsigned int self, Task & task );
+    bool findTask( unsigned int self, Task & task );
+    void execute( unsigned int self, Task task );
+    unsigned int currentThread() const;
+    void workerLoop( unsigned int self );
+    void runBroadcast( unsigned int & generation );
+    
+    static void * WorkerMain( void * argument );
+    
+    
+  public:
+    
+    /**
+     * Creates a pool with the given total number of threads, including the
+     * calling thread (so threadCount - 1 worker threads are started). Zero
+     * selects the number of online processors.
+     */
+    explicit ThreadPool( unsigned int threadCount = 0 );
+    
+    /** Stops and joins the worker threads. */
+    ~ThreadPool();
+    
+    /** Returns the total number of threads, including the calling thread. */
+    unsigned int getThreadCount() const
+    { return threadCount; }
+    
+    /**
+     * Calls function( context, b, e ) for disjoint subranges [b, e) covering
+     * [begin, end), in parallel. Subranges are at most grain indices long
+     * (grain must be positive). Returns when all subranges have been
+     * processed.
+     */
+    void parallelFor( RangeFunction function, void * context,
+                      unsigned int begin, unsigned int end,
+                      unsigned int grain = 1 );
+    
+    /**
+     * Calls the function once on each worker thread and on the calling
+     * thread, and returns when all of them have done so. For initializing
+     * per-thread state, such as the per-thread data of ODE. Must not be
+     * called from within a range function.
+     */
+    void runOnEachThread( ThreadFunction function );
+    
+    /** Returns the number of online processors (at least one). */
+    static unsigned int HardwareThreads();
+  };
+  
+  
+  
+  
+}   /* namespace lifespace */
+
+
+#endif   /* LS_U_THREADPOOL_HPP */
@@ -38,9 +38,14 @@
 
 #include "../types.hpp"
 #include "Event.hpp"
+#include "HandleVector.hpp"
+#include "SymbolTable.hpp"
+#include "Pool.hpp"
+#include "ThreadPool.hpp"
 #include "Geometry.hpp"
 #include "BasicGeometry.hpp"
 #include "CollisionMaterial.hpp"
+#include "CollisionLayers.hpp"
 #include "Contact.hpp"
 #include "shapes.hpp"
 
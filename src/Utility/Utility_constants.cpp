@@ -25,6 +25,7 @@
  */
 #include "../types.hpp"
 #include "shapes.hpp"
+#include "CollisionLayers.hpp"
 using namespace lifespace;
 
 
@@ -34,3 +35,9 @@ using namespace lifespace;
 const float shapes::Basis::THICKNESS_X = 0.2;
 const float shapes::Basis::THICKNESS_Y = 0.1;
 const float shapes::Basis::THICKNESS_Z = 0.1;
+
+
+/* CollisionLayers */
+const CollisionLayers::Mask CollisionLayers::All;
+const CollisionLayers::Mask CollisionLayers::None;
+const unsigned int CollisionLayers::MaxLayers;
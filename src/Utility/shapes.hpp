@@ -56,7 +56,9 @@
 #include "../Structures/BasisMatrix.hpp"
 #include "../Structures/Locator.hpp"
 #include "../Structures/BasicLocator.hpp"
+#include "Pool.hpp"
 #include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
 
 #include <list>
 
@@ -110,7 +112,9 @@ namespace shapes {
     {}
     
     static boost::shared_ptr<Sphere> create( real radius = 1.0 )
-    { return boost::shared_ptr<Sphere>( new Sphere( radius ) ); }
+    {
+      return boost::allocate_shared<Sphere>( PoolAllocator<Sphere>(), radius );
+    }
   };
 
 
@@ -134,7 +138,7 @@ namespace shapes {
     
     static boost::shared_ptr<Cube>
     create( const Vector & size = makeVector3d( 2.0, 2.0, 2.0 ) )
-    { return boost::shared_ptr<Cube>( new Cube( size ) ); }
+    { return boost::allocate_shared<Cube>( PoolAllocator<Cube>(), size ); }
   };
   
   
@@ -163,8 +167,8 @@ namespace shapes {
     static boost::shared_ptr<CappedCylinder>
     create( real length = 2.0, real radius = 1.0 )
     {
-      return boost::shared_ptr<CappedCylinder>
-        ( new CappedCylinder( length, radius ) );
+      return boost::allocate_shared<CappedCylinder>
+        ( PoolAllocator<CappedCylinder>(), length, radius );
     }
   };
   
@@ -193,7 +197,10 @@ namespace shapes {
 
     static boost::shared_ptr<Scaled>
     create( const Vector & scale, boost::shared_ptr<Shape> target )
-    { return boost::shared_ptr<Scaled>( new Scaled( scale, target ) ); }
+    {
+      return boost::allocate_shared<Scaled>
+        ( PoolAllocator<Scaled>(), scale, target );
+    }
   };
   
   
@@ -216,7 +223,10 @@ namespace shapes {
     
     static boost::shared_ptr<Located>
     create( const BasicLocator & location, boost::shared_ptr<Shape> target )
-    { return boost::shared_ptr<Located>( new Located( location, target ) ); }
+    {
+      return boost::allocate_shared<Located>
+        ( PoolAllocator<Located>(), location, target );
+    }
   };
   
   
@@ -236,7 +246,10 @@ namespace shapes {
     
     static boost::shared_ptr<Precomputed>
     create( boost::shared_ptr<Shape> target )
-    { return boost::shared_ptr<Precomputed>( new Precomputed( target ) ); }
+    {
+      return boost::allocate_shared<Precomputed>
+        ( PoolAllocator<Precomputed>(), target );
+    }
   };
   
   
@@ -370,7 +383,7 @@ namespace shapes {
     {}
     
     static boost::shared_ptr<Basis> create()
-    { return boost::shared_ptr<Basis>( new Basis() ); }
+    { return boost::allocate_shared<Basis>( PoolAllocator<Basis>() ); }
   };
   
   
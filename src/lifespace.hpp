@@ -92,6 +92,7 @@
 #include "Content/Content.hpp"
 #include "Integrators/Integrators.hpp"
 #include "Renderers/Renderers.hpp"
+#include "Simulation/Simulation.hpp"
 
 
 
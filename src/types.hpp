@@ -94,6 +94,44 @@ namespace types_hpp_static_asserts {
 #endif
 
 
+/*
+ * The thread-local storage class specifier, if the compiler has one (defined
+ * as empty otherwise). LS_HAVE_THREAD_LOCAL tells whether it is available, so
+ * that code using it can provide a locking fallback. Define LS_NO_THREAD_LOCAL
+ * to force the fallback.
+ */
+
+#if defined(__GNUC__) && !defined(LS_NO_THREAD_LOCAL)
+#define LS_HAVE_THREAD_LOCAL 1
+#define LS_THREAD_LOCAL __thread
+#else
+#define LS_HAVE_THREAD_LOCAL 0
+#define LS_THREAD_LOCAL
+#endif
+
+
+/*
+ * Atomic fetch-and-add on an int, returning the old value and acting as a
+ * full memory barrier. Without the GCC builtins (or with LS_NO_ATOMICS
+ * defined), falls back to lifespace::LockedFetchAndAdd(), which serializes
+ * all the operations with a global mutex (defined in ThreadPool.cpp).
+ */
+
+#if defined(__GNUC__) && !defined(LS_NO_ATOMICS)
+#define LS_HAVE_ATOMICS 1
+#define LS_FETCH_AND_ADD( target, value ) \
+  __sync_fetch_and_add( (target), (value) )
+#else
+#define LS_HAVE_ATOMICS 0
+#define LS_FETCH_AND_ADD( target, value ) \
+  lifespace::LockedFetchAndAdd( (target), (value) )
+namespace lifespace {
+  int LockedFetchAndAdd( volatile int * target, int value );
+}
+#endif
+
+
+
 /*
  * Define some debugging macros
  *
@@ -0,0 +1,329 @@
+/**
+ * @file main.cpp
+ *
+ * A warehouse of crates with InertiaLocators, of which only a given
+ * percentage is moving. Measures the timestep cost with a BasicIntegrator and
+ * with an ActiveSetIntegrator, and checks that sleeping crates are skipped and
+ * that they are woken up by forces, controls and contacts. Also checks that a
+ * sleeping ODE body pushed through an existing contact is woken up.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <ode/ode.h>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::atoi;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int measureSteps = 50;
+static const real dt = 0.01;
+
+static bool passed = true;
+
+
+static void check( bool condition, const char * what )
+{
+  if( !condition ) {
+    cout << "FAILED: " << what << endl;
+    passed = false;
+  }
+}
+
+
+
+
+/** A crate that counts its prepare calls and has a single push control. */
+class Crate :
+  public Actor,
+  public Object
+{
+public:
+  enum { CTRL_PUSH };
+  
+  int prepares;
+  
+  Crate( const Vector & loc ) :
+    Actor( 1, 0 ),
+    Object( Object::Params( new InertiaLocator( loc ), 0, new Geometry ) ),
+    prepares( 0 )
+  {
+    setAutoSleep( true );
+  }
+  
+  virtual void prepare( real dt )
+  {
+    prepares++;
+    real push = readControl( CTRL_PUSH );
+    if( push != 0.0 ) {
+      getLocator()->addForceAbs( makeVector3d( push, 0.0, 0.0 ) );
+    }
+    Object::prepare( dt );
+  }
+  
+  void stop()
+  {
+    getLocator()->setVel( makeVector3d( 0.0, 0.0, 0.0 ) );
+  }
+};
+
+
+
+
+static Subspace::Params worldParams( Integrator * integrator )
+{
+  return Subspace::Params( Object::Params(),
+                           shared_ptr<Environment>(),
+                           shared_ptr<Integrator>( integrator ) );
+}
+
+
+/** Checks the wake and sleep transitions. */
+static void testTransitions()
+{
+  ActiveSetIntegrator * integrator = new ActiveSetIntegrator;
+  World world( worldParams( integrator ) );
+  
+  shared_ptr<Crate> a( new Crate( makeVector3d( 0.0, 0.0, 0.0 ) ) );
+  shared_ptr<Crate> b( new Crate( makeVector3d( 5.0, 0.0, 0.0 ) ) );
+  world.addObject( a );
+  world.addObject( b );
+  check( a->isAwake() && b->isAwake(), "added objects are awake" );
+  check( integrator->getActiveCount() == 2, "two active after add" );
+  
+  world.timestep( dt );
+  check( !a->isAwake() && !b->isAwake(), "resting objects fall asleep" );
+  check( integrator->getActiveCount() == 0, "no active after rest" );
+  
+  world.timestep( dt );
+  check( a->prepares == 1 && b->prepares == 1,
+         "sleeping objects are not prepared" );
+  
+  // force
+  a->getLocator()->addForceAbs( makeVector3d( 1.0, 0.0, 0.0 ) );
+  check( a->isAwake() && integrator->getActiveCount() == 1,
+         "force wakes the object" );
+  world.timestep( dt );
+  check( a->prepares == 2 && a->isAwake(), "woken object is processed" );
+  a->stop();
+  world.timestep( dt );
+  check( !a->isAwake(), "stopped object falls asleep" );
+  
+  // control
+  b->useControl( Crate::CTRL_PUSH, 1.0 );
+  check( b->isAwake(), "control wakes the object" );
+  world.timestep( dt );
+  check( b->isAwake(), "pushed object moves" );
+  b->useControl( Crate::CTRL_PUSH, 0.0 );
+  b->stop();
+  world.timestep( dt );
+  check( !b->isAwake(), "released object falls asleep" );
+  
+  // contact with an awake object, and no wake-up between sleeping objects
+  {
+    Contact sleeping( a->getGeometry().get(), b->getGeometry().get() );
+    check( !a->isAwake() && !b->isAwake(),
+           "contact between sleeping objects wakes neither" );
+  }
+  a->wake();
+  {
+    Contact touching( a->getGeometry().get(), b->getGeometry().get() );
+    check( b->isAwake(), "contact with an awake object wakes the object" );
+  }
+  world.timestep( dt );
+  check( integrator->getActiveCount() == 0, "contacted objects rest again" );
+  
+  // removal of a sleeping and of an awake object
+  world.removeObject( a );
+  b->wake();
+  world.removeObject( b );
+  world.timestep( dt );
+  check( integrator->getActiveCount() == 0, "removed objects are dropped" );
+}
+
+
+
+
+/** Creates a ball with an ODELocator that may fall asleep. */
+static shared_ptr<Object> makeBall( const Vector & loc,
+                                    shared_ptr<CollisionMaterial> material )
+{
+  shared_ptr<Object> ball
+    ( new Object
+      ( Object::Params
+        ( new ODELocator( loc ), 0,
+          new BasicGeometry( shapes::Sphere::create( 0.5 ), material ))));
+  ball->setAutoSleep( true );
+  return ball;
+}
+
+
+/**
+ * Checks that a sleeping ball pushed by an awake one through an existing
+ * contact is woken, and that its locator follows its ODE body: ODE enables
+ * the body on its own, without a new Contact being created. Also checks
+ * that restoring a checkpoint wakes the hosts or puts them to sleep with
+ * their bodies.
+ */
+static void testExistingContact()
+{
+  shared_ptr<CollisionMaterial> material
+    ( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+  
+  ODEWorld::SolverParams solverParams;
+  solverParams.autoDisable = true;
+  ODEWorld world( worldParams( new ActiveSetIntegrator ), solverParams );
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 100.0, 1.0, 100.0 ) ),
+                             material ))));
+  shared_ptr<Object> pusher =
+    makeBall( makeVector3d( 0.0, 0.5, 0.0 ), material );
+  shared_ptr<Object> pushed =
+    makeBall( makeVector3d( 1.0, 0.5, 0.0 ), material );
+  world.addObject( ground );
+  world.addObject( pusher );
+  world.addObject( pushed );
+  world.activate( true );
+  collisionRenderer.connect();
+  
+  // let the balls come to rest
+  for( int i = 0 ; i < 1000 && (pusher->isAwake() || pushed->isAwake()) ;
+       i++ ) {
+    collisionRenderer.render();
+    world.timestep( dt );
+  }
+  check( !pusher->isAwake() && !pushed->isAwake(), "resting balls sleep" );
+  
+  collisionRenderer.render();
+  const Geometry::contacts_t contacts = pushed->getGeometry()->getContacts();
+  check( contacts.find( pusher->getGeometry().get() ) != contacts.end(),
+         "sleeping balls keep their contact" );
+    ODEWorld::Checkpoint resting;
+  collisionRenderer.checkpoint( resting );
+  
+  // push through the existing contact
+  for( int i = 0 ; i < 20 ; i++ ) {
+    pusher->getLocator()->addForceAbs( makeVector3d( 200.0, 0.0, 0.0 ) );
+    collisionRenderer.render();
+    world.timestep( dt );
+  }
+  check( pushed->isAwake(), "a ball pushed through a contact wakes" );
+  
+  const dReal * position = dBodyGetPosition
+    ( dynamic_cast<ODELocator &>( *pushed->getLocator() ).getODEBodyId() );
+  check( pushed->getLocator()->getLoc()(0) == position[0] &&
+         pushed->getLocator()->getLoc()(0) > 1.1,
+         "the locator of a pushed ball follows its body" );
+  
+  // restore the resting state and back
+  ODEWorld::Checkpoint pushing;
+  collisionRenderer.checkpoint( pushing );
+  collisionRenderer.restore( resting );
+  check( !pusher->isAwake() && !pushed->isAwake(),
+         "restoring a resting state puts the balls to sleep" );
+  collisionRenderer.restore( pushing );
+  check( pusher->isAwake() && pushed->isAwake(),
+         "restoring a moving state wakes the balls" );
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  world.removeObject( pushed );
+  world.removeObject( pusher );
+  world.removeObject( ground );
+}
+
+
+
+
+/** Runs the warehouse benchmark, returns the average timestep time. */
+static double run( bool activeSet, int count, int movingPercent,
+                   unsigned int & activeCount )
+{
+  Integrator * integrator;
+  if( activeSet ) integrator = new ActiveSetIntegrator;
+  else integrator = new BasicIntegrator;
+  
+  World world( worldParams( integrator ) );
+  
+  vector< shared_ptr<Crate> > crates;
+  for( int i = 0 ; i < count ; i++ ) {
+    crates.push_back
+      ( shared_ptr<Crate>
+        ( new Crate( makeVector3d( i % 100, 0.0, i / 100 ) )));
+    world.addObject( crates.back() );
+    if( i % 100 < movingPercent ) {
+      crates.back()->getLocator()->setVel( makeVector3d( 0.0, 0.1, 0.0 ) );
+    }
+  }
+  
+  // let the static crates fall asleep
+  world.timestep( dt );
+  
+  double t0 = WallTime();
+  for( int i = 0 ; i < measureSteps ; i++ ) world.timestep( dt );
+  double time = (WallTime() - t0) / measureSteps;
+  
+  activeCount = 0;
+  for( int i = 0 ; i < count ; i++ ) {
+    if( crates[i]->isAwake() ) activeCount++;
+    world.removeObject( crates[i] );
+  }
+  
+  return time;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  if( argc != 3 ) Usage( argv, "<crate count> <moving percentage>" );
+  int count         = atoi( argv[1] );
+  int movingPercent = atoi( argv[2] );
+  
+  testTransitions();
+  testExistingContact();
+  
+  unsigned int basicActive, activeSetActive;
+  double basicTime = run( false, count, movingPercent, basicActive );
+  double activeSetTime = run( true, count, movingPercent, activeSetActive );
+  
+  printf( "crates: %d, moving: %d%%\n", count, movingPercent );
+  printf( "BasicIntegrator:     %9.3f ms/step, %u awake\n",
+          1e3 * basicTime, basicActive );
+  printf( "ActiveSetIntegrator: %9.3f ms/step, %u awake (speedup %.2f)\n",
+          1e3 * activeSetTime, activeSetActive, basicTime / activeSetTime );
+  
+  check( activeSetActive == (unsigned int)( (count / 100) * movingPercent +
+                                            std::min( count % 100,
+                                                      movingPercent ) ),
+         "only the moving crates are awake" );
+  
+  return Finish( passed );
+}
@@ -0,0 +1,255 @@
+/**
+ * @file main.cpp
+ *
+ * Counts the heap allocations made per World::timestep() with different
+ * locator types. All allocations through the global operator new are
+ * counted (ODE allocates its own memory with malloc, so it is not included).
+ * Also checks that the pooled blocks left by an exited thread are reused.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include <ode/ode.h>
+#include <ode/odecpp.h>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::malloc;
+using std::free;
+using std::atoi;
+
+#include <cstring>
+using std::strcmp;
+
+#include <new>
+
+#include <pthread.h>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <boost/timer.hpp>
+using boost::timer;
+
+
+
+
+/* allocation counting */
+
+static unsigned long allocCount = 0;
+
+void * operator new( std::size_t size ) throw( std::bad_alloc )
+{
+  allocCount++;
+  void * p = malloc( size ? size : 1 );
+  if( !p ) throw std::bad_alloc();
+  return p;
+}
+
+void * operator new[]( std::size_t size ) throw( std::bad_alloc )
+{ return operator new( size ); }
+
+void operator delete( void * p ) throw()
+{ free( p ); }
+
+void operator delete[]( void * p ) throw()
+{ free( p ); }
+
+
+
+
+
+
+
+
+static Locator * makeLocator( const char * type, const Vector & loc )
+{
+  if( 0 == strcmp( type, "inertia" ) ) {
+    InertiaLocator * result = new InertiaLocator( loc );
+    result->setRotation( makeVector3d( 0.0, 1.0, 0.0 ) );
+    return result;
+  } else if( 0 == strcmp( type, "motion" ) ) {
+    MotionLocator * result = new MotionLocator( loc );
+    result->setVel( makeVector3d( 0.1, 0.0, 0.0 ) );
+    result->setRotation( makeVector3d( 0.0, 1.0, 0.0 ) );
+    return result;
+  } else if( 0 == strcmp( type, "ode" ) ) {
+    return new ODELocator( loc );
+  }
+  
+  cout << "unknown locator type: " << type << endl;
+  exit(1);
+}
+
+
+
+/* Allocates and frees pooled blocks in a thread of its own, leaving them in
+   the thread's free list when it exits. */
+static const int threadBlocks = 640;
+typedef FixedPool<1000> ThreadTestPool;
+
+static void * poolThread( void * )
+{
+  void * blocks[threadBlocks];
+  for( int i = 0 ; i < threadBlocks ; i++ ) {
+    blocks[i] = ThreadTestPool::Allocate();
+  }
+  for( int i = 0 ; i < threadBlocks ; i++ ) {
+    ThreadTestPool::Deallocate( blocks[i] );
+  }
+  return 0;
+}
+
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  if( argc != 3 ) {
+    cout << "Usage: " << argv[0]
+         << " <object count> [inertia|motion|ode]" << endl;
+    exit(1);
+  }
+  int count        = atoi( argv[1] );
+  const char * type = argv[2];
+  
+  cout << "objects: " << count << ", locator type: " << type << endl;
+  
+  
+  // world
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ));
+  
+  // objects
+  for( int i = 0 ; i < count ; i++ ) {
+    world.addObject
+      ( shared_ptr<Object>
+        ( new Object
+          ( Object::Params( makeLocator( type,
+                                         makeVector3d( i % 100,
+                                                       i / 10000,
+                                                       (i / 100) % 100 ))))));
+  }
+  
+  // activate the world
+  world.activate( true );
+  
+  // warm up (lazy initializations etc.)
+  for( int i = 0 ; i < 10 ; i++ ) world.timestep( 0.01 );
+  
+  
+  
+  
+  // measure
+  
+  int iter = 0;
+  unsigned long allocs = allocCount;
+  timer t;
+  
+  do {
+    world.timestep( 0.01 );
+    iter++;
+  } while( iter % 10 || t.elapsed() < 4.0 );
+  double elapsed = t.elapsed();
+  allocs = allocCount - allocs;
+  
+  printf( "world.timestep():           %.9f s/iteration (%10.f iterations/s)\n",
+          elapsed / iter, iter / elapsed );
+  printf( "allocations:                %.3f /step, %.3f /step/object\n",
+          (double)allocs / iter, (double)allocs / iter / count );
+  
+  
+  // locator math on the stack
+  
+  const shared_ptr<Object> & object = world.getObjects().front();
+  Vector v( makeVector3d( 1.0, 2.0, 3.0 ) );
+  BasicLocator l( makeVector3d( 1.0, 0.0, 0.0 ) );
+  real sum = 0.0;
+  
+  iter = 0; allocs = allocCount;
+  do {
+    object->getLocator()->transform( v, Rel2Abs );
+    object->getLocator()->transform( v, Abs2Rel );
+    object->getLocator()->transform( l, Rel2Abs );
+    object->getLocator()->transform( l, Abs2Rel );
+    sum += norm_1( crossProduct( normalized( v ),
+                                 projection( v, l.getLoc() )));
+    iter++;
+  } while( iter < 100000 );
+  allocs = allocCount - allocs;
+  
+  printf( "locator transforms:         %.3f allocations/iteration (%g)\n",
+          (double)allocs / iter, sum );
+  
+  
+  // world locator queries (cached between modifications)
+  
+  iter = 0; allocs = allocCount;
+  do {
+    sum += object->getWorldLocator()->getLoc()(0);
+    iter++;
+  } while( iter < 100000 );
+  allocs = allocCount - allocs;
+  
+  printf( "getWorldLocator():          %.3f allocations/iteration\n",
+          (double)allocs / iter );
+  
+  
+  // the cached transforms of a nested object follow only its own host chain
+  
+  shared_ptr<Subspace> subspace
+    ( new Subspace( Object::Params
+                    ( new BasicLocator( makeVector3d( 10.0, 0.0, 0.0 ))) ));
+  shared_ptr<Object> nested
+    ( new Object( Object::Params
+                  ( new BasicLocator( makeVector3d( 1.0, 0.0, 0.0 ))) ));
+  world.addObject( subspace );
+  subspace->addObject( nested );
+  
+  real before = nested->getWorldLocator()->getLoc()(0);
+  unsigned long stamp = subspace->getWorldTransformStamp();
+  world.timestep( 0.01 );
+  bool unaffected = subspace->getWorldTransformStamp() == stamp;
+  subspace->getLocator()->setLoc( makeVector3d( 20.0, 0.0, 0.0 ) );
+  real after = nested->getWorldLocator()->getLoc()(0);
+  bool followed = before == 11.0 && after == 21.0;
+  
+  printf( "nested world locator:       %s, %s\n",
+          unaffected ? "not invalidated by a step" : "INVALIDATED BY A STEP",
+          followed ? "follows its host" : "DOES NOT FOLLOW ITS HOST" );
+  
+  subspace->removeObject( nested );
+  world.removeObject( subspace );
+  
+  
+  // the blocks freed by an exited thread are reused by the other threads
+  
+  pthread_t thread;
+  pthread_create( &thread, 0, poolThread, 0 );
+  pthread_join( thread, 0 );
+  allocs = allocCount;
+  void * blocks[threadBlocks];
+  for( int i = 0 ; i < threadBlocks ; i++ ) {
+    blocks[i] = ThreadTestPool::Allocate();
+  }
+  for( int i = 0 ; i < threadBlocks ; i++ ) {
+    ThreadTestPool::Deallocate( blocks[i] );
+  }
+  allocs = allocCount - allocs;
+  bool reused = allocs == 0;
+  
+  printf( "pool after thread exit:     %lu allocations (%s)\n",
+          allocs, reused ? "blocks reused" : "BLOCKS LEAKED" );
+  
+  world.activate( false );
+  
+  return unaffected && followed && reused ? 0 : 1;
+}
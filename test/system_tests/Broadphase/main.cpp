@@ -0,0 +1,122 @@
+/**
+ * @file main.cpp
+ *
+ * Measures the per-tick cost of ODECollisionRenderer::render() with each
+ * broadphase, for 100 to 20000 boxes resting in a grid on the ground (the
+ * largest count can be limited from the command line).
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <cstdio>
+using std::printf;
+using std::fflush;
+
+#include <cmath>
+using std::sqrt;
+using std::ceil;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int counts[] = { 100, 500, 1000, 5000, 20000 };
+static const int ticks = 5;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+/** Returns the average time of render() in seconds. */
+static double measure( int boxCount, Collider::Broadphase broadphase )
+{
+  int side = (int)ceil( sqrt( (double)boxCount ) );
+  real extent = side + 1.0;
+  
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  
+  Collider::BroadphaseParams params;
+  params.broadphase = broadphase;
+  params.quadtreeCenter = makeVector3d( extent, 0.0, extent );
+  params.quadtreeExtents = makeVector3d( extent, 10.0, extent );
+  ODECollisionRenderer collisionRenderer( &world, params );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( extent, -0.5, extent ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 2.0 * extent, 1.0,
+                                             2.0 * extent ) ),
+                             material ))));
+  world.addObject( ground );
+  
+  vector< shared_ptr<Object> > boxes;
+  for( int i = 0 ; i < boxCount ; i++ ) {
+    shared_ptr<Object> box
+      ( new Object
+        ( Object::Params
+          ( new ODELocator( makeVector3d( 2.0 * (i % side) + 1.0, 0.5,
+                                          2.0 * (i / side) + 1.0 ) ), 0,
+            new BasicGeometry( shapes::Cube::create
+                               ( makeVector3d( 1.0, 1.0, 1.0 ) ),
+                               material ))));
+    world.addObject( box );
+    boxes.push_back( box );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  collisionRenderer.render();
+  world.timestep( dt );
+  
+  Stopwatch collision;
+  for( int i = 0 ; i < ticks ; i++ ) {
+    collision.start();
+    collisionRenderer.render();
+    collision.stop();
+    world.timestep( dt );
+  }
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < boxes.size() ; i++ ) {
+    world.removeObject( boxes[i] );
+  }
+  world.removeObject( ground );
+  
+  return collision.getTotal() / ticks;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int maxCount = CountArgument( argc, argv, "[max geom count]", 20000 );
+  
+  printf( "%8s %12s %12s %12s %12s\n",
+          "geoms", "simple", "hash", "sap", "quadtree" );
+  for( unsigned int i = 0 ; i < sizeof(counts) / sizeof(counts[0]) ; i++ ) {
+    if( counts[i] > maxCount ) break;
+    printf( "%8d", counts[i] );
+    printf( " %9.3f ms", 1e3 * measure( counts[i], Collider::Simple ) );
+    printf( " %9.3f ms", 1e3 * measure( counts[i], Collider::Hash ) );
+    printf( " %9.3f ms", 1e3 * measure( counts[i], Collider::SweepAndPrune ) );
+    printf( " %9.3f ms\n", 1e3 * measure( counts[i], Collider::Quadtree ) );
+    fflush( stdout );
+  }
+  
+  return 0;
+}
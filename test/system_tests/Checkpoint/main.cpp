@@ -0,0 +1,165 @@
+/**
+ * @file main.cpp
+ *
+ * Measures the latency of ODECollisionRenderer::checkpoint() and restore()
+ * on a world of boxes falling into piles on the ground (1000 boxes by
+ * default). Each round takes a checkpoint, simulates a short branch and
+ * rolls back, as a model-predictive controller would.
+ *
+ * Also checks that a branch simulated twice from the same checkpoint ends in
+ * exactly the same state. The check is skipped if auto-disable is on, as
+ * the idle counters of ODE are not captured.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int settleSteps = 50;
+static const int branchSteps = 10;
+static const int rounds = 100;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+static void simulate( ODEWorld & world, ODECollisionRenderer & collider,
+                      int steps )
+{
+  for( int i = 0 ; i < steps ; i++ ) {
+    collider.render();
+    world.timestep( dt );
+  }
+}
+
+
+static vector<Vector> locations( const vector< shared_ptr<Object> > & boxes )
+{
+  vector<Vector> result;
+  for( unsigned int i = 0 ; i < boxes.size() ; i++ ) {
+    result.push_back( boxes[i]->getLocator()->getLoc() );
+  }
+  return result;
+}
+
+
+static bool identical( const vector<Vector> & lhs, const vector<Vector> & rhs )
+{
+  for( unsigned int i = 0 ; i < lhs.size() ; i++ ) {
+    for( int c = 0 ; c < 3 ; c++ ) {
+      if( lhs[i](c) != rhs[i](c) ) return false;
+    }
+  }
+  return true;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int boxCount = CountArgument( argc, argv, "[body count]", 1000 );
+  
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 1000.0, 1.0, 1000.0 ) ),
+                             material ))));
+  world.addObject( ground );
+  
+  vector< shared_ptr<Object> > boxes;
+  for( int i = 0 ; i < boxCount ; i++ ) {
+    // columns of five boxes, slightly displaced so that they topple
+    Vector loc = makeVector3d( 2.0 * (i / 5 % 20) + 0.1 * (i % 5),
+                               0.6 + 1.1 * (i % 5),
+                               2.0 * (i / 100) );
+    shared_ptr<Object> box
+      ( new Object
+        ( Object::Params
+          ( new ODELocator( loc ), 0,
+            new BasicGeometry( shapes::Cube::create
+                               ( makeVector3d( 1.0, 1.0, 1.0 ) ),
+                               material ))));
+    world.addObject( box );
+    boxes.push_back( box );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  simulate( world, collisionRenderer, settleSteps );
+  
+  // determinism of a branch
+  ODEWorld::Checkpoint checkpoint;
+  collisionRenderer.checkpoint( checkpoint );
+  simulate( world, collisionRenderer, branchSteps );
+  vector<Vector> first = locations( boxes );
+  collisionRenderer.restore( checkpoint );
+  simulate( world, collisionRenderer, branchSteps );
+  bool deterministic = !world.getSolverParams().autoDisable;
+  bool ok = !deterministic || identical( first, locations( boxes ) );
+  
+  // latency
+  double checkpointTime = 0.0, restoreTime = 0.0, branchTime = 0.0;
+  for( int round = 0 ; round < rounds ; round++ ) {
+    double t0 = WallTime();
+    collisionRenderer.checkpoint( checkpoint );
+    double t1 = WallTime();
+    simulate( world, collisionRenderer, branchSteps );
+    double t2 = WallTime();
+    collisionRenderer.restore( checkpoint );
+    double t3 = WallTime();
+    
+    checkpointTime += t1 - t0;
+    branchTime += t2 - t1;
+    restoreTime += t3 - t2;
+    
+    // advance the base state a little between rounds
+    simulate( world, collisionRenderer, 1 );
+  }
+  
+  cout << boxCount << " bodies, " << checkpoint.getByteSize()
+       << " bytes per checkpoint" << endl;
+  printf( "checkpoint: %8.1f us\n", 1e6 * checkpointTime / rounds );
+  printf( "restore:    %8.1f us\n", 1e6 * restoreTime / rounds );
+  printf( "branch:     %8.1f us (%d steps)\n",
+          1e6 * branchTime / rounds, branchSteps );
+  if( deterministic ) {
+    cout << ( ok ? "branches identical" : "BRANCHES DIFFER" ) << endl;
+  } else {
+    cout << "branches not compared (auto-disable is on)" << endl;
+  }
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < boxes.size() ; i++ ) {
+    world.removeObject( boxes[i] );
+  }
+  world.removeObject( ground );
+  
+  return Finish( ok );
+}
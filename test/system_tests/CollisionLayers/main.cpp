@@ -0,0 +1,146 @@
+/**
+ * @file main.cpp
+ *
+ * A heap of overlapping debris boxes on the ground, with a few actor spheres
+ * among them. The debris is put on the debris layer and set to collide with
+ * all layers except debris. Checks that no debris-debris contacts are created
+ * while the debris still touches the ground and the actors, and compares the
+ * collision cost with a run where all boxes collide with each other.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <cstdio>
+using std::printf;
+
+#include <vector>
+using std::vector;
+
+#include <set>
+using std::set;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int ticks = 10;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+static void run( int debrisCount, bool filtered, bool & ok )
+{
+  const CollisionLayers::Mask debrisLayer =
+    CollisionLayers::Bit( CollisionLayers::Debris );
+  
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 1000.0, 1.0, 1000.0 ) ),
+                             material,
+                             CollisionLayers::Bit( CollisionLayers::Terrain )
+                             ))));
+  world.addObject( ground );
+  
+  // a 10 x n x 10 heap of overlapping boxes with an actor in every tenth
+  // column
+  vector< shared_ptr<Object> > objects;
+  set<const Geometry *> debris;
+  for( int i = 0 ; i < debrisCount ; i++ ) {
+    Vector loc = makeVector3d( 0.4 * (i % 10), 0.2 + 0.4 * (i / 100),
+                               0.4 * (i / 10 % 10) );
+    bool actor = i % 10 == 5 && i / 10 % 10 == 5;
+    shared_ptr<Object> object
+      ( new Object
+        ( Object::Params
+          ( new ODELocator( loc ), 0,
+            actor ?
+            new BasicGeometry( shapes::Sphere::create( 0.3 ), material,
+                               CollisionLayers::Bit
+                               ( CollisionLayers::Actors ) ) :
+            new BasicGeometry( shapes::Cube::create
+                               ( makeVector3d( 0.5, 0.5, 0.5 ) ),
+                               material,
+                               filtered ? debrisLayer :
+                               CollisionLayers::Bit( CollisionLayers::Default ),
+                               filtered ? ~debrisLayer : CollisionLayers::All )
+            )));
+    world.addObject( object );
+    objects.push_back( object );
+    if( !actor ) debris.insert( object->getGeometry().get() );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  
+  Stopwatch collision;
+  for( int i = 0 ; i < ticks ; i++ ) {
+    collision.start();
+    collisionRenderer.render();
+    collision.stop();
+    
+    // count the contacts after the first collision
+    if( i == 0 ) {
+      int debrisDebris = 0, other = 0;
+      for( unsigned int j = 0 ; j < objects.size() ; j++ ) {
+        const Geometry * geometry = objects[j]->getGeometry().get();
+        const Geometry::contacts_t & contacts = geometry->getContacts();
+        for( Geometry::contacts_t::const_iterator k = contacts.begin() ;
+             k != contacts.end() ; ++k ) {
+          if( debris.count( geometry ) && debris.count( k->first ) ) {
+            debrisDebris++;
+          } else {
+            other++;
+          }
+        }
+      }
+      
+      bool expected = other > 0 && ( filtered ? debrisDebris == 0 :
+                                     debrisDebris > 0 );
+      ok &= expected;
+      printf( "%-10s %6d debris-debris, %6d other contacts%s\n",
+              filtered ? "filtered" : "unfiltered", debrisDebris, other,
+              expected ? "" : "  FAILED" );
+    }
+    
+    world.timestep( dt );
+  }
+  printf( "%-10s %9.3f ms per collision\n",
+          filtered ? "filtered" : "unfiltered",
+          1e3 * collision.getTotal() / ticks );
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < objects.size() ; i++ ) {
+    world.removeObject( objects[i] );
+  }
+  world.removeObject( ground );
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int debrisCount = CountArgument( argc, argv, "[debris count]", 2000 );
+  
+  bool ok = true;
+  run( debrisCount, false, ok );
+  run( debrisCount, true, ok );
+  
+  return Finish( ok );
+}
@@ -0,0 +1,108 @@
+/**
+ * @file main.cpp
+ *
+ * Measures the contact tracking of the Collider with a dense heap of
+ * overlapping boxes that keep touching, with roughly 10000 active contacts by
+ * default. Each tick some boxes are shaken so that contacts also come and go.
+ * Checks that the contact lists of the geometries agree with the Collider's
+ * contact count.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+using boost::dynamic_pointer_cast;
+
+
+
+
+static const int ticks = 20;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int boxCount = CountArgument( argc, argv, "[box count]", 2000 );
+  
+  ODEWorld world;
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  // a 10 x n x 10 heap of boxes, each overlapping its 26 neighbours
+  vector< shared_ptr<Object> > boxes;
+  for( int i = 0 ; i < boxCount ; i++ ) {
+    Vector loc = makeVector3d( 0.8 * (i % 10), 0.8 * (i / 100),
+                               0.8 * (i / 10 % 10) );
+    shared_ptr<Object> box
+      ( new Object
+        ( Object::Params
+          ( new ODELocator( loc ), 0,
+            new BasicGeometry( shapes::Cube::create
+                               ( makeVector3d( 1.0, 1.0, 1.0 ) ),
+                               material ))));
+    world.addObject( box );
+    boxes.push_back( box );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  const Collider & collider = *collisionRenderer.getCollider();
+  
+  Stopwatch collision;
+  std::size_t contacts = 0;
+  bool ok = true;
+  for( int i = 0 ; i < ticks ; i++ ) {
+    // shake every tenth box back and forth to create and wipe contacts
+    for( int j = i % 10 ; j < boxCount ; j += 10 ) {
+      dynamic_pointer_cast<ODELocator>( boxes[j]->getLocator() )->setVel
+        ( makeVector3d( i % 2 ? 50.0 : -50.0, 0.0, 0.0 ) );
+    }
+    
+    collision.start();
+    collisionRenderer.render();
+    collision.stop();
+    contacts += collider.getContactCount();
+    
+    // every contact is in the lists of both of its geometries
+    std::size_t listed = 0;
+    for( int j = 0 ; j < boxCount ; j++ ) {
+      listed += boxes[j]->getGeometry()->getContacts().size();
+    }
+    ok &= listed == 2 * collider.getContactCount();
+    
+    world.timestep( dt );
+  }
+  
+  printf( "%d boxes, %.0f contacts per tick\n",
+          boxCount, (double)contacts / ticks );
+  printf( "collision: %9.3f ms per tick\n",
+          1e3 * collision.getTotal() / ticks );
+  cout << ( ok ? "contact lists agree" : "CONTACT LISTS DIFFER" ) << endl;
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < boxes.size() ; i++ ) {
+    world.removeObject( boxes[i] );
+  }
+  
+  return Finish( ok );
+}
@@ -0,0 +1,95 @@
+/**
+ * @file main.cpp
+ *
+ * Exercises the fixed-step accumulator of World: a world stepped with a fixed
+ * 1 ms timestep is fed with render-frame sized elapsed times, and the number
+ * of substeps, the interpolation alpha and the stored previous poses are
+ * checked against the expected values. Also checks that a long stall is
+ * capped to the maximum number of substeps, both through advance() and
+ * through the clock of the GE_TICK events.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cmath>
+using std::fabs;
+
+#include <unistd.h>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+using boost::dynamic_pointer_cast;
+
+
+
+
+static bool check( bool condition, const char * what )
+{
+  cout << ( condition ? "ok:     " : "FAILED: " ) << what << endl;
+  return condition;
+}
+
+
+static bool near( double lhs, double rhs )
+{
+  return fabs( lhs - rhs ) < 1e-4;
+}
+
+
+
+
+int main()
+{
+  World world;
+  
+  shared_ptr<Object> object
+    ( new Object( Object::Params( new MotionLocator() ) ) );
+  world.addObject( object );
+  dynamic_pointer_cast<MotionLocator>( object->getLocator() )
+    ->setVel( makeVector3d( 1.0, 0.0, 0.0 ) );
+  
+  world.setFixedStep( 0.001, 20 );
+  world.setRenderInterpolation( true );
+  bool ok = true;
+  
+  // one 60 Hz frame: 16 steps, 2/3 of a step left over
+  unsigned int steps = world.advance( 1.0 / 60.0 );
+  ok &= check( steps == 16, "16 substeps for a 60 Hz frame" );
+  ok &= check( near( world.getInterpolationAlpha(), 2.0 / 3.0 ),
+               "alpha of 2/3 after a 60 Hz frame" );
+  
+  const World::Pose * pose = world.getPreviousPose( *object );
+  ok &= check( pose != 0, "previous pose stored" );
+  ok &= check( pose && near( pose->loc[0], 0.015 ) &&
+               near( object->getLocator()->getLoc()(0), 0.016 ),
+               "previous pose is one step behind" );
+  
+  // a stall is capped to the maximum number of substeps
+  steps = world.advance( 0.5 );
+  ok &= check( steps == 20, "stall capped to 20 substeps" );
+  ok &= check( near( world.getWorldTime(), 0.036 ), "world time 0.036" );
+  
+  // a short frame only accumulates
+  steps = world.advance( 0.0002 );
+  ok &= check( steps == 0 && world.getInterpolationAlpha() < 1.0,
+               "short frame accumulates without stepping" );
+  
+  // a stall between two events queues up at most the substeps of one event
+  World tickWorld;
+  tickWorld.setFixedStep( 0.001, 4 );
+  GraphicsEvent tick = { GE_TICK, 0 };
+  tickWorld.processEvent( &tick );   // starts the clock
+  usleep( 50000 );
+  tickWorld.processEvent( &tick );
+  ok &= check( near( tickWorld.getWorldTime(), 0.004 ) &&
+               tickWorld.getInterpolationAlpha() < 1e-6,
+               "stall between events clamped to 4 substeps" );
+  
+  world.removeObject( object );
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file main.cpp
+ *
+ * Connects, disconnects and toggles the collision inhibition of random
+ * connectors among a group of bodies with 30 connectors each, and checks
+ * after each change that the hashed inhibited-pair table of the Collider
+ * agrees with a scan over the connectors. Then compares the cost of the two
+ * checks.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::rand;
+using std::srand;
+
+#include <cmath>
+using std::cos;
+using std::sin;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int connectorsPerBody = 30;
+static const int changes = 2000;
+static const int probeRounds = 1000;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+/** A sphere with connectors around its equator. */
+class Segment :
+  public Object
+{
+public:
+  
+  Segment( const Vector & loc ) :
+    Object( Object::Params
+            ( new ODELocator( loc ), 0,
+              new BasicGeometry( shapes::Sphere::create( 0.5 ), material ) ))
+  {
+    for( int i = 0 ; i < connectorsPerBody ; i++ ) {
+      real angle = 2.0 * M_PI * i / connectorsPerBody;
+      connectors[i] = shared_ptr<Connector>
+        ( new ODEBallConnector
+          ( Connector( *this, Connector::Any,
+                       BasicLocator( makeVector3d( 0.5 * cos( angle ), 0.0,
+                                                   0.5 * sin( angle ) ) ),
+                       true ) ) );
+    }
+  }
+};
+
+
+static bool agree( const Collider & collider,
+                   const vector< shared_ptr<Object> > & bodies )
+{
+  for( unsigned int i = 0 ; i < bodies.size() ; i++ ) {
+    for( unsigned int j = 0 ; j < bodies.size() ; j++ ) {
+      if( collider.areCollisionsInhibited( *bodies[i], *bodies[j] ) !=
+          Collider::ScanCollisionsInhibited( *bodies[i], *bodies[j] ) ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int bodyCount = CountArgument( argc, argv, "[body count]", 20 );
+  
+  ODEWorld world;
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  vector< shared_ptr<Object> > bodies;
+  for( int i = 0 ; i < bodyCount ; i++ ) {
+    shared_ptr<Object> body
+      ( new Segment( makeVector3d( 2.0 * i, 0.0, 0.0 ) ) );
+    world.addObject( body );
+    bodies.push_back( body );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  const Collider & collider = *collisionRenderer.getCollider();
+  
+  // random changes
+  srand( 1 );
+  bool ok = agree( collider, bodies );
+  int connects = 0, disconnects = 0, toggles = 0;
+  for( int i = 0 ; i < changes && ok ; i++ ) {
+    Object & lhs = *bodies[rand() % bodyCount];
+    Object & rhs = *bodies[rand() % bodyCount];
+    Connector & connector = *lhs.getConnectors()[rand() % connectorsPerBody];
+    shared_ptr<Connector> target =
+      rhs.getConnectors()[rand() % connectorsPerBody];
+    
+    if( !connector.isConnected() ) {
+      if( &lhs != &rhs && !target->isConnected() ) {
+        connector.connect( target );
+        connects++;
+      }
+    } else if( rand() % 2 && connector.isConnectedAndMaster() ) {
+      connector.disconnect();
+      disconnects++;
+    } else {
+      connector.setInhibitCollisions( !connector.doesInhibitCollisions() );
+      toggles++;
+    }
+    
+    ok = agree( collider, bodies );
+  }
+  cout << connects << " connects, " << disconnects << " disconnects, "
+       << toggles << " toggles: "
+       << ( ok ? "tables agree" : "TABLES DIFFER" ) << endl;
+  
+  // probe costs
+  int inhibited = 0;
+  double t0 = WallTime();
+  for( int round = 0 ; round < probeRounds ; round++ ) {
+    for( int i = 0 ; i < bodyCount ; i++ ) {
+      inhibited += collider.areCollisionsInhibited
+        ( *bodies[i], *bodies[(i + round) % bodyCount] );
+    }
+  }
+  double t1 = WallTime();
+  for( int round = 0 ; round < probeRounds ; round++ ) {
+    for( int i = 0 ; i < bodyCount ; i++ ) {
+      inhibited -= Collider::ScanCollisionsInhibited
+        ( *bodies[i], *bodies[(i + round) % bodyCount] );
+    }
+  }
+  double t2 = WallTime();
+  ok &= inhibited == 0;
+  
+  int probes = probeRounds * bodyCount;
+  printf( "hashed: %8.1f ns per pair\n", 1e9 * (t1 - t0) / probes );
+  printf( "scan:   %8.1f ns per pair\n", 1e9 * (t2 - t1) / probes );
+  
+  // disconnect all
+  for( unsigned int i = 0 ; i < bodies.size() ; i++ ) {
+    Object::connectors_t & connectors = bodies[i]->getConnectors();
+    for( Object::connectors_t::iterator j = connectors.begin() ;
+         j != connectors.end() ; ++j ) {
+      if( j->second->isConnectedAndMaster() ) j->second->disconnect();
+    }
+  }
+  ok &= agree( collider, bodies );
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < bodies.size() ; i++ ) {
+    world.removeObject( bodies[i] );
+  }
+  
+  return Finish( ok );
+}
@@ -0,0 +1,149 @@
+/**
+ * @file main.cpp
+ *
+ * Steps a world of disconnected "robots", each a chain of bodies linked with
+ * ODEBallConnectors, with 1, 2, 4 and 8 island solver threads (only 1 if the
+ * library is built without LS_ODE_THREADING). Checks that the island
+ * statistics report one island per robot.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <ode/ode.h>
+#include <ode/odecpp.h>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::atoi;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int linksPerRobot = 8;
+static const int measureSteps = 200;
+static const real dt = 0.01;
+
+
+
+
+/** A robot limb with ball connectors at both ends. */
+class Limb :
+  public Object
+{
+public:
+  enum Connectors { CONN_HEAD, CONN_TAIL };
+  
+  Limb( const Vector & loc ) :
+    Object( Object::Params( new ODELocator( loc ) ) )
+  {
+    connectors[CONN_HEAD] = shared_ptr<Connector>
+      ( new ODEBallConnector
+        ( Connector( *this, Connector::Any,
+                     BasicLocator( makeVector3d( -0.5, 0, 0 ))))
+        );
+    connectors[CONN_TAIL] = shared_ptr<Connector>
+      ( new ODEBallConnector
+        ( Connector( *this, Connector::Any,
+                     BasicLocator( makeVector3d( 0.5, 0, 0 ))))
+        );
+  }
+};
+
+
+
+
+/** Runs the benchmark, returns the average step time. */
+static double run( unsigned int threads, int robots, bool & passed )
+{
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  world.setThreadCount( threads );
+  world.setIslandStatistics( true );
+  
+  vector< shared_ptr<Object> > limbs;
+  for( int r = 0 ; r < robots ; r++ ) {
+    for( int i = 0 ; i < linksPerRobot ; i++ ) {
+      limbs.push_back
+        ( shared_ptr<Object>
+          ( new Limb( makeVector3d( i, 10.0, 2.0 * r ) )));
+      world.addObject( limbs.back() );
+    }
+  }
+  
+  world.activate( true );
+  
+  for( unsigned int i = 0 ; i < limbs.size() ; i++ ) {
+    if( i % linksPerRobot == 0 ) continue;
+    limbs[i - 1]->getConnector( Limb::CONN_TAIL )->connect
+      ( limbs[i]->getConnector( Limb::CONN_HEAD ) );
+  }
+  
+  double t0 = WallTime();
+  for( int i = 0 ; i < measureSteps ; i++ ) world.timestep( dt );
+  double time = (WallTime() - t0) / measureSteps;
+  
+  if( world.getIslandCount() != (unsigned int)robots ||
+      world.getLargestIslandSize() != (unsigned int)linksPerRobot ) {
+    cout << "FAILED: " << world.getIslandCount() << " islands, largest "
+         << world.getLargestIslandSize() << " bodies" << endl;
+    passed = false;
+  }
+  
+  for( unsigned int i = 0 ; i < limbs.size() ; i++ ) {
+    if( i % linksPerRobot == 0 ) continue;
+    limbs[i - 1]->getConnector( Limb::CONN_TAIL )->disconnect();
+  }
+  world.activate( false );
+  for( unsigned int i = 0 ; i < limbs.size() ; i++ ) {
+    world.removeObject( limbs[i] );
+  }
+  
+  return time;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  if( argc != 2 ) Usage( argv, "<robot count>" );
+  int robots = atoi( argv[1] );
+  
+  cout << "robots: " << robots << ", bodies: " << robots * linksPerRobot
+       << ", hardware threads: " << ThreadPool::HardwareThreads() << endl;
+  
+#ifdef LS_ODE_THREADING
+  static const unsigned int threadCounts[] = { 1, 2, 4, 8 };
+  static const int runs = 4;
+#else
+  static const unsigned int threadCounts[] = { 1 };
+  static const int runs = 1;
+#endif
+  
+  bool passed = true;
+  double serialTime = 0.0;
+  for( int i = 0 ; i < runs ; i++ ) {
+    double time = run( threadCounts[i], robots, passed );
+    if( i == 0 ) serialTime = time;
+    printf( "threads %u:  %9.3f ms/step (speedup %5.2f)\n",
+            threadCounts[i], 1e3 * time, serialTime / time );
+  }
+  
+  return Finish( passed );
+}
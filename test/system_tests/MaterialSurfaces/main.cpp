@@ -0,0 +1,112 @@
+/**
+ * @file main.cpp
+ *
+ * Drops a grid of spheres with four different materials onto the ground and
+ * records the fastest rebound of each material. Checks that the rebound grows
+ * with the bounciness of the material and that the dull spheres do not
+ * bounce, and measures the collision cost per tick.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int ticks = 100;
+static const real dt = 0.01;
+static const int materialCount = 4;
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int sphereCount = CountArgument( argc, argv, "[sphere count]", 1000 );
+  
+  // bounciness 0, 0.3, 0.6 and 0.9 against a fully bouncy ground
+  vector< shared_ptr<CollisionMaterial> > materials;
+  for( int i = 0 ; i < materialCount ; i++ ) {
+    materials.push_back( shared_ptr<CollisionMaterial>
+                         ( new CollisionMaterial( 0.9, 0.3 * i, 0.001 ) ));
+  }
+  
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 1000.0, 1.0, 1000.0 ) ),
+                             shared_ptr<CollisionMaterial>
+                             ( new CollisionMaterial( 1.0, 1.0, 0.0 ) )))));
+  world.addObject( ground );
+  
+  vector< shared_ptr<Object> > spheres;
+  for( int i = 0 ; i < sphereCount ; i++ ) {
+    Vector loc = makeVector3d( 1.0 * (i % 32), 1.0, 1.0 * (i / 32) );
+    shared_ptr<Object> sphere
+      ( new Object
+        ( Object::Params
+          ( new ODELocator( loc ), 0,
+            new BasicGeometry( shapes::Sphere::create( 0.25 ),
+                               materials[i % materialCount] ))));
+    world.addObject( sphere );
+    spheres.push_back( sphere );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  
+  Stopwatch collision;
+  vector<real> rebound( materialCount, 0.0 );
+  for( int i = 0 ; i < ticks ; i++ ) {
+    collision.start();
+    collisionRenderer.render();
+    collision.stop();
+    
+    world.timestep( dt );
+    
+    for( int j = 0 ; j < sphereCount ; j++ ) {
+      real vel = spheres[j]->getLocator()->getVel()(1);
+      if( vel > rebound[j % materialCount] ) rebound[j % materialCount] = vel;
+    }
+  }
+  
+  bool ok = rebound[0] < 0.1;
+  for( int i = 0 ; i < materialCount ; i++ ) {
+    if( i > 0 ) ok &= rebound[i] > rebound[i - 1];
+    printf( "bounciness %.1f: rebound %6.3f m/s\n", 0.3 * i, rebound[i] );
+  }
+  printf( "%d spheres, collision: %9.3f ms per tick\n",
+          sphereCount, 1e3 * collision.getTotal() / ticks );
+  cout << ( ok ? "rebounds ok" : "REBOUNDS WRONG" ) << endl;
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < spheres.size() ; i++ ) {
+    world.removeObject( spheres[i] );
+  }
+  world.removeObject( ground );
+  
+  return Finish( ok );
+}
@@ -230,9 +230,17 @@ class TestObject :
 
 int main( int argc, char * argv[] )
 {
-  GLOWDevice::Init( argc, argv );
-  GLOWDevice window;
-  GLOWViewport viewport( window );
+  // "--headless <ticks>" runs the given number of ticks without a display
+  bool headless = SimulationDriver::IsHeadless( argc, argv );
+  SimulationDriver driver;
+  GLOWDevice * window = 0;
+  GLOWViewport * viewport = 0;
+  if( !headless ) {
+    GLOWDevice::Init( argc, argv );
+    window = new GLOWDevice();
+    viewport = new GLOWViewport( *window );
+  }
+  Device & device = headless ? static_cast<Device &>( driver ) : *window;
   
   // world
   ODEWorld world;
@@ -272,15 +280,20 @@ int main( int argc, char * argv[] )
             &redMat ))));
   objectSpace->addObject( object2 );
   Controller::ControlMap ssKeymap; fillSsKeymap( ssKeymap );
-  viewport.addActor( dynamic_pointer_cast<Actor>(object2),
-                     &ssKeymap );
+  if( viewport ) {
+    viewport->addActor( dynamic_pointer_cast<Actor>(object2), &ssKeymap );
+  }
   dynamic_pointer_cast<FloatingActor>(object2)->setAutoRoll( false );
   Controller::ControlMap ssJoint1Keymap; fillSsJoint1Keymap( ssJoint1Keymap );
-  viewport.addActor( object2->getConnector( TestObjectSs::CONN_X_AXIS_TIP ),
-                     &ssJoint1Keymap );
+  if( viewport ) {
+    viewport->addActor( object2->getConnector( TestObjectSs::CONN_X_AXIS_TIP ),
+                        &ssJoint1Keymap );
+  }
   Controller::ControlMap ssJoint2Keymap; fillSsJoint2Keymap( ssJoint2Keymap );
-  viewport.addActor( object2->getConnector( TestObjectSs::CONN_Y_AXIS_TIP ),
-                     &ssJoint2Keymap );
+  if( viewport ) {
+    viewport->addActor( object2->getConnector( TestObjectSs::CONN_Y_AXIS_TIP ),
+                        &ssJoint2Keymap );
+  }
   
   
   // 3rd basis object (the one in the background)
@@ -367,11 +380,11 @@ int main( int argc, char * argv[] )
   //world.addObject( &camSpace );
   //camSpace.addObject( camTarget );
   world.addObject( camTarget );
-  viewport.addActor( camTarget, &camKeymap );
+  if( viewport ) viewport->addActor( camTarget, &camKeymap );
   
   shared_ptr<Camera> cam( new Camera() );
   cam->setTargetObject( camTarget );
-  viewport.setCamera( cam );
+  if( viewport ) viewport->setCamera( cam );
   
   
   //object2->getLocator()->addTorqueAbs( makeVector3d( -500.0, 0.0, 0.0 ) );
@@ -390,13 +403,14 @@ int main( int argc, char * argv[] )
   */
   
   world.setDefaultDt( 0.05 );
-  window.events.addListener( &world );
+  device.events.addListener( &world );
   
   /*
   //camTarget->getLocator()->addForceAbs( makeVector3d( 3.0, 0.0, 0.0 ) );
   camSpace.getLocator()->addForceAbs( makeVector3d( 3.0, 0.0, 0.0 ) );
   */
   
+  driver.runHeadlessIfRequested( argc, argv );
   GLOWDevice::MainLoop();
   
   return 0;
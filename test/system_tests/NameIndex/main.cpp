@@ -0,0 +1,224 @@
+/**
+ * @file main.cpp
+ *
+ * Checks the World path index against Object::getFullName() while objects
+ * are added, removed, renamed and moved around randomly, checks that the
+ * paths of removed objects are released, and then times name lookups through
+ * the index against a search that rebuilds the full names.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+using std::sprintf;
+
+#include <cstdlib>
+using std::atoi;
+using std::rand;
+using std::srand;
+
+#include <vector>
+using std::vector;
+
+#include <string>
+using std::string;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+using boost::dynamic_pointer_cast;
+
+#include <boost/timer.hpp>
+using boost::timer;
+
+
+
+
+static int failures = 0;
+
+#define check( condition )                                              \
+  if( !(condition) ) {                                                  \
+    cout << "FAILED: " #condition " (line " << __LINE__ << ")" << endl; \
+    failures++;                                                         \
+  }
+
+
+
+
+/* Linear search by rebuilt full names, like without the index. */
+static Object * searchObject( Subspace & subspace, const string & fullName )
+{
+  if( subspace.getFullName() == fullName ) return &subspace;
+  
+  const Subspace::objects_t & objects = subspace.getObjects();
+  for( Subspace::objects_t::size_type i = 0 ; i < objects.size() ; i++ ) {
+    Subspace * child = dynamic_cast<Subspace *>( objects[i].get() );
+    if( child ) {
+      Object * result = searchObject( *child, fullName );
+      if( result ) return result;
+    } else if( objects[i]->getFullName() == fullName ) {
+      return objects[i].get();
+    }
+  }
+  return 0;
+}
+
+
+/* Checks that every object in the subspace is found by its full name. */
+static void checkIndex( const World & world, const Subspace & subspace )
+{
+  check( world.findObject( subspace.getFullName() ) == &subspace );
+  
+  const Subspace::objects_t & objects = subspace.getObjects();
+  for( Subspace::objects_t::size_type i = 0 ; i < objects.size() ; i++ ) {
+    check( world.findObject( objects[i]->getFullName() ) ==
+           objects[i].get() );
+    const Subspace * child =
+      dynamic_cast<const Subspace *>( objects[i].get() );
+    if( child ) checkIndex( world, *child );
+  }
+}
+
+
+static string makeName( const char * prefix, int number )
+{
+  char buf[32];
+  sprintf( buf, "%s%d", prefix, number );
+  return buf;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int count = argc > 1 ? atoi( argv[1] ) : 10000;
+  int lookups = argc > 2 ? atoi( argv[2] ) : 1000;
+  
+  World world;
+  world.setName( "world" );
+  srand( 1 );
+  
+  
+  /* build a random hierarchy with unique names */
+  
+  vector< shared_ptr<Subspace> > spaces;
+  vector< shared_ptr<Object> > objects;
+  for( int i = 0 ; i < count ; i++ ) {
+    Subspace * host = spaces.empty() || rand() % 4 == 0 ?
+      (Subspace *)&world : spaces[rand() % spaces.size()].get();
+    
+    if( rand() % 8 == 0 ) {
+      shared_ptr<Subspace> space( new Subspace() );
+      space->setName( makeName( "space", i ) );
+      host->addObject( space );
+      spaces.push_back( space );
+    } else {
+      shared_ptr<Object> object( new Object() );
+      object->setName( makeName( "object", i ) );
+      host->addObject( object );
+      objects.push_back( object );
+    }
+  }
+  checkIndex( world, world );
+  
+  
+  /* detach and reattach subspaces, and rename objects and subspaces */
+  
+  for( int i = 0 ; i < 100 && !spaces.empty() ; i++ ) {
+    shared_ptr<Subspace> space = spaces[rand() % spaces.size()];
+    Subspace * oldHost = space->getHostSpace();
+    
+    oldHost->removeObject( space );
+    check( world.findObject( space->getFullName() ) == 0 );
+    space->setName( makeName( "moved", i ) );
+    oldHost->addObject( space );
+    
+    shared_ptr<Object> object = objects[rand() % objects.size()];
+    string oldName = object->getFullName();
+    object->setName( makeName( "renamed", i ) );
+    check( world.findObject( oldName ) == 0 );
+  }
+  checkIndex( world, world );
+  
+  
+  /* duplicate names: the index must survive removal of either one */
+  
+  shared_ptr<Object> twin1( new Object() ), twin2( new Object() );
+  twin1->setName( "twin" );
+  twin2->setName( "twin" );
+  world.addObject( twin1 );
+  world.addObject( twin2 );
+  check( world.findObject( "world/twin" ) != 0 );
+  world.removeObject( twin2 );
+  check( world.findObject( "world/twin" ) == twin1.get() );
+  world.addObject( twin2 );
+  world.removeObject( twin1 );
+  check( world.findObject( "world/twin" ) == twin2.get() );
+  world.removeObject( twin2 );
+  check( world.findObject( "world/twin" ) == 0 );
+  
+  
+  /* unique names that come and go must not grow the index */
+  
+  unsigned int pathCount = world.getPathCount();
+  for( int i = 0 ; i < count ; i++ ) {
+    shared_ptr<Object> object( new Object() );
+    object->setName( makeName( "spawned", i ) );
+    world.addObject( object );
+    world.removeObject( object );
+  }
+  check( world.getPathCount() == pathCount );
+  checkIndex( world, world );
+  
+  
+  /* time lookups */
+  
+  vector<string> names;
+  for( int i = 0 ; i < lookups ; i++ ) {
+    names.push_back( objects[rand() % objects.size()]->getFullName() );
+  }
+  
+  timer clock;
+  int found = 0;
+  for( int i = 0 ; i < lookups ; i++ ) {
+    found += searchObject( world, names[i] ) != 0;
+  }
+  double searchTime = clock.elapsed();
+  
+  clock.restart();
+  for( int i = 0 ; i < lookups ; i++ ) {
+    found += world.findObject( names[i] ) != 0;
+  }
+  double indexTime = clock.elapsed();
+  check( found == 2 * lookups );
+  
+  printf( "%d objects, %d lookups: search %.3f us, index %.3f us per lookup\n",
+          count, lookups,
+          1e6 * searchTime / lookups, 1e6 * indexTime / lookups );
+  
+  
+  /* tear down */
+  
+  for( vector< shared_ptr<Object> >::iterator i = objects.begin() ;
+       i != objects.end() ; i++ ) {
+    (*i)->getHostSpace()->removeObject( *i );
+  }
+  for( vector< shared_ptr<Subspace> >::reverse_iterator i = spaces.rbegin() ;
+       i != spaces.rend() ; i++ ) {
+    while( !(*i)->getObjects().empty() ) {
+      (*i)->removeObject( (*i)->getObjects().back() );
+    }
+  }
+  while( !world.getObjects().empty() ) {
+    world.removeObject( world.getObjects().back() );
+  }
+  
+  cout << ( failures ? "FAILED" : "OK" ) << endl;
+  return failures ? 1 : 0;
+}
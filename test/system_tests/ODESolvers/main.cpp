@@ -0,0 +1,255 @@
+/**
+ * @file main.cpp
+ *
+ * Compares the BigMatrix and QuickStep solvers of ODEWorld on two scenes:
+ * "stack" builds columns of boxes resting on the ground, "chain" drops chains
+ * of boxes linked with ODEBallConnectors onto the ground. The size argument
+ * is the number of columns or chains (with 10 boxes in each).
+ *
+ * Reports the wall time per step and a stability metric: the largest
+ * horizontal drift of a box from its initial position for stacks, and the
+ * largest separation of two connected chain links at their joint for chains.
+ * Also checks that the default solver parameters match the defaults of ODE.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <ode/ode.h>
+#include <ode/odecpp.h>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::atoi;
+
+#include <cstring>
+using std::strcmp;
+
+#include <vector>
+using std::vector;
+
+#include <algorithm>
+using std::max;
+
+#include <cmath>
+using std::fabs;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int boxesPerGroup = 10;
+static const int simulatedSteps = 500;
+static const real dt = 0.01;
+static const real linkLength = 1.0;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+
+
+/** A box-shaped chain link with ball connectors at both ends. */
+class Link :
+  public Object
+{
+public:
+  enum Connectors { CONN_HEAD, CONN_TAIL };
+  
+  Link( const Vector & loc ) :
+    Object( Object::Params
+            ( new ODELocator( loc ), 0,
+              new BasicGeometry
+              ( shapes::Cube::create
+                ( makeVector3d( linkLength, 0.2, 0.2 ) ),
+                material )))
+  {
+    connectors[CONN_HEAD] = shared_ptr<Connector>
+      ( new ODEBallConnector
+        ( Connector( *this, Connector::Any,
+                     BasicLocator( makeVector3d( -linkLength / 2, 0, 0 ))))
+        );
+    connectors[CONN_TAIL] = shared_ptr<Connector>
+      ( new ODEBallConnector
+        ( Connector( *this, Connector::Any,
+                     BasicLocator( makeVector3d( linkLength / 2, 0, 0 ))))
+        );
+  }
+  
+  /** Returns the world location of the given end of the link. */
+  Vector getEnd( real side ) const
+  {
+    Vector end( makeVector3d( side * linkLength / 2, 0, 0 ) );
+    getLocator()->transform( end );
+    return end;
+  }
+};
+
+
+
+
+struct Result {
+  double stepTime;
+  real stability;
+};
+
+
+static Result run( ODEWorld::Solver solver, bool chains, int groups )
+{
+  ODEWorld::SolverParams params;
+  params.solver = solver;
+  params.contactMaxCorrectingVel = 1.0;
+  params.contactSurfaceLayer = 0.001;
+  
+  ODEWorld world( Subspace::Params(), params );
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 1000.0, 1.0, 1000.0 ) ),
+                             material ))));
+  world.addObject( ground );
+  
+  vector< shared_ptr<Object> > boxes;
+  vector<Vector> initialLocs;
+  for( int g = 0 ; g < groups ; g++ ) {
+    for( int i = 0 ; i < boxesPerGroup ; i++ ) {
+      Vector loc = chains ?
+        makeVector3d( i * linkLength, 1.0, 2.0 * g ) :
+        makeVector3d( 2.0 * (g % 32), 0.5 + i, 2.0 * (g / 32) );
+      shared_ptr<Object> box;
+      if( chains ) {
+        box.reset( new Link( loc ) );
+      } else {
+        box.reset( new Object
+                   ( Object::Params
+                     ( new ODELocator( loc ), 0,
+                       new BasicGeometry
+                       ( shapes::Cube::create
+                         ( makeVector3d( 1.0, 1.0, 1.0 ) ),
+                         material ))));
+      }
+      world.addObject( box );
+      boxes.push_back( box );
+      initialLocs.push_back( loc );
+    }
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  
+  if( chains ) {
+    for( unsigned int i = 0 ; i < boxes.size() ; i++ ) {
+      if( i % boxesPerGroup == 0 ) continue;
+      boxes[i - 1]->getConnector( Link::CONN_TAIL )->connect
+        ( boxes[i]->getConnector( Link::CONN_HEAD ) );
+    }
+  }
+  
+  Result result = { 0.0, 0.0 };
+  double t0 = WallTime();
+  for( int step = 0 ; step < simulatedSteps ; step++ ) {
+    world.timestep( dt );
+    collisionRenderer.render();
+    
+    for( unsigned int i = 0 ; i < boxes.size() ; i++ ) {
+      real error;
+      if( chains ) {
+        if( i % boxesPerGroup == 0 ) continue;
+        error = norm_2
+          ( static_cast<Link &>( *boxes[i - 1] ).getEnd( 1.0 ) -
+            static_cast<Link &>( *boxes[i] ).getEnd( -1.0 ) );
+      } else {
+        Vector drift = boxes[i]->getLocator()->getLoc() - initialLocs[i];
+        drift(1) = 0.0;
+        error = norm_2( drift );
+      }
+      result.stability = max( result.stability, error );
+    }
+  }
+  result.stepTime = (WallTime() - t0) / simulatedSteps;
+  
+  for( unsigned int i = 0 ; chains && i < boxes.size() ; i++ ) {
+    if( i % boxesPerGroup == 0 ) continue;
+    boxes[i - 1]->getConnector( Link::CONN_TAIL )->disconnect();
+  }
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < boxes.size() ; i++ ) {
+    world.removeObject( boxes[i] );
+  }
+  world.removeObject( ground );
+  
+  return result;
+}
+
+
+
+
+/** Checks that the default SolverParams match the defaults of ODE, as read
+    back from a world created without explicit parameters. */
+static bool checkDefaults()
+{
+  ODEWorld world;
+  const ODEWorld::SolverParams & ode = world.getSolverParams();
+  ODEWorld::SolverParams defaults;
+  
+  return
+    ode.quickStepIterations == defaults.quickStepIterations &&
+    fabs( ode.quickStepW - defaults.quickStepW ) < 1e-9 &&
+    fabs( ode.erp - defaults.erp ) < 1e-9 &&
+    fabs( ode.cfm - defaults.cfm ) < 1e-15 &&
+    ode.contactMaxCorrectingVel == defaults.contactMaxCorrectingVel &&
+    ode.contactSurfaceLayer == defaults.contactSurfaceLayer &&
+    ode.autoDisable == defaults.autoDisable &&
+    fabs( ode.autoDisableLinearThreshold -
+          defaults.autoDisableLinearThreshold ) < 1e-9 &&
+    fabs( ode.autoDisableAngularThreshold -
+          defaults.autoDisableAngularThreshold ) < 1e-9 &&
+    ode.autoDisableSteps == defaults.autoDisableSteps &&
+    ode.autoDisableTime == defaults.autoDisableTime;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  if( argc != 3 ) Usage( argv, "[stack|chain] <group count>" );
+  bool chains = 0 == strcmp( argv[1], "chain" );
+  int groups  = atoi( argv[2] );
+  
+  cout << ( chains ? "chains: " : "stacks: " ) << groups << ", "
+       << groups * boxesPerGroup << " bodies, " << simulatedSteps
+       << " steps" << endl;
+  
+  Result bigMatrix = run( ODEWorld::BigMatrix, chains, groups );
+  Result quickStep = run( ODEWorld::QuickStep, chains, groups );
+  
+  const char * metric = chains ? "max joint error" : "max drift";
+  printf( "BigMatrix:  %9.3f ms/step, %s %.4f\n",
+          1e3 * bigMatrix.stepTime, metric, bigMatrix.stability );
+  printf( "QuickStep:  %9.3f ms/step, %s %.4f (speedup %.2f)\n",
+          1e3 * quickStep.stepTime, metric, quickStep.stability,
+          bigMatrix.stepTime / quickStep.stepTime );
+  
+  bool defaults = checkDefaults();
+  printf( "defaults:   %s\n", defaults ? "match ODE" : "DIFFER FROM ODE" );
+  
+  return Finish( defaults );
+}
@@ -0,0 +1,275 @@
+/**
+ * @file main.cpp
+ *
+ * Benchmarks the Subspace object storage: insert, iterate and remove with a
+ * plain std::list (the old storage) versus the handle-based storage in
+ * ordered and unordered mode, at 10k, 100k and 1M objects. Removal picks
+ * objects in random order; for the list only a sample of removals is timed,
+ * because each one is a linear search. Also checks that objects removing
+ * themselves while they are stepped do not make the integrator skip others.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::atoi;
+using std::srand;
+
+#include <list>
+using std::list;
+
+#include <vector>
+using std::vector;
+
+#include <algorithm>
+using std::find;
+using std::random_shuffle;
+using std::min;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <boost/timer.hpp>
+using boost::timer;
+
+
+
+
+static const int iterateRounds = 10;
+static const unsigned int listRemoveSamples = 1000;
+
+
+
+
+struct Times {
+  double insert, iterate, remove;
+  unsigned int removed;
+};
+
+
+static void print( const char * name, unsigned int count, const Times & t )
+{
+  printf( "%-20s %8u   insert %8.2f ns   iterate %6.2f ns   "
+          "remove %10.2f ns\n",
+          name, count,
+          1e9 * t.insert / count,
+          1e9 * t.iterate / (count * iterateRounds),
+          1e9 * t.remove / t.removed );
+}
+
+
+/* The iteration workload: touch each object, like the integrator does. */
+template<class Container>
+static unsigned long iterate( const Container & objects )
+{
+  unsigned long result = 0;
+  for( typename Container::const_iterator i = objects.begin() ;
+       i != objects.end() ; i++ ) {
+    result += !(*i)->isLockedToHostSpace();
+  }
+  return result;
+}
+
+
+
+
+static Times benchList( const vector< shared_ptr<Object> > & source,
+                        const vector<unsigned int> & removeOrder )
+{
+  Times t;
+  list< shared_ptr<Object> > objects;
+  timer clock;
+  
+  clock.restart();
+  for( unsigned int i = 0 ; i < source.size() ; i++ ) {
+    objects.push_back( source[i] );
+  }
+  t.insert = clock.elapsed();
+  
+  unsigned long sum = 0;
+  clock.restart();
+  for( int round = 0 ; round < iterateRounds ; round++ ) {
+    sum += iterate( objects );
+  }
+  t.iterate = clock.elapsed();
+  
+  t.removed = min( listRemoveSamples, (unsigned int)removeOrder.size() );
+  clock.restart();
+  for( unsigned int i = 0 ; i < t.removed ; i++ ) {
+    const shared_ptr<Object> & object = source[removeOrder[i]];
+    if( find( objects.begin(), objects.end(), object ) != objects.end() ) {
+      objects.remove( object );
+    }
+  }
+  t.remove = clock.elapsed();
+  
+  assert( sum == source.size() * iterateRounds );
+  return t;
+}
+
+
+static Times benchHandleVector( const vector< shared_ptr<Object> > & source,
+                                const vector<unsigned int> & removeOrder,
+                                bool ordered )
+{
+  typedef HandleVector< shared_ptr<Object> > objects_t;
+  Times t;
+  objects_t objects( ordered );
+  vector<objects_t::Handle> handles( source.size() );
+  timer clock;
+  
+  clock.restart();
+  for( unsigned int i = 0 ; i < source.size() ; i++ ) {
+    handles[i] = objects.insert( source[i] );
+  }
+  t.insert = clock.elapsed();
+  
+  unsigned long sum = 0;
+  clock.restart();
+  for( int round = 0 ; round < iterateRounds ; round++ ) {
+    sum += iterate( objects );
+  }
+  t.iterate = clock.elapsed();
+  
+  // ordered removal shifts the tail, so sample it like the list
+  t.removed = ordered ?
+    min( listRemoveSamples, (unsigned int)removeOrder.size() ) :
+    removeOrder.size();
+  clock.restart();
+  for( unsigned int i = 0 ; i < t.removed ; i++ ) {
+    objects.erase( handles[removeOrder[i]] );
+  }
+  t.remove = clock.elapsed();
+  
+  assert( sum == source.size() * iterateRounds );
+  assert( objects.size() == source.size() - t.removed );
+  return t;
+}
+
+
+static Times benchSubspace( const vector< shared_ptr<Object> > & source,
+                            const vector<unsigned int> & removeOrder )
+{
+  Times t;
+  Subspace subspace;
+  timer clock;
+  
+  clock.restart();
+  for( unsigned int i = 0 ; i < source.size() ; i++ ) {
+    subspace.addObject( source[i] );
+  }
+  t.insert = clock.elapsed();
+  
+  unsigned long sum = 0;
+  clock.restart();
+  for( int round = 0 ; round < iterateRounds ; round++ ) {
+    sum += iterate( subspace.getObjects() );
+  }
+  t.iterate = clock.elapsed();
+  
+  t.removed = removeOrder.size();
+  clock.restart();
+  for( unsigned int i = 0 ; i < t.removed ; i++ ) {
+    subspace.removeObject( source[removeOrder[i]] );
+  }
+  t.remove = clock.elapsed();
+  
+  assert( sum == source.size() * iterateRounds );
+  assert( subspace.getObjects().empty() );
+  return t;
+}
+
+
+
+/* An object that counts its steps and may remove itself while stepped. */
+class Despawner :
+  public Object
+{
+  bool despawn;
+public:
+  int steps;
+  Despawner( bool despawn_ ) : despawn( despawn_ ), steps( 0 ) {}
+  virtual void step()
+  {
+    steps++;
+    if( despawn ) getHostSpace()->removeObject( shared_from_this() );
+    Object::step();
+  }
+};
+
+
+/* Checks that the objects that remove themselves during the step pass do
+   not make the integrator skip other objects. */
+static bool checkSelfRemoval( bool ordered )
+{
+  Subspace subspace;
+  subspace.setOrderedObjects( ordered );
+  vector< shared_ptr<Despawner> > objects;
+  for( int i = 0 ; i < 10 ; i++ ) {
+    objects.push_back( shared_ptr<Despawner>( new Despawner( i % 3 == 0 ) ) );
+    subspace.addObject( objects.back() );
+  }
+  
+  subspace.step();
+  
+  bool ok = subspace.getObjects().size() == 6;
+  for( unsigned int i = 0 ; i < objects.size() ; i++ ) {
+    ok &= objects[i]->steps == 1;
+  }
+  
+  while( !subspace.getObjects().empty() ) {
+    subspace.removeObject( *subspace.getObjects().begin() );
+  }
+  return ok;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  vector<unsigned int> counts;
+  if( argc > 1 ) {
+    for( int i = 1 ; i < argc ; i++ ) counts.push_back( atoi( argv[i] ) );
+  } else {
+    counts.push_back( 10000 );
+    counts.push_back( 100000 );
+    counts.push_back( 1000000 );
+  }
+  
+  srand( 1 );
+  for( unsigned int c = 0 ; c < counts.size() ; c++ ) {
+    unsigned int count = counts[c];
+    
+    vector< shared_ptr<Object> > source( count );
+    vector<unsigned int> removeOrder( count );
+    for( unsigned int i = 0 ; i < count ; i++ ) {
+      source[i] = shared_ptr<Object>( new Object() );
+      removeOrder[i] = i;
+    }
+    random_shuffle( removeOrder.begin(), removeOrder.end() );
+    
+    print( "std::list", count, benchList( source, removeOrder ) );
+    print( "HandleVector/ordered", count,
+           benchHandleVector( source, removeOrder, true ) );
+    print( "HandleVector", count,
+           benchHandleVector( source, removeOrder, false ) );
+    print( "Subspace", count, benchSubspace( source, removeOrder ) );
+    cout << endl;
+  }
+  
+  // removal in constant time is the default
+  bool ok = !Subspace().hasOrderedObjects();
+  ok &= checkSelfRemoval( true ) && checkSelfRemoval( false );
+  cout << ( ok ? "self-removal ok" : "SELF-REMOVAL FAILED" ) << endl;
+  
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file main.cpp
+ *
+ * Drops a pile of overlapping capsules (2000 by default) onto the ground and
+ * measures the collision cost per tick with the narrowphase run on 1, 2, 4
+ * and 8 threads (only on the calling thread if the library is built without
+ * LS_ODE_THREADING). Checks that the final state of the pile is identical
+ * with each thread count.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <ode/ode.h>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int ticks = 50;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+/**
+ * Runs the pile with a pool of the given size (none if zero), stores the
+ * final capsule locations and returns the average collision time.
+ */
+static double run( unsigned int threads, int capsuleCount,
+                   vector<Vector> & locations, std::size_t & contacts )
+{
+  // the QuickStep solver draws from the global generator of ODE
+  dRandSetSeed( 0 );
+  
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  if( threads > 0 ) {
+    collisionRenderer.setThreadPool
+      ( shared_ptr<ThreadPool>( new ThreadPool( threads ) ) );
+  }
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 1000.0, 1.0, 1000.0 ) ),
+                             material ))));
+  world.addObject( ground );
+  
+  // a 20 x n x 20 pile of capsules, each overlapping its neighbours
+  vector< shared_ptr<Object> > capsules;
+  for( int i = 0 ; i < capsuleCount ; i++ ) {
+    Vector loc = makeVector3d( 0.4 * (i % 20), 0.3 + 0.4 * (i / 400),
+                               0.8 * (i / 20 % 20) );
+    shared_ptr<Object> capsule
+      ( new Object
+        ( Object::Params
+          ( new ODELocator( loc ), 0,
+            new BasicGeometry( shapes::CappedCylinder::create( 0.6, 0.25 ),
+                               material ))));
+    world.addObject( capsule );
+    capsules.push_back( capsule );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  
+  Stopwatch collision;
+  contacts = 0;
+  for( int i = 0 ; i < ticks ; i++ ) {
+    collision.start();
+    collisionRenderer.render();
+    collision.stop();
+    contacts += collisionRenderer.getCollider()->getContactCount();
+    world.timestep( dt );
+  }
+  
+  locations.clear();
+  for( unsigned int i = 0 ; i < capsules.size() ; i++ ) {
+    locations.push_back( capsules[i]->getLocator()->getLoc() );
+  }
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < capsules.size() ; i++ ) {
+    world.removeObject( capsules[i] );
+  }
+  world.removeObject( ground );
+  
+  return collision.getTotal() / ticks;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int capsuleCount = CountArgument( argc, argv, "[capsule count]", 2000 );
+  
+  cout << capsuleCount << " capsules, hardware threads: "
+       << ThreadPool::HardwareThreads() << endl;
+  
+#ifdef LS_ODE_THREADING
+  static const unsigned int threadCounts[] = { 0, 1, 2, 4, 8 };
+  static const int runs = 5;
+#else
+  static const unsigned int threadCounts[] = { 0, 1 };
+  static const int runs = 2;
+#endif
+  
+  bool passed = true;
+  vector<Vector> serialLocations;
+  double serialTime = 0.0;
+  for( int i = 0 ; i < runs ; i++ ) {
+    vector<Vector> locations;
+    std::size_t contacts;
+    double time = run( threadCounts[i], capsuleCount, locations, contacts );
+    
+    // the pile must end up exactly the same
+    bool same = true;
+    if( i == 0 ) {
+      serialTime = time;
+      serialLocations = locations;
+    } else {
+      for( unsigned int j = 0 ; j < locations.size() ; j++ ) {
+        for( int k = 0 ; k < 3 ; k++ ) {
+          same &= locations[j](k) == serialLocations[j](k);
+        }
+      }
+    }
+    passed &= same;
+    
+    if( threadCounts[i] == 0 ) printf( "no pool:    " );
+    else printf( "threads %u:  ", threadCounts[i] );
+    printf( "%9.3f ms/tick (speedup %5.2f), %.0f contacts per tick%s\n",
+            1e3 * time, serialTime / time,
+            (double)contacts / ticks, same ? "" : "  DIFFERS" );
+  }
+  
+  return Finish( passed );
+}
@@ -0,0 +1,177 @@
+/**
+ * @file main.cpp
+ *
+ * Measures the scaling of the prepare pass with a ParallelIntegrator at 1, 2,
+ * 4, 8 and 16 threads. The objects have InertiaLocators and a thread-safe
+ * prepare that adds a spring force towards the origin. With "nested", the
+ * objects are spread into 16 thread-safe Subspaces that share the pool.
+ *
+ * The final locations must be identical for all thread counts.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::atoi;
+
+#include <cstring>
+using std::strcmp;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int warmupSteps = 5;
+static const int measureSteps = 50;
+static const real dt = 0.01;
+
+
+
+
+/** An object that pulls itself towards the origin. */
+class SpringObject :
+  public Object
+{
+  InertiaLocator * inertiaLocator;
+  
+public:
+  SpringObject( InertiaLocator * locator ) :
+    Object( Object::Params( locator ) ),
+    inertiaLocator( locator )
+  {
+    setThreadSafePrepare( true );
+  }
+  
+  virtual void prepare( real dt )
+  {
+    inertiaLocator->addForceAbs( -2.0 * inertiaLocator->getLoc() );
+    Object::prepare( dt );
+  }
+};
+
+
+static shared_ptr<Subspace> makeSpace( shared_ptr<ThreadPool> pool )
+{
+  shared_ptr<Subspace> space
+    ( new Subspace
+      ( Subspace::Params
+        ( Object::Params(),
+          shared_ptr<Environment>(),
+          shared_ptr<Integrator>( new ParallelIntegrator( pool ) ))));
+  space->setThreadSafePrepare( true );
+  return space;
+}
+
+
+/** Runs the benchmark, returns a checksum of the final locations. */
+static double run( unsigned int threads, int count, bool nested,
+                   double & prepareTime, double & stepTime )
+{
+  shared_ptr<ThreadPool> pool( new ThreadPool( threads ) );
+  World world
+    ( Subspace::Params
+      ( Object::Params(),
+        shared_ptr<Environment>(),
+        shared_ptr<Integrator>( new ParallelIntegrator( pool ) )));
+  
+  vector< shared_ptr<Subspace> > spaces;
+  for( int i = 0 ; nested && i < 16 ; i++ ) {
+    spaces.push_back( makeSpace( pool ) );
+    world.addObject( spaces.back() );
+  }
+  
+  vector< shared_ptr<Object> > objects;
+  for( int i = 0 ; i < count ; i++ ) {
+    InertiaLocator * locator =
+      new InertiaLocator( makeVector3d( i % 100, i / 10000, (i / 100) % 100 ));
+    locator->setVel( makeVector3d( 0.1, 0.0, 0.0 ) );
+    locator->setRotation( makeVector3d( 0.0, 1.0, 0.0 ) );
+    objects.push_back( shared_ptr<Object>( new SpringObject( locator ) ) );
+    if( nested ) spaces[i % 16]->addObject( objects.back() );
+    else world.addObject( objects.back() );
+  }
+  
+  for( int i = 0 ; i < warmupSteps ; i++ ) world.timestep( dt );
+  
+  prepareTime = stepTime = 0.0;
+  for( int i = 0 ; i < measureSteps ; i++ ) {
+    double t0 = WallTime();
+    world.prepare( dt );
+    double t1 = WallTime();
+    world.step();
+    double t2 = WallTime();
+    prepareTime += t1 - t0;
+    stepTime += t2 - t1;
+  }
+  prepareTime /= measureSteps;
+  stepTime /= measureSteps;
+  
+  double checksum = 0.0;
+  for( int i = 0 ; i < count ; i++ ) {
+    const Vector & loc = objects[i]->getLocator()->getLoc();
+    checksum += (i + 1) * (loc(0) + 3.0 * loc(1) + 7.0 * loc(2));
+  }
+  
+  for( int i = 0 ; i < count ; i++ ) {
+    objects[i]->getHostSpace()->removeObject( objects[i] );
+  }
+  for( unsigned int i = 0 ; i < spaces.size() ; i++ ) {
+    world.removeObject( spaces[i] );
+  }
+  
+  return checksum;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  if( argc != 3 ) Usage( argv, "<object count> [flat|nested]" );
+  int count   = atoi( argv[1] );
+  bool nested = 0 == strcmp( argv[2], "nested" );
+  
+  cout << "objects: " << count << ( nested ? ", nested" : ", flat" )
+       << ", hardware threads: " << ThreadPool::HardwareThreads() << endl;
+  
+  static const unsigned int threadCounts[] = { 1, 2, 4, 8, 16 };
+  double serialTime = 0.0, serialChecksum = 0.0;
+  bool deterministic = true;
+  
+  for( int i = 0 ; i < 5 ; i++ ) {
+    double prepareTime, stepTime;
+    double checksum =
+      run( threadCounts[i], count, nested, prepareTime, stepTime );
+    if( i == 0 ) {
+      serialTime = prepareTime;
+      serialChecksum = checksum;
+    } else if( checksum != serialChecksum ) {
+      deterministic = false;
+    }
+    
+    printf( "threads %2u:  prepare %9.3f ms (speedup %5.2f), "
+            "step %9.3f ms\n",
+            threadCounts[i], 1e3 * prepareTime, serialTime / prepareTime,
+            1e3 * stepTime );
+  }
+  
+  cout << "results identical for all thread counts: "
+       << ( deterministic ? "yes" : "NO" ) << endl;
+  return Finish( deterministic );
+}
@@ -0,0 +1,164 @@
+/**
+ * @file main.cpp
+ *
+ * Moves objects between the Subspaces of a large static scene (50000 geoms by
+ * default) while the collision renderer is connected, and compares the cost
+ * of the incremental reparenting with a full rescan of the renderer. Also
+ * moves a falling sphere to another Subspace in mid-air, and checks that its
+ * contacts are dropped when it is removed and that it lands on the ground
+ * after it has been reinserted and reactivated.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int subspaceCount = 50;
+static const int moveCount = 1000;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+/** Moves the object from its current host into the target subspace. */
+static void reparent( ODEWorld & world,
+                      shared_ptr<Object> object, Subspace & target )
+{
+  ODEWorld::Activate( object.get(), 0 );
+  object->getHostSpace()->removeObject( object );
+  target.addObject( object );
+  ODEWorld::Activate( object.get(), &world );
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int geomCount = CountArgument( argc, argv, "[geom count]", 50000 );
+  
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 1000.0, 1.0, 1000.0 ) ),
+                             material ))));
+  world.addObject( ground );
+  
+  // static boxes on a grid, each row band in its own subspace
+  vector< shared_ptr<Subspace> > subspaces;
+  for( int i = 0 ; i < subspaceCount ; i++ ) {
+    shared_ptr<Subspace> subspace( new Subspace() );
+    world.addObject( subspace );
+    subspaces.push_back( subspace );
+  }
+  vector< shared_ptr<Object> > boxes;
+  for( int i = 0 ; i < geomCount ; i++ ) {
+    Vector loc = makeVector3d( 1.0 * (i % 250), 5.0, 1.0 * (i / 250) );
+    shared_ptr<Object> box
+      ( new Object
+        ( Object::Params
+          ( new BasicLocator( loc ), 0,
+            new BasicGeometry( shapes::Cube::create
+                               ( makeVector3d( 0.5, 0.5, 0.5 ) ),
+                               material ))));
+    subspaces[i * subspaceCount / geomCount]->addObject( box );
+    boxes.push_back( box );
+  }
+  
+  // a sphere resting on the ground, and another one falling
+  shared_ptr<Object> resting
+    ( new Object
+      ( Object::Params
+        ( new ODELocator( makeVector3d( -10.0, 0.45, -10.0 ) ), 0,
+          new BasicGeometry( shapes::Sphere::create( 0.5 ), material ))));
+  subspaces[0]->addObject( resting );
+  shared_ptr<Object> falling
+    ( new Object
+      ( Object::Params
+        ( new ODELocator( makeVector3d( -20.0, 1.0, -20.0 ) ), 0,
+          new BasicGeometry( shapes::Sphere::create( 0.5 ), material ))));
+  subspaces[0]->addObject( falling );
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  bool ok = true;
+  
+  // the resting sphere loses its contacts when it is removed
+  collisionRenderer.render();
+  bool touched = !resting->getGeometry()->getContacts().empty();
+  ODEWorld::Activate( resting.get(), 0 );
+  subspaces[0]->removeObject( resting );
+  bool dropped = resting->getGeometry()->getContacts().empty();
+  ok &= touched && dropped;
+  printf( "removed sphere: %s\n",
+          touched && dropped ? "contacts dropped" : "FAILED" );
+  
+  // move the falling sphere in mid-air, it must still land
+  reparent( world, falling, *subspaces[subspaceCount - 1] );
+  bool landed = false;
+  for( int i = 0 ; i < 100 && !landed ; i++ ) {
+    collisionRenderer.render();
+    landed = !falling->getGeometry()->getContacts().empty();
+    world.timestep( dt );
+  }
+  ok &= landed;
+  printf( "moved sphere:   %s\n", landed ? "landed" : "FAILED" );
+  
+  // move the boxes to the next subspace
+  double t0 = WallTime();
+  for( int i = 0 ; i < moveCount ; i++ ) {
+    shared_ptr<Object> box = boxes[i * (geomCount / moveCount)];
+    int host = i * (geomCount / moveCount) * subspaceCount / geomCount;
+    reparent( world, box, *subspaces[(host + 1) % subspaceCount] );
+  }
+  double moveTime = WallTime() - t0;
+  collisionRenderer.render();
+  
+  // a full rescan for comparison
+  t0 = WallTime();
+  collisionRenderer.disconnect();
+  collisionRenderer.connect();
+  double rescanTime = WallTime() - t0;
+  
+  printf( "%d geoms in %d subspaces\n", geomCount, subspaceCount );
+  printf( "reparent: %9.3f us per object, %.0f objects per second\n",
+          1e6 * moveTime / moveCount, moveCount / moveTime );
+  printf( "rescan:   %9.3f ms\n", 1e3 * rescanTime );
+  cout << ( ok ? "tracking ok" : "TRACKING FAILED" ) << endl;
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < subspaces.size() ; i++ ) {
+    Subspace::objects_t & objects = subspaces[i]->getObjects();
+    while( !objects.empty() ) subspaces[i]->removeObject( *objects.begin() );
+    world.removeObject( subspaces[i] );
+  }
+  world.removeObject( ground );
+  
+  return Finish( ok );
+}
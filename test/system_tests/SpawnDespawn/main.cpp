@@ -0,0 +1,166 @@
+/**
+ * @file main.cpp
+ *
+ * Spawns and despawns ODE-located objects with sphere geometries repeatedly
+ * and reports the global operator new calls per spawned object. The objects
+ * are built either with plain new expressions ("new") or with the pooled
+ * create() factories ("create"). With "ode", each object is activated in an
+ * ODEWorld after insertion and deactivated before removal.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include <ode/ode.h>
+#include <ode/odecpp.h>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::malloc;
+using std::free;
+using std::atoi;
+using std::exit;
+
+#include <cstring>
+using std::strcmp;
+
+#include <new>
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <boost/timer.hpp>
+using boost::timer;
+
+
+
+
+/* allocation counting */
+
+static unsigned long allocCount = 0;
+
+void * operator new( std::size_t size ) throw( std::bad_alloc )
+{
+  allocCount++;
+  void * p = malloc( size ? size : 1 );
+  if( !p ) throw std::bad_alloc();
+  return p;
+}
+
+void * operator new[]( std::size_t size ) throw( std::bad_alloc )
+{ return operator new( size ); }
+
+void operator delete( void * p ) throw()
+{ free( p ); }
+
+void operator delete[]( void * p ) throw()
+{ free( p ); }
+
+
+
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.9, 0.001 ) );
+
+
+static shared_ptr<Object> spawn( bool useCreate, const Vector & loc )
+{
+  if( useCreate ) {
+    return Object::create
+      ( Object::Params( ODELocator::create( loc ),
+                        shared_ptr<Visual>(),
+                        BasicGeometry::create( shapes::Sphere::create( 0.3 ),
+                                               material )));
+  } else {
+    return shared_ptr<Object>
+      ( new Object
+        ( Object::Params
+          ( shared_ptr<Locator>( new ODELocator( loc ) ),
+            shared_ptr<Visual>(),
+            shared_ptr<Geometry>
+            ( new BasicGeometry
+              ( shared_ptr<Shape>( new shapes::Sphere( 0.3 ) ),
+                material ) ))));
+  }
+}
+
+
+/* Spawns count objects into the world and despawns them again. */
+static void cycle( ODEWorld & world, bool useCreate, bool activate, int count )
+{
+  vector< shared_ptr<Object> > objects;
+  objects.reserve( count );
+  
+  for( int i = 0 ; i < count ; i++ ) {
+    shared_ptr<Object> object =
+      spawn( useCreate, makeVector3d( i % 100, i / 10000, (i / 100) % 100 ) );
+    world.addObject( object );
+    if( activate ) ODEWorld::Activate( object.get(), &world );
+    objects.push_back( object );
+  }
+  
+  for( int i = 0 ; i < count ; i++ ) {
+    if( activate ) ODEWorld::Activate( objects[i].get(), 0 );
+    world.removeObject( objects[i] );
+  }
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  if( argc != 4 ) {
+    cout << "Usage: " << argv[0]
+         << " <object count> [new|create] [ode|plain]" << endl;
+    exit(1);
+  }
+  int count        = atoi( argv[1] );
+  bool useCreate   = 0 == strcmp( argv[2], "create" );
+  bool activate    = 0 == strcmp( argv[3], "ode" );
+  
+  cout << "objects: " << count << ", construction: "
+       << ( useCreate ? "create" : "new" ) << ", "
+       << ( activate ? "activated" : "not activated" ) << endl;
+  
+  
+  // world
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ));
+  world.activate( true );
+  
+  // warm up (pools, container capacities, interned names)
+  cycle( world, useCreate, activate, count );
+  
+  
+  // measure
+  
+  int rounds = 0;
+  unsigned long allocs = allocCount;
+  timer t;
+  
+  do {
+    cycle( world, useCreate, activate, count );
+    rounds++;
+  } while( t.elapsed() < 2.0 );
+  double elapsed = t.elapsed();
+  allocs = allocCount - allocs;
+  
+  printf( "spawn+despawn:              %.3f us/object\n",
+          1e6 * elapsed / rounds / count );
+  printf( "allocations:                %.3f /spawned object\n",
+          (double)allocs / rounds / count );
+  
+  world.activate( false );
+  
+  return 0;
+}
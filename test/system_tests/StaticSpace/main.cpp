@@ -0,0 +1,238 @@
+/**
+ * @file main.cpp
+ *
+ * Measures the per-tick cost of ODECollisionRenderer::render() in a level of
+ * static floor tiles (20000 by default) with up to 500 spheres resting on
+ * them. The tiles overlap each other, but as they are static they must never
+ * be paired. Checks that every sphere touches the floor and that no
+ * tile-tile contacts are created, and prints the cost for a growing number of
+ * tiles and of spheres: it should follow the number of spheres only.
+ *
+ * Also checks that the static contents of a nested Subspace follow it when
+ * it is removed from the world and inserted into a Subspace that does not
+ * self-collide.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <cstdio>
+using std::printf;
+
+#include <cmath>
+using std::sqrt;
+using std::ceil;
+
+#include <vector>
+using std::vector;
+
+#include <set>
+using std::set;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int ticks = 10;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+/** Prints the average time of render() and checks the contacts. */
+static void measure( int tileCount, int sphereCount, bool & ok )
+{
+  int side = (int)ceil( sqrt( (double)tileCount ) );
+  real extent = 0.5 * side;
+  
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  
+  Collider::BroadphaseParams params;
+  params.quadtreeCenter = makeVector3d( extent, 0.0, extent );
+  params.quadtreeExtents = makeVector3d( extent, 10.0, extent );
+  ODECollisionRenderer collisionRenderer( &world, params );
+  
+  // slightly overlapping unit tiles
+  vector< shared_ptr<Object> > objects;
+  set<const Geometry *> tiles;
+  for( int i = 0 ; i < tileCount ; i++ ) {
+    shared_ptr<Object> tile
+      ( new Object
+        ( Object::Params
+          ( new BasicLocator( makeVector3d( (i % side) + 0.5, -0.5,
+                                            (i / side) + 0.5 ) ), 0,
+            new BasicGeometry( shapes::Cube::create
+                               ( makeVector3d( 1.1, 1.0, 1.1 ) ),
+                               material ))));
+    world.addObject( tile );
+    objects.push_back( tile );
+    tiles.insert( tile->getGeometry().get() );
+  }
+  
+  // spheres spread over the floor, sunk a bit into it
+  int stride = tileCount / sphereCount;
+  vector< shared_ptr<Object> > spheres;
+  for( int i = 0 ; i < sphereCount ; i++ ) {
+    int tile = i * stride;
+    shared_ptr<Object> sphere
+      ( new Object
+        ( Object::Params
+          ( new ODELocator( makeVector3d( (tile % side) + 0.5, 0.35,
+                                          (tile / side) + 0.5 ) ), 0,
+            new BasicGeometry( shapes::Sphere::create( 0.4 ), material ))));
+    world.addObject( sphere );
+    objects.push_back( sphere );
+    spheres.push_back( sphere );
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  collisionRenderer.render();
+  
+  // check the contacts of the first collision
+  int touching = 0, tileTile = 0;
+  for( unsigned int i = 0 ; i < spheres.size() ; i++ ) {
+    if( !spheres[i]->getGeometry()->getContacts().empty() ) touching++;
+  }
+  for( set<const Geometry *>::const_iterator i = tiles.begin() ;
+       i != tiles.end() ; ++i ) {
+    const Geometry::contacts_t & contacts = (*i)->getContacts();
+    for( Geometry::contacts_t::const_iterator j = contacts.begin() ;
+         j != contacts.end() ; ++j ) {
+      if( tiles.count( j->first ) ) tileTile++;
+    }
+  }
+  bool expected = touching == sphereCount && tileTile == 0;
+  ok &= expected;
+  
+  world.timestep( dt );
+  Stopwatch collision;
+  for( int i = 0 ; i < ticks ; i++ ) {
+    collision.start();
+    collisionRenderer.render();
+    collision.stop();
+    world.timestep( dt );
+  }
+  
+  printf( "%6d tiles %4d spheres: %9.3f ms per tick, "
+          "%4d touching, %d tile-tile contacts%s\n",
+          tileCount, sphereCount, 1e3 * collision.getTotal() / ticks,
+          touching, tileTile,
+          expected ? "" : "  FAILED" );
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < objects.size() ; i++ ) {
+    world.removeObject( objects[i] );
+  }
+}
+
+
+
+static shared_ptr<Object> makeSphere( const Vector & loc )
+{
+  return shared_ptr<Object>
+    ( new Object
+      ( Object::Params
+        ( new ODELocator( loc ), 0,
+          new BasicGeometry( shapes::Sphere::create( 0.4 ), material ))));
+}
+
+
+static bool touches( const Object & lhs, const Object & rhs )
+{
+  const Geometry::contacts_t & contacts = lhs.getGeometry()->getContacts();
+  return contacts.find( rhs.getGeometry().get() ) != contacts.end();
+}
+
+
+/**
+ * Moves a Subspace holding a static tile out of the world and then into a
+ * Subspace that does not self-collide, and checks the contacts of the tile
+ * with a sphere in the world and with a sphere in the new host: the latter
+ * collide only while the tile is outside of the new host.
+ */
+static void checkSubspaceMoves( bool & ok )
+{
+  ODEWorld world;
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Subspace> floor( new Subspace() );
+  shared_ptr<Object> tile
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 4.0, 1.0, 4.0 ) ),
+                             material ))));
+  floor->addObject( tile );
+  world.addObject( floor );
+  
+  shared_ptr<Subspace> shelf
+    ( new Subspace( Subspace::Params( Object::Params(), false ) ) );
+  shared_ptr<Object> inner = makeSphere( makeVector3d( 1.0, 0.35, 0.0 ) );
+  shelf->addObject( inner );
+  world.addObject( shelf );
+  
+  shared_ptr<Object> outer = makeSphere( makeVector3d( -1.0, 0.35, 0.0 ) );
+  world.addObject( outer );
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  
+  collisionRenderer.render();
+  bool attached = touches( *outer, *tile ) && touches( *inner, *tile );
+  
+  world.removeObject( floor );
+  collisionRenderer.render();
+  bool removed = !touches( *outer, *tile );
+  
+  // in the shelf, the tile collides with the outside only
+  shelf->addObject( floor );
+  collisionRenderer.render();
+  bool rehosted = touches( *outer, *tile ) && !touches( *inner, *tile );
+  
+  bool expected = attached && removed && rehosted;
+  ok &= expected;
+  printf( "moved subspace: %s\n",
+          expected ? "static contents follow" : "FAILED" );
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  shelf->removeObject( floor );
+  floor->removeObject( tile );
+  shelf->removeObject( inner );
+  world.removeObject( shelf );
+  world.removeObject( outer );
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int tileCount = CountArgument( argc, argv, "[tile count]", 20000 );
+  
+  bool ok = true;
+  
+  // growing static count
+  for( int tiles = tileCount / 4 ; tiles <= tileCount ; tiles *= 2 ) {
+    measure( tiles, 500, ok );
+  }
+  
+  // growing dynamic count
+  for( int spheres = 125 ; spheres <= 500 ; spheres *= 2 ) {
+    measure( tileCount, spheres, ok );
+  }
+  
+  checkSubspaceMoves( ok );
+  
+  return Finish( ok );
+}
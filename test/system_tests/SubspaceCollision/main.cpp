@@ -0,0 +1,163 @@
+/**
+ * @file main.cpp
+ *
+ * Vehicles of 60 overlapping boxes each, resting on the ground. Checks that
+ * the parts of a vehicle whose Subspace does not self-collide get no contacts
+ * with each other but still touch the ground, and measures the collision cost
+ * with the boxes placed flat into the world, and grouped into self-colliding
+ * and non-self-colliding Subspaces.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include "../common/SystemTest.hpp"
+using namespace systemtest;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <vector>
+using std::vector;
+
+#include <set>
+using std::set;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+enum Layout { Flat, SelfColliding, NonSelfColliding };
+
+static const char * layoutNames[] =
+  { "flat", "self-colliding", "non-self-colliding" };
+
+static const int partsPerVehicle = 60;
+static const int ticks = 10;
+static const real dt = 0.01;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+static void run( int vehicleCount, Layout layout, bool & ok )
+{
+  ODEWorld world;
+  world.setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+  ODECollisionRenderer collisionRenderer( &world );
+  
+  shared_ptr<Object> ground
+    ( new Object
+      ( Object::Params
+        ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+          new BasicGeometry( shapes::Cube::create
+                             ( makeVector3d( 1000.0, 1.0, 1000.0 ) ),
+                             material ))));
+  world.addObject( ground );
+  
+  // the vehicles are 3x5x4 blocks of overlapping boxes, in a row
+  vector< shared_ptr<Subspace> > vehicles;
+  vector< set<const Geometry *> > vehicleParts( vehicleCount );
+  vector< shared_ptr<Object> > parts;
+  for( int v = 0 ; v < vehicleCount ; v++ ) {
+    shared_ptr<Subspace> vehicle
+      ( new Subspace( Subspace::Params( Object::Params(),
+                                        layout != NonSelfColliding ) ) );
+    if( layout != Flat ) {
+      world.addObject( vehicle );
+      vehicles.push_back( vehicle );
+    }
+    
+    for( int i = 0 ; i < partsPerVehicle ; i++ ) {
+      Vector loc = makeVector3d( 10.0 * v + 0.9 * (i % 3),
+                                 0.45 + 0.9 * (i / 3 % 5),
+                                 0.9 * (i / 15) );
+      shared_ptr<Object> part
+        ( new Object
+          ( Object::Params
+            ( new ODELocator( loc ), 0,
+              new BasicGeometry( shapes::Cube::create
+                                 ( makeVector3d( 1.0, 1.0, 1.0 ) ),
+                                 material ))));
+      if( layout == Flat ) {
+        world.addObject( part );
+      } else {
+        vehicle->addObject( part );
+      }
+      parts.push_back( part );
+      vehicleParts[v].insert( part->getGeometry().get() );
+    }
+  }
+  
+  world.activate( true );
+  collisionRenderer.connect();
+  
+  Stopwatch collision;
+  for( int i = 0 ; i < ticks ; i++ ) {
+    collision.start();
+    collisionRenderer.render();
+    collision.stop();
+    
+    // count the contacts after the first collision
+    if( i == 0 ) {
+      int internal = 0, external = 0;
+      for( unsigned int j = 0 ; j < parts.size() ; j++ ) {
+        const Geometry * geometry = parts[j]->getGeometry().get();
+        const set<const Geometry *> & siblings =
+          vehicleParts[j / partsPerVehicle];
+        const Geometry::contacts_t & contacts = geometry->getContacts();
+        for( Geometry::contacts_t::const_iterator k = contacts.begin() ;
+             k != contacts.end() ; ++k ) {
+          if( siblings.count( k->first ) ) internal++; else external++;
+        }
+      }
+      
+      bool expected = layout == NonSelfColliding ?
+        internal == 0 && external > 0 : internal > 0 && external > 0;
+      ok &= expected;
+      printf( "%-20s %6d internal, %6d external contacts%s\n",
+              layoutNames[layout], internal, external,
+              expected ? "" : "  FAILED" );
+    }
+    
+    world.timestep( dt );
+  }
+  printf( "%-20s %9.3f ms per collision\n",
+          layoutNames[layout], 1e3 * collision.getTotal() / ticks );
+  
+  collisionRenderer.disconnect();
+  world.activate( false );
+  for( unsigned int i = 0 ; i < vehicles.size() ; i++ ) {
+    world.removeObject( vehicles[i] );
+  }
+  if( layout == Flat ) {
+    for( unsigned int i = 0 ; i < parts.size() ; i++ ) {
+      world.removeObject( parts[i] );
+    }
+  }
+  world.removeObject( ground );
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  int vehicleCount = CountArgument( argc, argv, "[vehicle count]", 50 );
+  
+  cout << vehicleCount << " vehicles of " << partsPerVehicle << " parts"
+       << endl;
+  
+  bool ok = true;
+  run( vehicleCount, Flat, ok );
+  run( vehicleCount, SelfColliding, ok );
+  run( vehicleCount, NonSelfColliding, ok );
+  
+  return Finish( ok );
+}
@@ -281,9 +281,17 @@ public:
 int main( int argc, char * argv[] )
 {
   // graphics and user interface
-  GLOWDevice::Init( argc, argv );
-  GLOWDevice window;
-  GLOWViewport viewport( window );
+  // "--headless <ticks>" runs the given number of ticks without a display
+  bool headless = SimulationDriver::IsHeadless( argc, argv );
+  SimulationDriver driver;
+  GLOWDevice * window = 0;
+  GLOWViewport * viewport = 0;
+  if( !headless ) {
+    GLOWDevice::Init( argc, argv );
+    window = new GLOWDevice();
+    viewport = new GLOWViewport( *window );
+  }
+  Device & device = headless ? static_cast<Device &>( driver ) : *window;
 
 
   // world
@@ -449,12 +457,12 @@ int main( int argc, char * argv[] )
                         0 )));
   world.addObject( cameraObject );
   Controller::ControlMap cameraKeymap; fillCameraKeymap( cameraKeymap );
-  viewport.addActor( cameraObject, &cameraKeymap );
+  if( viewport ) viewport->addActor( cameraObject, &cameraKeymap );
   
   // the actual camera
   shared_ptr<Camera> camera( new Camera() );
   camera->setTargetObject( cameraObject );
-  viewport.setCamera( camera );
+  if( viewport ) viewport->setCamera( camera );
   
   // mirror camera object
   shared_ptr<Object> mirrorCameraObject
@@ -499,14 +507,17 @@ int main( int argc, char * argv[] )
   
   
   // start the system
-  viewport.setAutoRefresh( false );
+  if( viewport ) viewport->setAutoRefresh( false );
   world.setDefaultDt( 0.05 );
   //window.events.addListener( &collisionRenderer );   // order is important!
   //window.events.addListener( &world );               // order is important!
-  window.events.addListener( &deserializer );
-  window.events.addListener( &viewport );   // refresh will probably happen
-                                            // lastly anyways, independent of
-                                            // this order
+  device.events.addListener( &deserializer );
+  if( viewport ) {
+    device.events.addListener( viewport );   // refresh will probably happen
+                                             // lastly anyways, independent of
+                                             // this order
+  }
+  driver.runHeadlessIfRequested( argc, argv );
   GLOWDevice::MainLoop();
 
   // this is never reached
@@ -280,9 +280,17 @@ public:
 int main( int argc, char * argv[] )
 {
   // graphics and user interface
-  GLOWDevice::Init( argc, argv );
-  GLOWDevice window;
-  GLOWViewport viewport( window );
+  // "--headless <ticks>" runs the given number of ticks without a display
+  bool headless = SimulationDriver::IsHeadless( argc, argv );
+  SimulationDriver driver;
+  GLOWDevice * window = 0;
+  GLOWViewport * viewport = 0;
+  if( !headless ) {
+    GLOWDevice::Init( argc, argv );
+    window = new GLOWDevice();
+    viewport = new GLOWViewport( *window );
+  }
+  Device & device = headless ? static_cast<Device &>( driver ) : *window;
 
 
   // world
@@ -448,12 +456,12 @@ int main( int argc, char * argv[] )
                         0 )));
   world.addObject( cameraObject );
   Controller::ControlMap cameraKeymap; fillCameraKeymap( cameraKeymap );
-  viewport.addActor( cameraObject, &cameraKeymap );
+  if( viewport ) viewport->addActor( cameraObject, &cameraKeymap );
   
   // the actual camera
   shared_ptr<Camera> camera( new Camera() );
   camera->setTargetObject( cameraObject );
-  viewport.setCamera( camera );
+  if( viewport ) viewport->setCamera( camera );
   
   // mirror camera object
   shared_ptr<Object> mirrorCameraObject
@@ -499,12 +507,13 @@ int main( int argc, char * argv[] )
   
   
   // start the system
-  viewport.setAutoRefresh( false );
+  if( viewport ) viewport->setAutoRefresh( false );
   world.setDefaultDt( 0.05 );
-  window.events.addListener( &collisionRenderer );   // order is important!
-  window.events.addListener( &world );               // order is important!
-  window.events.addListener( &serializer );
-  window.events.addListener( &viewport );
+  device.events.addListener( &collisionRenderer );   // order is important!
+  device.events.addListener( &world );               // order is important!
+  device.events.addListener( &serializer );
+  if( viewport ) device.events.addListener( viewport );
+  driver.runHeadlessIfRequested( argc, argv );
   GLOWDevice::MainLoop();
 
   // this is never reached
@@ -0,0 +1,182 @@
+/**
+ * @file main.cpp
+ *
+ * Steps a WorldSet of independent ODEWorlds, each with boxes dropped onto the
+ * ground from random heights drawn from the seed of the world. The set is run
+ * first on a single thread in the Synchronized mode and then on all hardware
+ * threads in both modes, reporting the throughput in world-steps per second.
+ *
+ * The worlds use the BigMatrix solver, so the final box locations must be
+ * identical in all runs.
+ */
+
+#include <lifespace/lifespace.hpp>
+using namespace lifespace;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdio>
+using std::printf;
+
+#include <cstdlib>
+using std::atoi;
+using std::exit;
+
+#include <vector>
+using std::vector;
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+
+
+
+static const int simulatedSteps = 200;
+static const real dt = 0.01;
+static const unsigned long baseSeed = 1234;
+
+static const shared_ptr<CollisionMaterial> material
+( new CollisionMaterial( 0.9, 0.0, 0.001 ) );
+
+
+
+
+/** Builds worlds with a ground plate and randomly placed boxes. */
+class BoxFactory :
+  public WorldSet::Factory
+{
+  int boxCount;
+  vector< vector< shared_ptr<Object> > > contents;
+  
+  /** A small LCG, so that the content depends on the seed only. */
+  static real Random( unsigned long & state )
+  {
+    state = (state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+    return real( state ) / 0x7fffffffUL;
+  }
+  
+public:
+  BoxFactory( int boxCount_ ) :
+    boxCount( boxCount_ )
+  {}
+  
+  virtual shared_ptr<ODEWorld> createWorld( unsigned int index,
+                                            unsigned long seed )
+  {
+    ODEWorld::SolverParams params;
+    params.solver = ODEWorld::BigMatrix;
+    shared_ptr<ODEWorld> world( new ODEWorld( Subspace::Params(), params ) );
+    world->setGravityVector( makeVector3d( 0.0, -9.81, 0.0 ) );
+    
+    if( contents.size() <= index ) contents.resize( index + 1 );
+    vector< shared_ptr<Object> > & content = contents[index];
+    
+    content.push_back
+      ( shared_ptr<Object>
+        ( new Object
+          ( Object::Params
+            ( new BasicLocator( makeVector3d( 0.0, -0.5, 0.0 ) ), 0,
+              new BasicGeometry( shapes::Cube::create
+                                 ( makeVector3d( 100.0, 1.0, 100.0 ) ),
+                                 material )))));
+    
+    unsigned long state = seed;
+    for( int i = 0 ; i < boxCount ; i++ ) {
+      Vector loc = makeVector3d( 2.0 * (i % 8) + 0.2 * Random( state ),
+                                 1.0 + 4.0 * Random( state ),
+                                 2.0 * (i / 8) + 0.2 * Random( state ) );
+      content.push_back
+        ( shared_ptr<Object>
+          ( new Object
+            ( Object::Params
+              ( new ODELocator( loc ), 0,
+                new BasicGeometry( shapes::Cube::create
+                                   ( makeVector3d( 1.0, 1.0, 1.0 ) ),
+                                   material )))));
+    }
+    
+    for( unsigned int i = 0 ; i < content.size() ; i++ ) {
+      world->addObject( content[i] );
+    }
+    return world;
+  }
+  
+  virtual void destroyWorld( ODEWorld & world, unsigned int index )
+  {
+    for( unsigned int i = 0 ; i < contents[index].size() ; i++ ) {
+      world.removeObject( contents[index][i] );
+    }
+    contents[index].clear();
+  }
+};
+
+
+
+
+/** Runs a set and returns the final box locations of all worlds. */
+static vector<Vector> run( int worldCount, int boxCount,
+                           unsigned int threadCount, WorldSet::Mode mode,
+                           const char * label )
+{
+  shared_ptr<BoxFactory> factory( new BoxFactory( boxCount ) );
+  WorldSet worlds( factory, worldCount, baseSeed, threadCount );
+  worlds.setMode( mode );
+  worlds.run( simulatedSteps, dt );
+  
+  printf( "%-28s %2u threads: %10.1f world-steps/s\n", label,
+          worlds.getThreadPool()->getThreadCount(),
+          worlds.getThroughput() );
+  
+  vector<Vector> locs;
+  for( unsigned int w = 0 ; w < worlds.getWorldCount() ; w++ ) {
+    const Subspace::objects_t & objects = worlds.getWorld( w )->getObjects();
+    for( unsigned int i = 0 ; i < objects.size() ; i++ ) {
+      locs.push_back( objects[i]->getLocator()->getLoc() );
+    }
+  }
+  return locs;
+}
+
+
+static bool identical( const vector<Vector> & lhs, const vector<Vector> & rhs )
+{
+  if( lhs.size() != rhs.size() ) return false;
+  for( unsigned int i = 0 ; i < lhs.size() ; i++ ) {
+    for( int c = 0 ; c < 3 ; c++ ) {
+      if( lhs[i](c) != rhs[i](c) ) return false;
+    }
+  }
+  return true;
+}
+
+
+
+
+int main( int argc, char * argv[] )
+{
+  if( argc != 3 ) {
+    cout << "Usage: " << argv[0] << " <world count> <boxes per world>"
+         << endl;
+    exit(1);
+  }
+  int worldCount = atoi( argv[1] );
+  int boxCount   = atoi( argv[2] );
+  
+  cout << worldCount << " worlds, " << boxCount << " boxes each, "
+       << simulatedSteps << " steps" << endl;
+  
+  vector<Vector> serial =
+    run( worldCount, boxCount, 1, WorldSet::Synchronized, "synchronized" );
+  vector<Vector> synchronized =
+    run( worldCount, boxCount, 0, WorldSet::Synchronized, "synchronized" );
+  vector<Vector> freeRunning =
+    run( worldCount, boxCount, 0, WorldSet::FreeRunning, "free-running" );
+  
+  bool ok = identical( serial, synchronized ) &&
+    identical( serial, freeRunning );
+  cout << ( ok ? "results identical" : "RESULTS DIFFER" ) << endl;
+  
+  return ok ? 0 : 1;
+}
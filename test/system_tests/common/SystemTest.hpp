@@ -0,0 +1,92 @@
+/**
+ * @file SystemTest.hpp
+ *
+ * Helpers shared by the benchmarking system tests: wall-clock timing, the
+ * command line and the exit status.
+ */
+#ifndef LS_SYSTEMTEST_HPP
+#define LS_SYSTEMTEST_HPP
+
+
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+
+
+namespace systemtest {
+
+
+
+
+  /** Returns the wall time in seconds. */
+  inline double WallTime()
+  {
+    struct timeval tv;
+    gettimeofday( &tv, 0 );
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+  }
+
+
+  /**
+   * Sums up the wall time spent between start() and stop() over any number
+   * of timed sections.
+   */
+  class Stopwatch
+  {
+    double startTime;
+    double total;
+
+  public:
+    Stopwatch() : startTime( 0.0 ), total( 0.0 ) {}
+
+    void start()
+    { startTime = WallTime(); }
+
+    void stop()
+    { total += WallTime() - startTime; }
+
+    /** Returns the total time of the timed sections, in seconds. */
+    double getTotal() const
+    { return total; }
+  };
+
+
+  /** Prints "Usage: <program> <args>" and exits with status 1. */
+  inline void Usage( char * argv[], const char * args )
+  {
+    std::cout << "Usage: " << argv[0] << " " << args << std::endl;
+    std::exit( 1 );
+  }
+
+
+  /**
+   * Returns the optional single count argument of the test, or defaultCount
+   * if it is omitted. Exits with the usage if there are more arguments.
+   *
+   * @param name   The name of the argument in the usage, e.g. "[box count]".
+   */
+  inline int CountArgument( int argc, char * argv[], const char * name,
+                            int defaultCount )
+  {
+    if( argc > 2 ) Usage( argv, name );
+    return argc == 2 ? std::atoi( argv[1] ) : defaultCount;
+  }
+
+
+  /**
+   * Prints "passed" or "FAILED" as the last line of the output and returns
+   * the matching exit status for main().
+   */
+  inline int Finish( bool ok )
+  {
+    std::cout << ( ok ? "passed" : "FAILED" ) << std::endl;
+    return ok ? 0 : 1;
+  }
+
+
+
+
+}   /* namespace systemtest */
+
+
+#endif   /* LS_SYSTEMTEST_HPP */